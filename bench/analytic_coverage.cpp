@@ -0,0 +1,151 @@
+// image diff and timings of TOVE_RASTERIZE_ANALYTIC against the subsampled
+// engine. analytic output has to stay close to the subsampled one, and
+// banded analytic output identical to one pass.
+//
+// with a folder as argument, writes every raster there as raw rgba, so
+// that the output of two builds can be compared with cmp.
+
+#include "nsvg.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+using namespace tove;
+
+static double now_ms() {
+	return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+static std::string star_svg() {
+	std::string s = "<svg xmlns='http://www.w3.org/2000/svg' width='2000' height='2000'><path fill='#3a7' d='M";
+	for (int i = 0; i < 400; i++) {
+		const float a = i * 2 * M_PI / 400, r = i % 2 ? 900 : 1000;
+		char buf[64];
+		snprintf(buf, sizeof(buf), "%s%.2f %.2f ", i ? "L" : "", 1000 + r * cos(a), 1000 + r * sin(a));
+		s += buf;
+	}
+	return s + "Z'/></svg>";
+}
+
+static std::string mixed_svg() {
+	return "<svg xmlns='http://www.w3.org/2000/svg' width='400' height='300'>"
+		   "<defs><linearGradient id='g' gradientUnits='userSpaceOnUse' x1='-110' y1='0' x2='70' y2='0'>"
+		   "<stop offset='0' stop-color='#f00'/><stop offset='1' stop-color='#00f'/></linearGradient></defs>"
+		   "<circle cx='-20' cy='150' r='90' fill='url(#g)' stroke='#222' stroke-width='7'/>"
+		   "<rect x='330' y='-10' width='200' height='120' fill='#0a0' fill-opacity='0.6'/>"
+		   "<path fill-rule='evenodd' fill='#c80' d='M200 20 L260 200 L110 90 L290 90 L140 200 Z'/>"
+		   "<path fill='#08c' d='M200 20 L260 200 L110 90 L290 90 L140 200 Z' transform='translate(60 80)'/>"
+		   "<path fill='none' stroke='#a0a' stroke-width='1.3' d='M10 290 Q200 -50 390 290'/>"
+		   "</svg>";
+}
+
+static std::string curves_svg() {
+	srand(7);
+	std::string s = "<svg xmlns='http://www.w3.org/2000/svg' width='500' height='500'>";
+	for (int i = 0; i < 200; i++) {
+		auto r = []() { return (rand() % 5000) / 10.0; };
+		char buf[384];
+		snprintf(buf, sizeof(buf), "<path d='M%.1f %.1f C%.1f %.1f %.1f %.1f %.1f %.1f Q%.1f %.1f %.1f %.1f Z' "
+								   "fill='#%06x' fill-opacity='%.2f' fill-rule='%s' stroke='#%06x' stroke-width='%.1f'/>",
+				r(), r(), r(), r(), r(), r(), r(), r(), r(), r(), r(), r(), rand() & 0xffffff,
+				(rand() % 100) / 100.0, (i & 1) ? "evenodd" : "nonzero", rand() & 0xffffff, (rand() % 40) / 10.0);
+		s += buf;
+	}
+	return s + "</svg>";
+}
+
+// p_band > 0 rasterizes in bands of that many rows, one after the other.
+static std::vector<uint8_t> rasterize(NSVGimage *p_image, int p_width, int p_height, float p_scale,
+		ToveRasterizeEngine p_engine, int p_band, double *r_ms) {
+	std::vector<uint8_t> pixels(size_t(p_width) * p_height * 4);
+	ToveRasterizeSettings settings = *nsvg::getDefaultRasterizeSettings();
+	settings.engine = p_engine;
+
+	const double t0 = now_ms();
+	if (p_band <= 0) {
+		nsvg::rasterize(p_image, 0, 0, p_scale, pixels.data(), p_width, p_height, p_width * 4, &settings, 0);
+	} else {
+		NSVGrasterJob *job = nsvg::beginRasterize(p_image, 0, 0, p_scale, pixels.data(), p_width, p_height, p_width * 4, &settings, 0);
+		for (int y = 0; y < p_height; y += p_band) {
+			nsvg::rasterizeBand(job, y, std::min(y + p_band, p_height), &settings);
+		}
+		for (int y = 0; y < p_height; y += p_band) {
+			nsvg::defringeBand(job, y, std::min(y + p_band, p_height));
+		}
+		nsvg::endRasterize(job);
+	}
+	*r_ms = now_ms() - t0;
+	return pixels;
+}
+
+// alpha differences.
+static void diff(const char *p_name, const std::vector<uint8_t> &p_a, const std::vector<uint8_t> &p_b) {
+	int max = 0;
+	double sum = 0;
+	size_t big = 0;
+	for (size_t i = 3; i < p_a.size(); i += 4) {
+		const int d = abs(p_a[i] - p_b[i]);
+		max = std::max(max, d);
+		sum += d;
+		big += d > 16;
+	}
+	printf("  %-24s max %3d, mean %.4f, %zu pixels off by more than 16\n", p_name, max, sum / (p_a.size() / 4), big);
+}
+
+static void write(const char *p_folder, const char *p_scene, int p_width, int p_height, const char *p_engine, const std::vector<uint8_t> &p_pixels) {
+	if (!p_folder) {
+		return;
+	}
+	char path[512];
+	snprintf(path, sizeof(path), "%s/%s_%dx%d_%s.rgba", p_folder, p_scene, p_width, p_height, p_engine);
+	FILE *f = fopen(path, "wb");
+	if (f) {
+		fwrite(p_pixels.data(), 1, p_pixels.size(), f);
+		fclose(f);
+	}
+}
+
+int main(int argc, char **argv) {
+	const char *folder = argc > 1 ? argv[1] : nullptr;
+	const struct {
+		const char *name;
+		std::string svg;
+	} scenes[] = { { "star", star_svg() }, { "mixed", mixed_svg() }, { "curves", curves_svg() } };
+
+	int failures = 0;
+	for (const auto &scene : scenes) {
+		NSVGimage *image = nsvg::parseSVG(scene.svg.c_str(), "px", 96);
+		for (float scale : { 0.5f, 1.0f, 2.0f }) {
+			const int w = image->width * scale, h = image->height * scale;
+			double ms, cold[2] = { 1e9, 1e9 }, warm[2] = { 1e9, 1e9 };
+			std::vector<uint8_t> out[2];
+			for (int engine = 0; engine < 2; engine++) {
+				// a scale the edge cache has not seen yet, then the same again.
+				for (int k = 0; k < 3; k++) {
+					rasterize(image, w, h, scale * (1.0f + (k + 1) * 1e-6f), (ToveRasterizeEngine)engine, 0, &ms);
+					cold[engine] = std::min(cold[engine], ms);
+					out[engine] = rasterize(image, w, h, scale, (ToveRasterizeEngine)engine, 0, &ms);
+					warm[engine] = std::min(warm[engine], ms);
+				}
+			}
+			const std::vector<uint8_t> banded = rasterize(image, w, h, scale, TOVE_RASTERIZE_ANALYTIC, 37, &ms);
+
+			printf("%s %dx%d: subsampled %.2f ms (%.2f cached), analytic %.2f ms (%.2f cached)\n",
+					scene.name, w, h, cold[0], warm[0], cold[1], warm[1]);
+			diff("analytic vs subsampled", out[0], out[1]);
+			if (banded != out[1]) {
+				printf("  banded analytic output differs from one pass\n");
+				failures++;
+			}
+			write(folder, scene.name, w, h, "subsampled", out[0]);
+			write(folder, scene.name, w, h, "analytic", out[1]);
+		}
+		nsvgDelete(image);
+	}
+	return failures ? 1 : 0;
+}
@@ -0,0 +1,36 @@
+// writes thirdparty/tove2d/src/cpp/bluenoise_table.h, the blue noise
+// matrix nsvg::getBlueNoise() hands out. the module does not generate it
+// at run time, since even a 32x32 matrix takes about 18 ms.
+//
+//   g++ -O2 -std=c++14 -Wall -Ithirdparty bench/blue_noise_table.cpp -o blue_noise_table
+//   ./blue_noise_table > thirdparty/tove2d/src/cpp/bluenoise_table.h
+
+#include "bluenoise.h"
+
+#include <cstdio>
+
+int main() {
+	const int size = 32;
+	const unsigned int seed = 1;
+	const BlueNoise noise(size, seed);
+	const float *m = noise.get();
+
+	printf("// generated by bench/blue_noise_table.cpp, do not edit.\n");
+	printf("//\n");
+	printf("// %dx%d BlueNoise from thirdparty/bluenoise.h, seed %u, centered on 0\n", size, size, seed);
+	printf("// like the bayer matrices, so thresholds are in [-0.5, 0.5].\n\n");
+	printf("#ifndef __TOVE_BLUENOISE_TABLE\n");
+	printf("#define __TOVE_BLUENOISE_TABLE 1\n\n");
+	printf("#define TOVE_BLUE_NOISE_SIZE %d\n\n", size);
+	printf("static const float tove_blue_noise[TOVE_BLUE_NOISE_SIZE * TOVE_BLUE_NOISE_SIZE] = {\n");
+	for (int y = 0; y < size; y++) {
+		printf("\t");
+		for (int x = 0; x < size; x++) {
+			// 9 digits read back as the same float.
+			printf("%.9gf,%s", m[y * size + x] - 0.5f, x + 1 < size ? " " : "\n");
+		}
+	}
+	printf("};\n\n");
+	printf("#endif // __TOVE_BLUENOISE_TABLE\n");
+	return 0;
+}
@@ -0,0 +1,411 @@
+// the cpu side of copy_mesh() with direct_upload on and off, for when no
+// engine build is at hand to run copy_mesh_upload.gd. the illustration is
+// the one of the script, flattened into tove style color meshes: a fan per
+// fill and a strip per stroke, 12 byte vertices, 16 bit indices.
+//
+// off is the surface tool path as it runs in godot 3.x: the arrays become
+// a list of vertices, generate_normals() deindexes them and index() hashes
+// them back together. generate_tangents() stops at once without uvs, so it
+// is left out. on is copy_arrays_direct() with 2d positions stored relative
+// to the mesh bounds. both end in the packing VisualServer does for
+// ARRAY_COMPRESS_DEFAULT, minus the gpu upload itself.
+//
+// std::list and std::unordered_map stand in for godot's List and HashMap,
+// which also allocate once per element.
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <list>
+#include <unordered_map>
+#include <vector>
+
+static double now_ms() {
+	return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+struct Vec2 {
+	float x, y;
+};
+
+struct Vec3 {
+	float x, y, z;
+	bool operator==(const Vec3 &p) const { return x == p.x && y == p.y && z == p.z; }
+};
+
+struct Col {
+	float r, g, b, a;
+	bool operator==(const Col &p) const { return r == p.r && g == p.g && b == p.b && a == p.a; }
+};
+
+// a tove ColorMesh: x, y as floats, then rgba bytes.
+struct ToveMesh {
+	std::vector<uint8_t> vertices;
+	std::vector<uint16_t> indices;
+	int vertex_count = 0;
+};
+
+static const int STRIDE = 2 * sizeof(float) + 4;
+static const int PATHS = 1500;
+static const int STEPS = 16;
+static const int RUNS = 5;
+
+static float frand(float p_from, float p_to) {
+	return p_from + (p_to - p_from) * (rand() / (float)RAND_MAX);
+}
+
+static void add_vertex(ToveMesh &r_mesh, float p_x, float p_y, uint32_t p_rgb) {
+	uint8_t v[STRIDE];
+	memcpy(v, &p_x, sizeof(float));
+	memcpy(v + sizeof(float), &p_y, sizeof(float));
+	v[8] = p_rgb >> 16;
+	v[9] = p_rgb >> 8;
+	v[10] = p_rgb;
+	v[11] = 255;
+	r_mesh.vertices.insert(r_mesh.vertices.end(), v, v + STRIDE);
+	r_mesh.vertex_count++;
+}
+
+// the paths of copy_mesh_upload.gd, four curves each, appended as a root
+// path does. a mesh is closed once the next path would overflow its 16 bit
+// indices.
+static std::vector<ToveMesh> make_meshes() {
+	srand(7);
+	std::vector<ToveMesh> meshes(1);
+	for (int i = 0; i < PATHS; i++) {
+		const float x = frand(0, 1024), y = frand(0, 1024);
+		std::vector<Vec2> outline;
+		Vec2 p0 = { x, y };
+		for (int j = 0; j < 4; j++) {
+			Vec2 c[3];
+			for (int k = 0; k < 3; k++) {
+				c[k] = { x + frand(-120, 120), y + frand(-120, 120) };
+			}
+			if (j == 3) {
+				c[2] = { x, y };
+			}
+			for (int s = 0; s < STEPS; s++) {
+				const float t = s / (float)STEPS, u = 1 - t;
+				const float a = u * u * u, b = 3 * u * u * t, d = 3 * u * t * t, e = t * t * t;
+				outline.push_back({ a * p0.x + b * c[0].x + d * c[1].x + e * c[2].x,
+						a * p0.y + b * c[0].y + d * c[1].y + e * c[2].y });
+			}
+			p0 = c[2];
+		}
+		const int n = outline.size();
+		const uint32_t fill = rand() & 0xffffff, stroke = rand() & 0xffffff;
+		const float half_width = frand(0.5f, 4.0f) * 0.5f;
+
+		if (meshes.back().vertex_count + 3 * n > 65536) {
+			meshes.emplace_back();
+		}
+		ToveMesh &mesh = meshes.back();
+
+		const int fill_base = mesh.vertex_count;
+		for (const Vec2 &p : outline) {
+			add_vertex(mesh, p.x, p.y, fill);
+		}
+		for (int k = 1; k + 1 < n; k++) {
+			mesh.indices.insert(mesh.indices.end(), { (uint16_t)fill_base, (uint16_t)(fill_base + k), (uint16_t)(fill_base + k + 1) });
+		}
+
+		const int stroke_base = mesh.vertex_count;
+		for (int k = 0; k < n; k++) {
+			const Vec2 &a = outline[(k + n - 1) % n], &b = outline[(k + 1) % n];
+			float nx = a.y - b.y, ny = b.x - a.x;
+			const float len = std::max(std::sqrt(nx * nx + ny * ny), 1e-6f);
+			nx *= half_width / len;
+			ny *= half_width / len;
+			add_vertex(mesh, outline[k].x + nx, outline[k].y + ny, stroke);
+			add_vertex(mesh, outline[k].x - nx, outline[k].y - ny, stroke);
+		}
+		for (int k = 0; k < n; k++) {
+			const uint16_t a = stroke_base + 2 * k, b = stroke_base + 2 * ((k + 1) % n);
+			mesh.indices.insert(mesh.indices.end(), { a, (uint16_t)(a + 1), b, b, (uint16_t)(a + 1), (uint16_t)(b + 1) });
+		}
+	}
+	return meshes;
+}
+
+// what get_srgb_to_linear_table() holds.
+static const float *srgb_to_linear() {
+	static float table[256];
+	static bool done = false;
+	if (!done) {
+		for (int i = 0; i < 256; i++) {
+			const float c = i / 255.0f;
+			table[i] = c < 0.04045f ? c * (1.0f / 12.92f) : std::pow((c + 0.055f) * (1.0f / (1 + 0.055f)), 2.4f);
+		}
+		done = true;
+	}
+	return table;
+}
+
+static Col tove_color(const uint8_t *p) {
+	const float *linear = srgb_to_linear();
+	return { linear[p[0]], linear[p[1]], linear[p[2]], p[3] / 255.0f };
+}
+
+// a VisualServer surface: packed vertices, indices and the aabb.
+struct Packed {
+	std::vector<uint8_t> vertices;
+	std::vector<uint8_t> indices;
+	int vertex_count = 0;
+	Vec3 aabb_min, aabb_max;
+};
+
+static void pack(Packed &r_packed, const float *p_positions, int p_components, const Vec3 *p_normals,
+		const Col *p_colors, int p_vertex_count, const int *p_indices, int p_index_count) {
+	const int stride = p_components * sizeof(float) + (p_normals ? 4 : 0) + 4;
+	r_packed.vertex_count = p_vertex_count;
+	r_packed.vertices.resize(stride * p_vertex_count);
+	float lo[3] = { INFINITY, INFINITY, 0 }, hi[3] = { -INFINITY, -INFINITY, 0 };
+	for (int i = 0; i < p_vertex_count; i++) {
+		uint8_t *d = &r_packed.vertices[i * stride];
+		const float *p = p_positions + i * p_components;
+		memcpy(d, p, p_components * sizeof(float));
+		for (int k = 0; k < p_components; k++) {
+			lo[k] = std::min(lo[k], p[k]);
+			hi[k] = std::max(hi[k], p[k]);
+		}
+		d += p_components * sizeof(float);
+		if (p_normals) {
+			const float *n = &p_normals[i].x;
+			for (int k = 0; k < 3; k++) {
+				d[k] = (int8_t)std::max(-127.0f, std::min(127.0f, n[k] * 127));
+			}
+			d[3] = 0;
+			d += 4;
+		}
+		const float *c = &p_colors[i].r;
+		for (int k = 0; k < 4; k++) {
+			d[k] = (uint8_t)std::max(0.0f, std::min(255.0f, c[k] * 255));
+		}
+	}
+	r_packed.aabb_min = { lo[0], lo[1], lo[2] };
+	r_packed.aabb_max = { hi[0], hi[1], hi[2] };
+
+	const bool wide = p_vertex_count > 65535;
+	r_packed.indices.resize(p_index_count * (wide ? 4 : 2));
+	for (int i = 0; i < p_index_count; i++) {
+		if (wide) {
+			memcpy(&r_packed.indices[i * 4], &p_indices[i], 4);
+		} else {
+			const uint16_t v = p_indices[i];
+			memcpy(&r_packed.indices[i * 2], &v, 2);
+		}
+	}
+}
+
+// copy_arrays_direct() for a 2d color mesh, then encode_mesh_positions().
+static void upload_direct(const ToveMesh &p_mesh, Packed &r_packed) {
+	const int n = p_mesh.vertex_count;
+	std::vector<Vec2> positions(n);
+	for (int i = 0; i < n; i++) {
+		const float *p = (const float *)&p_mesh.vertices[i * STRIDE];
+		positions[i] = { p[0] * 0.001f, p[1] * -0.001f };
+	}
+	Vec2 lo = positions[0], hi = positions[0];
+	for (const Vec2 &p : positions) {
+		lo = { std::min(lo.x, p.x), std::min(lo.y, p.y) };
+		hi = { std::max(hi.x, p.x), std::max(hi.y, p.y) };
+	}
+	const Vec2 center = { (lo.x + hi.x) * 0.5f, (lo.y + hi.y) * 0.5f };
+	const float extent = std::max(std::max(hi.x - lo.x, hi.y - lo.y) * 0.5f, 1e-5f);
+	for (Vec2 &p : positions) {
+		p = { (p.x - center.x) / extent, (p.y - center.y) / extent };
+	}
+
+	std::vector<int> indices(p_mesh.indices.begin(), p_mesh.indices.end());
+
+	std::vector<Col> colors(n);
+	for (int i = 0; i < n; i++) {
+		colors[i] = tove_color(&p_mesh.vertices[i * STRIDE + 2 * sizeof(float)]);
+	}
+
+	pack(r_packed, &positions[0].x, 2, nullptr, colors.data(), n, indices.data(), indices.size());
+}
+
+// SurfaceTool::Vertex and its hasher, with what a color mesh leaves unset.
+struct Vertex {
+	Vec3 vertex = {}, normal = {}, binormal = {}, tangent = {};
+	Vec2 uv = {}, uv2 = {};
+	Col color = {};
+	std::vector<int> bones;
+	std::vector<float> weights;
+
+	bool operator==(const Vertex &p) const {
+		return vertex == p.vertex && normal == p.normal && binormal == p.binormal && tangent == p.tangent &&
+			   uv.x == p.uv.x && uv.y == p.uv.y && uv2.x == p.uv2.x && uv2.y == p.uv2.y &&
+			   color == p.color && bones == p.bones && weights == p.weights;
+	}
+};
+
+static uint32_t hash_djb2_buffer(const void *p_buff, int p_len, uint32_t p_prev = 5381) {
+	const uint8_t *b = (const uint8_t *)p_buff;
+	uint32_t hash = p_prev;
+	for (int i = 0; i < p_len; i++) {
+		hash = ((hash << 5) + hash) + b[i];
+	}
+	return hash;
+}
+
+struct VertexHasher {
+	size_t operator()(const Vertex &p) const {
+		uint32_t h = hash_djb2_buffer(&p.vertex, sizeof(Vec3));
+		h = hash_djb2_buffer(&p.normal, sizeof(Vec3), h);
+		h = hash_djb2_buffer(&p.binormal, sizeof(Vec3), h);
+		h = hash_djb2_buffer(&p.tangent, sizeof(Vec3), h);
+		h = hash_djb2_buffer(&p.uv, sizeof(Vec2), h);
+		h = hash_djb2_buffer(&p.uv2, sizeof(Vec2), h);
+		h = hash_djb2_buffer(&p.color, sizeof(Col), h);
+		h = hash_djb2_buffer(p.bones.data(), p.bones.size() * sizeof(int), h);
+		h = hash_djb2_buffer(p.weights.data(), p.weights.size() * sizeof(float), h);
+		return h;
+	}
+};
+
+struct SurfaceTool {
+	std::list<Vertex> vertex_array;
+	std::list<int> index_array;
+
+	void create_from_triangle_arrays(const std::vector<Vec3> &p_vertices, const std::vector<Col> &p_colors, const std::vector<int> &p_indices) {
+		for (size_t i = 0; i < p_vertices.size(); i++) {
+			Vertex v;
+			v.vertex = p_vertices[i];
+			v.color = p_colors[i];
+			vertex_array.push_back(v);
+		}
+		index_array.assign(p_indices.begin(), p_indices.end());
+	}
+
+	void deindex() {
+		const std::vector<Vertex> varr(vertex_array.begin(), vertex_array.end());
+		vertex_array.clear();
+		for (int i : index_array) {
+			vertex_array.push_back(varr[i]);
+		}
+		index_array.clear();
+	}
+
+	void index() {
+		if (!index_array.empty()) {
+			return;
+		}
+		std::unordered_map<Vertex, int, VertexHasher> indices;
+		std::list<Vertex> new_vertices;
+		for (const Vertex &v : vertex_array) {
+			auto it = indices.find(v);
+			int idx;
+			if (it == indices.end()) {
+				idx = indices.size();
+				indices.emplace(v, idx);
+				new_vertices.push_back(v);
+			} else {
+				idx = it->second;
+			}
+			index_array.push_back(idx);
+		}
+		vertex_array.swap(new_vertices);
+	}
+
+	// no smooth groups, so every vertex gets the normal of its face.
+	void generate_normals() {
+		const bool was_indexed = !index_array.empty();
+		deindex();
+		for (auto e = vertex_array.begin(); e != vertex_array.end();) {
+			Vertex &a = *e++;
+			Vertex &b = *e++;
+			Vertex &c = *e++;
+			const Vec3 u = { b.vertex.x - a.vertex.x, b.vertex.y - a.vertex.y, b.vertex.z - a.vertex.z };
+			const Vec3 v = { c.vertex.x - a.vertex.x, c.vertex.y - a.vertex.y, c.vertex.z - a.vertex.z };
+			Vec3 n = { u.y * v.z - u.z * v.y, u.z * v.x - u.x * v.z, u.x * v.y - u.y * v.x };
+			const float len = std::sqrt(n.x * n.x + n.y * n.y + n.z * n.z);
+			if (len > 0) {
+				n = { n.x / len, n.y / len, n.z / len };
+			}
+			a.normal = b.normal = c.normal = n;
+		}
+		if (was_indexed) {
+			index();
+		}
+	}
+
+	void commit_to_arrays(std::vector<Vec3> &r_vertices, std::vector<Vec3> &r_normals, std::vector<Col> &r_colors, std::vector<int> &r_indices) const {
+		for (const Vertex &v : vertex_array) {
+			r_vertices.push_back(v.vertex);
+			r_normals.push_back(v.normal);
+			r_colors.push_back(v.color);
+		}
+		r_indices.assign(index_array.begin(), index_array.end());
+	}
+};
+
+// copy_arrays_surface_tool() for a color mesh.
+static void upload_surface_tool(const ToveMesh &p_mesh, Packed &r_packed) {
+	const int n = p_mesh.vertex_count;
+	std::vector<int> iarr(p_mesh.indices.begin(), p_mesh.indices.end());
+	std::vector<Vec3> varr(n);
+	std::vector<Col> carr(n);
+	for (int i = 0; i < n; i++) {
+		const float *p = (const float *)&p_mesh.vertices[i * STRIDE];
+		varr[i] = { p[0] * 0.001f, p[1] * -0.001f, 0 };
+		carr[i] = tove_color(&p_mesh.vertices[i * STRIDE + 2 * sizeof(float)]);
+	}
+
+	SurfaceTool st;
+	st.create_from_triangle_arrays(varr, carr, iarr);
+	st.index();
+	st.generate_normals();
+
+	std::vector<Vec3> vertices, normals;
+	std::vector<Col> colors;
+	std::vector<int> indices;
+	st.commit_to_arrays(vertices, normals, colors, indices);
+
+	pack(r_packed, &vertices[0].x, 3, normals.data(), colors.data(), vertices.size(), indices.data(), indices.size());
+}
+
+int main() {
+	const std::vector<ToveMesh> meshes = make_meshes();
+	int vertex_count = 0, index_count = 0;
+	for (const ToveMesh &m : meshes) {
+		vertex_count += m.vertex_count;
+		index_count += m.indices.size();
+	}
+	printf("%d paths: %d vertices, %d indices in %d meshes\n\n", PATHS, vertex_count, index_count, (int)meshes.size());
+
+	for (int direct = 0; direct < 2; direct++) {
+		double best = 0;
+		int packed_vertices = 0;
+		size_t packed_bytes = 0;
+		for (int run = 0; run < RUNS; run++) {
+			std::vector<Packed> packed(meshes.size());
+			const double t0 = now_ms();
+			for (size_t i = 0; i < meshes.size(); i++) {
+				if (direct) {
+					upload_direct(meshes[i], packed[i]);
+				} else {
+					upload_surface_tool(meshes[i], packed[i]);
+				}
+			}
+			const double ms = now_ms() - t0;
+			if (run == 0 || ms < best) {
+				best = ms;
+			}
+			packed_vertices = 0;
+			packed_bytes = 0;
+			for (const Packed &p : packed) {
+				packed_vertices += p.vertex_count;
+				packed_bytes += p.vertices.size() + p.indices.size();
+			}
+		}
+		printf("%-12s best of %d runs %8.2f ms, %d vertices, %zu bytes packed\n",
+				direct ? "direct" : "surface tool", RUNS, best, packed_vertices, packed_bytes);
+	}
+	return 0;
+}
@@ -0,0 +1,82 @@
+# copy_mesh() with direct_upload on and off, on a generated illustration of
+# many curved paths with gradients and strokes. needs an engine build with
+# this module:
+#
+#   godot --verbose --no-window -s bench/copy_mesh_upload.gd
+#
+# each run gets a new renderer, so nothing comes from its mesh cache. with
+# --verbose, copy_mesh() also prints the time of every single upload.
+
+extends SceneTree
+
+const PATHS = 1500
+const RUNS = 5
+const SVG_FILE = "user://copy_mesh_upload.svg"
+
+
+func _write_svg():
+	var rng = RandomNumberGenerator.new()
+	rng.seed = 7
+	var svg = "<svg xmlns='http://www.w3.org/2000/svg' width='1024' height='1024'><defs>"
+	for i in range(8):
+		svg += "<linearGradient id='g%d' gradientUnits='userSpaceOnUse' x1='%d' y1='%d' x2='%d' y2='%d'>" % [
+				i, rng.randi() % 1024, rng.randi() % 1024, rng.randi() % 1024, rng.randi() % 1024]
+		svg += "<stop offset='0' stop-color='#%06x'/><stop offset='1' stop-color='#%06x'/></linearGradient>" % [
+				rng.randi() & 0xffffff, rng.randi() & 0xffffff]
+	svg += "</defs>"
+	for i in range(PATHS):
+		var x = rng.randf() * 1024
+		var y = rng.randf() * 1024
+		var d = "M%.1f %.1f" % [x, y]
+		for j in range(4):
+			d += " C%.1f %.1f %.1f %.1f %.1f %.1f" % [
+					x + rng.randf_range(-120, 120), y + rng.randf_range(-120, 120),
+					x + rng.randf_range(-120, 120), y + rng.randf_range(-120, 120),
+					x + rng.randf_range(-120, 120), y + rng.randf_range(-120, 120)]
+		var fill = "url(#g%d)" % (i % 8) if i % 3 == 0 else "#%06x" % (rng.randi() & 0xffffff)
+		svg += "<path d='%s Z' fill='%s' stroke='#%06x' stroke-width='%.1f'/>" % [
+				d, fill, rng.randi() & 0xffffff, rng.randf_range(0.5, 4.0)]
+	svg += "</svg>"
+
+	var file = File.new()
+	file.open(SVG_FILE, File.WRITE)
+	file.store_string(svg)
+	file.close()
+
+
+# usec from adding the paths to the tree until they are all drawn, which
+# tesselates and uploads every path once.
+func _time_run(direct_upload):
+	var renderer = VGMeshRenderer.new()
+	renderer.direct_upload = direct_upload
+	var path = VGPath.new()
+	path.renderer = renderer
+	path.import_svg(SVG_FILE)
+
+	var t0 = OS.get_ticks_usec()
+	root.add_child(path)
+	yield(self, "idle_frame")
+	yield(self, "idle_frame")
+	var usec = OS.get_ticks_usec() - t0
+
+	root.remove_child(path)
+	path.free()
+	return usec
+
+
+func _run():
+	_write_svg()
+	for direct_upload in [false, true]:
+		var best = 0
+		for run in range(RUNS):
+			var state = _time_run(direct_upload)
+			var usec = yield(state, "completed")
+			if run == 0 or usec < best:
+				best = usec
+		print("direct_upload %s: best of %d runs %.1f ms for %d paths" % [
+				direct_upload, RUNS, best / 1000.0, PATHS])
+	quit()
+
+
+func _initialize():
+	_run()
@@ -0,0 +1,173 @@
+// the quality tiers of VGSpriteRenderer: time and error of each, and how
+// well the final tier's dithering hides banding on a shallow gradient.
+// final is run with both kinds of dithering the rasterizer has.
+
+#include "nsvg.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+using namespace tove;
+
+static double now_ms() {
+	return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+// 400 stroked curves, a third of them filled with gradients.
+static std::string scene_svg() {
+	srand(7);
+	std::string s = "<svg xmlns='http://www.w3.org/2000/svg' width='1024' height='1024'><defs>";
+	for (int i = 0; i < 20; i++) {
+		char buf[512];
+		snprintf(buf, sizeof(buf), "<linearGradient id='g%d' gradientUnits='userSpaceOnUse' x1='%d' y1='%d' x2='%d' y2='%d'>"
+								   "<stop offset='0' stop-color='#%06x'/><stop offset='1' stop-color='#%06x'/></linearGradient>",
+				i, rand() % 1024, rand() % 1024, rand() % 1024, rand() % 1024, rand() & 0xffffff, rand() & 0xffffff);
+		s += buf;
+	}
+	s += "</defs>";
+	for (int i = 0; i < 400; i++) {
+		char fill[16], buf[512];
+		if (i % 3 == 0) {
+			snprintf(fill, sizeof(fill), "url(#g%d)", i % 20);
+		} else {
+			snprintf(fill, sizeof(fill), "#%06x", rand() & 0xffffff);
+		}
+		const float x = rand() % 1024, y = rand() % 1024;
+		auto r = [](float p) { return p + rand() % 300 - 150; };
+		snprintf(buf, sizeof(buf), "<path fill='%s' fill-opacity='0.8' stroke='#%06x' stroke-width='%.1f' "
+								   "d='M%.1f %.1f C%.0f %.0f %.0f %.0f %.0f %.0f S%.0f %.0f %.0f %.0f Z'/>",
+				fill, rand() & 0xffffff, 0.5f + (rand() % 30) / 10.0f, x, y,
+				r(x), r(y), r(x), r(y), r(x), r(y), r(x), r(y), r(x), r(y));
+		s += buf;
+	}
+	return s + "</svg>";
+}
+
+struct Tier {
+	const char *name;
+	int subsamples;
+	float tess_tolerance;
+	float dist_tolerance;
+	ToveDitherType dither;
+};
+
+static ToveRasterizeSettings make_settings(const Tier &p_tier, ToveRasterizeEngine p_engine) {
+	ToveRasterizeSettings settings = *nsvg::getDefaultRasterizeSettings();
+	settings.engine = p_engine;
+	if (p_tier.subsamples > 0) {
+		settings.subsamples = p_tier.subsamples;
+	}
+	settings.tessTolerance = p_tier.tess_tolerance;
+	settings.distTolerance = p_tier.dist_tolerance;
+	// as in tove_graphics_rasterize_into().
+	if (p_tier.dither == TOVE_DITHER_ORDERED) {
+		settings.quality.dither = ToveDither{ TOVE_DITHER_ORDERED, nsvg::getBlueNoise(32), 32, 32, 1.0f };
+	} else {
+		settings.quality.dither.type = p_tier.dither;
+	}
+	return settings;
+}
+
+// p_band > 0 rasterizes in bands of that many rows, if the image allows.
+static bool rasterize(NSVGimage *p_image, uint8_t *p_pixels, int p_width, int p_height,
+		const ToveRasterizeSettings &p_settings, int p_band) {
+	if (p_band <= 0) {
+		nsvg::rasterize(p_image, 0, 0, 1, p_pixels, p_width, p_height, p_width * 4, &p_settings, 0);
+		return true;
+	}
+	NSVGrasterJob *job = nsvg::beginRasterize(p_image, 0, 0, 1, p_pixels, p_width, p_height, p_width * 4, &p_settings, 0);
+	if (!job) {
+		return false;
+	}
+	for (int y = 0; y < p_height; y += p_band) {
+		nsvg::rasterizeBand(job, y, std::min(y + p_band, p_height), &p_settings);
+	}
+	for (int y = 0; y < p_height; y += p_band) {
+		nsvg::defringeBand(job, y, std::min(y + p_band, p_height));
+	}
+	nsvg::endRasterize(job);
+	return true;
+}
+
+// mean difference of 8x8 block averages of the red channel from the exact
+// gradient, roughly what is left of banding when seen from afar.
+static double banding(const std::vector<uint8_t> &p_pixels, int p_width, int p_height, float p_from, float p_to) {
+	double sum = 0;
+	int blocks = 0;
+	for (int by = 0; by + 8 <= p_height; by += 8) {
+		for (int bx = 0; bx + 8 <= p_width; bx += 8) {
+			double block = 0, exact = 0;
+			for (int y = by; y < by + 8; y++) {
+				for (int x = bx; x < bx + 8; x++) {
+					block += p_pixels[(y * p_width + x) * 4];
+					exact += p_from + (p_to - p_from) * (x + 0.5f) / p_width;
+				}
+			}
+			sum += fabs(block - exact) / 64;
+			blocks++;
+		}
+	}
+	return sum / blocks;
+}
+
+int main() {
+	const Tier tiers[] = {
+		{ "preview", 3, 0.5f, 0.05f, TOVE_DITHER_NONE },
+		{ "normal", 0, 0.25f, 0.01f, TOVE_DITHER_NONE },
+		{ "final, diffusion", 15, 0.1f, 0.005f, TOVE_DITHER_DIFFUSION },
+		{ "final, blue noise", 15, 0.1f, 0.005f, TOVE_DITHER_ORDERED },
+	};
+	const int w = 1024, h = 1024;
+
+	const std::string svg = scene_svg();
+	NSVGimage *image = nsvg::parseSVG(svg.c_str(), "px", 96);
+
+	ToveRasterizeSettings exact = *nsvg::getDefaultRasterizeSettings();
+	exact.engine = TOVE_RASTERIZE_ANALYTIC;
+	exact.tessTolerance = 0.01f;
+	exact.distTolerance = 0.001f;
+	std::vector<uint8_t> reference(w * h * 4), pixels(w * h * 4), banded(w * h * 4);
+	nsvg::rasterize(image, 0, 0, 1, reference.data(), w, h, w * 4, &exact, 0);
+
+	// a dark shallow gradient, 16 levels over the whole width.
+	const char *shallow_svg = "<svg xmlns='http://www.w3.org/2000/svg' width='1024' height='256'>"
+							  "<defs><linearGradient id='g' gradientUnits='userSpaceOnUse' x1='0' y1='0' x2='1024' y2='0'>"
+							  "<stop offset='0' stop-color='#202020'/><stop offset='1' stop-color='#303030'/></linearGradient></defs>"
+							  "<rect width='1024' height='256' fill='url(#g)'/></svg>";
+	NSVGimage *shallow = nsvg::parseSVG(shallow_svg, "px", 96);
+	std::vector<uint8_t> gradient(1024 * 256 * 4);
+
+	printf("1024x1024, mean channel error against an exact analytic raster, banding of a shallow gradient.\n");
+	printf("engine      tier                    time   error   banding   in bands\n");
+	for (int engine = 0; engine < 2; engine++) {
+		for (const Tier &tier : tiers) {
+			const ToveRasterizeSettings settings = make_settings(tier, (ToveRasterizeEngine)engine);
+			double best = 1e9;
+			for (int k = 0; k < 5; k++) {
+				const double t0 = now_ms();
+				rasterize(image, pixels.data(), w, h, settings, 0);
+				best = std::min(best, now_ms() - t0);
+			}
+			double error = 0;
+			for (size_t i = 0; i < pixels.size(); i++) {
+				error += abs(pixels[i] - reference[i]);
+			}
+			const char *bands = "no";
+			if (rasterize(image, banded.data(), w, h, settings, 37)) {
+				bands = banded == pixels ? "same pixels" : "DIFFERENT";
+			}
+			rasterize(shallow, gradient.data(), 1024, 256, settings, 0);
+			printf("%-10s  %-18s  %7.1f ms  %.3f   %.3f     %s\n", engine ? "analytic" : "subsampled", tier.name,
+					best, error / pixels.size(), banding(gradient, 1024, 256, 0x20, 0x30), bands);
+		}
+	}
+
+	nsvgDelete(shallow);
+	nsvgDelete(image);
+	return 0;
+}
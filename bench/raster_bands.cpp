@@ -0,0 +1,265 @@
+// banded rasterization as done by VGSpriteRenderer: checks that bands give the
+// same pixels as one pass, and times 1 to 16 threads on a pool that is kept
+// between rasters.
+
+#include "nsvg.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#if defined(__GLIBC__)
+#include <malloc.h>
+#endif
+
+using namespace tove;
+
+static double now_ms() {
+	return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+// bytes in use on the heap, over all malloc arenas.
+static long heap_kb() {
+#if defined(__GLIBC__) && (__GLIBC__ > 2 || __GLIBC_MINOR__ >= 33)
+	return mallinfo2().uordblks / 1024;
+#else
+	return 0;
+#endif
+}
+
+// like ThreadWorkPool: do_work() hands out indices to the pool threads and
+// waits for all of them.
+class Pool {
+	std::vector<std::thread> threads;
+	std::mutex mutex;
+	std::condition_variable wake, done;
+	std::function<void(int)> work;
+	std::atomic<int> next;
+	int count = 0;
+	int busy = 0;
+	unsigned generation = 0;
+	bool exit = false;
+
+	void run() {
+		unsigned seen = 0;
+		while (true) {
+			{
+				std::unique_lock<std::mutex> lock(mutex);
+				wake.wait(lock, [&] { return exit || generation != seen; });
+				if (exit) {
+					return;
+				}
+				seen = generation;
+			}
+			int i;
+			while ((i = next++) < count) {
+				work(i);
+			}
+			std::lock_guard<std::mutex> lock(mutex);
+			if (--busy == 0) {
+				done.notify_one();
+			}
+		}
+	}
+
+public:
+	explicit Pool(int p_threads) {
+		for (int i = 0; i < p_threads; i++) {
+			threads.emplace_back(&Pool::run, this);
+		}
+	}
+
+	~Pool() {
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			exit = true;
+		}
+		wake.notify_all();
+		for (auto &t : threads) {
+			t.join();
+		}
+	}
+
+	void do_work(int p_count, const std::function<void(int)> &p_work) {
+		std::unique_lock<std::mutex> lock(mutex);
+		work = p_work;
+		count = p_count;
+		next = 0;
+		busy = threads.size();
+		generation++;
+		wake.notify_all();
+		done.wait(lock, [&] { return busy == 0; });
+	}
+};
+
+static std::string make_svg(unsigned p_seed, bool p_clip, bool p_gradients) {
+	srand(p_seed);
+	std::string s = "<svg xmlns='http://www.w3.org/2000/svg' width='200' height='200'><defs>";
+	s += "<linearGradient id='g' gradientUnits='userSpaceOnUse' x1='0' y1='0' x2='200' y2='200'>"
+		 "<stop offset='0' stop-color='#f00'/><stop offset='1' stop-color='#00f' stop-opacity='0.5'/></linearGradient>";
+	s += "<radialGradient id='rg' gradientUnits='userSpaceOnUse' cx='100' cy='100' r='100'>"
+		 "<stop offset='0' stop-color='#ff0'/><stop offset='1' stop-color='#0a0'/></radialGradient>";
+	if (p_clip) {
+		s += "<clipPath id='c'><circle cx='100' cy='100' r='80'/></clipPath>";
+	}
+	s += "</defs><g" + std::string(p_clip ? " clip-path='url(#c)'" : "") + ">";
+	for (int i = 0; i < 300; i++) {
+		auto r = []() { return (rand() % 2600) / 10.0 - 30; };
+		const char *fill = p_gradients ? (i % 3 == 0 ? "url(#g)" : (i % 3 == 1 ? "url(#rg)" : "#3a7")) : "#3a7";
+		char buf[512];
+		snprintf(buf, sizeof(buf), "<path d='M%.1f %.1f C%.1f %.1f %.1f %.1f %.1f %.1f Q%.1f %.1f %.1f %.1f L%.1f %.1f Z' "
+								   "fill='%s' fill-opacity='%.2f' fill-rule='%s' stroke='#%06x' stroke-width='%.1f'/>",
+				r(), r(), r(), r(), r(), r(), r(), r(), r(), r(), r(), r(), r(), r(), fill,
+				(rand() % 100) / 100.0, (i & 1) ? "evenodd" : "nonzero", rand() & 0xffffff, (rand() % 60) / 10.0);
+		s += buf;
+	}
+	s += "</g></svg>";
+	return s;
+}
+
+// same band split as BandedRasterizer. r_band_ms gets the time of each band,
+// rasterizing and then defringing.
+static bool rasterize_banded(NSVGimage *p_image, float p_scale, uint8_t *p_pixels, int p_width, int p_height,
+		Pool &p_pool, int p_threads, std::vector<double> *r_band_ms = nullptr) {
+	NSVGrasterJob *job = nsvg::beginRasterize(p_image, 0, 0, p_scale, p_pixels, p_width, p_height, p_width * 4, nullptr);
+	if (!job) {
+		return false;
+	}
+	const int band = std::max(16, (p_height + p_threads * 4 - 1) / (p_threads * 4));
+	const int n = (p_height + band - 1) / band;
+	if (r_band_ms) {
+		r_band_ms->assign(2 * n, 0);
+	}
+	p_pool.do_work(n, [&](int i) {
+		const double t0 = now_ms();
+		nsvg::rasterizeBand(job, i * band, std::min((i + 1) * band, p_height), nullptr);
+		if (r_band_ms) {
+			(*r_band_ms)[i] += now_ms() - t0;
+		}
+	});
+	p_pool.do_work(n, [&](int i) {
+		const double t0 = now_ms();
+		nsvg::defringeBand(job, i * band, std::min((i + 1) * band, p_height));
+		if (r_band_ms) {
+			(*r_band_ms)[n + i] += now_ms() - t0;
+		}
+	});
+	nsvg::endRasterize(job);
+	return true;
+}
+
+// the wall time of the bands on p_threads cores, handing out bands in
+// order to the first thread that is free. defringing starts once all bands
+// are rasterized.
+static double schedule_ms(const std::vector<double> &p_band_ms, int p_threads) {
+	double total = 0;
+	const size_t n = p_band_ms.size() / 2;
+	for (int pass = 0; pass < 2; pass++) {
+		std::vector<double> free_at(p_threads, 0);
+		for (size_t i = 0; i < n; i++) {
+			*std::min_element(free_at.begin(), free_at.end()) += p_band_ms[pass * n + i];
+		}
+		total += *std::max_element(free_at.begin(), free_at.end());
+	}
+	return total;
+}
+
+int main() {
+	const int thread_counts[] = { 1, 2, 4, 8, 16 };
+
+	int failures = 0;
+	for (unsigned seed = 1; seed <= 6; seed++) {
+		const std::string svg = make_svg(seed, seed % 2, seed % 3 != 0);
+		NSVGimage *image = nsvg::parseSVG(svg.c_str(), "px", 96);
+		for (int size : { 37, 200, 400 }) {
+			const float scale = size / 200.0f;
+			std::vector<uint8_t> single(size * size * 4), banded(size * size * 4);
+			nsvg::rasterize(image, 0, 0, scale, single.data(), size, size, size * 4, nullptr);
+			for (int threads : { 1, 3, 8 }) {
+				Pool pool(threads);
+				std::fill(banded.begin(), banded.end(), 0xcd);
+				if (rasterize_banded(image, scale, banded.data(), size, size, pool, threads) &&
+						memcmp(single.data(), banded.data(), single.size())) {
+					printf("mismatch: seed %u, size %d, %d threads\n", seed, size, threads);
+					failures++;
+				}
+			}
+		}
+		nsvgDelete(image);
+	}
+	printf("banded vs single pass: %d mismatches\n", failures);
+
+	const std::string svg = make_svg(99, true, true);
+	NSVGimage *image = nsvg::parseSVG(svg.c_str(), "px", 96);
+	const int w = 1920, h = 1080;
+	const float scale = w / 200.0f;
+	std::vector<uint8_t> single(w * h * 4), banded(w * h * 4);
+
+	double single_ms = 1e9;
+	for (int k = 0; k < 2; k++) {
+		const double t0 = now_ms();
+		nsvg::rasterize(image, 0, 0, scale, single.data(), w, h, w * 4, nullptr);
+		single_ms = std::min(single_ms, now_ms() - t0);
+	}
+	printf("\n%dx%d, %u cores. single pass: %.1f ms\n", w, h, std::thread::hardware_concurrency(), single_ms);
+	printf("threads   measured   speedup   bands   cpu time   on %2s cores\n", "n");
+
+	for (int threads : thread_counts) {
+		Pool pool(threads);
+		double best = 1e9;
+		std::vector<double> band_ms;
+		for (int k = 0; k < 2; k++) {
+			const double t0 = now_ms();
+			rasterize_banded(image, scale, banded.data(), w, h, pool, threads);
+			best = std::min(best, now_ms() - t0);
+		}
+		// the bands again one at a time, to see what they would take on as
+		// many cores as threads.
+		Pool one(1);
+		rasterize_banded(image, scale, banded.data(), w, h, one, threads, &band_ms);
+		double cpu_ms = 0;
+		for (double ms : band_ms) {
+			cpu_ms += ms;
+		}
+		const double modeled = schedule_ms(band_ms, threads);
+		printf("%7d   %6.1f ms   %6.2fx   %5d   %6.1f ms   %6.1f ms (%.2fx)%s\n", threads, best, single_ms / best,
+				(int)band_ms.size() / 2, cpu_ms, modeled, single_ms / modeled,
+				memcmp(single.data(), banded.data(), single.size()) ? "  MISMATCH" : "");
+	}
+
+	// a pool per raster, as before: every thread leaves its rasterizer
+	// behind unless it gets freed on thread exit.
+	const int small = 128;
+	std::vector<uint8_t> pixels(small * small * 4);
+	const long heap0 = heap_kb();
+	double spawn_ms = 0, pooled_ms = 0;
+	for (int k = 0; k < 200; k++) {
+		const double t0 = now_ms();
+		Pool pool(8);
+		rasterize_banded(image, small / 200.0f, pixels.data(), small, small, pool, 8);
+		spawn_ms += now_ms() - t0;
+	}
+	const long heap1 = heap_kb();
+	{
+		Pool pool(8);
+		for (int k = 0; k < 200; k++) {
+			const double t0 = now_ms();
+			rasterize_banded(image, small / 200.0f, pixels.data(), small, small, pool, 8);
+			pooled_ms += now_ms() - t0;
+		}
+	}
+	printf("\n%dx%d, 8 threads, 200 rasters: %.2f ms each with a new pool, %.2f ms with one pool, heap %+ld KiB\n",
+			small, small, spawn_ms / 200, pooled_ms / 200, heap1 - heap0);
+
+	nsvgDelete(image);
+	return failures ? 1 : 0;
+}
@@ -0,0 +1,151 @@
+// bit-exact check of the SSE2 and AVX2 span kernels in svgrast.cpp against
+// the scalar reference. random spans go through the solid color and alpha
+// scanlines, random scenes with linear and radial gradients through the
+// whole rasterizer, once per kernel limit, and the results get compared
+// with memcmp.
+//
+// builds nsvg.cpp itself, with TOVE_RASTER_TEST, so leave it out of the
+// sources (one line, a backslash would continue this comment):
+//   g++ -O2 -std=c++14 -pthread -Ibench/stub -Ithirdparty -Ithirdparty/tove2d/src/cpp bench/simd_spans.cpp thirdparty/tinyxml2/tinyxml2.cpp -o simd_spans
+
+#define TOVE_RASTER_TEST 1
+#include "nsvg.cpp"
+
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+using namespace tove;
+
+static const char *kernel_names[] = { "scalar", "SSE2", "AVX2" };
+
+static unsigned char random_byte() {
+	// coverage and alpha are 0 or 255 most of the time.
+	switch (rand() % 4) {
+		case 0:
+			return 0;
+		case 1:
+			return 255;
+		default:
+			return rand() & 0xff;
+	}
+}
+
+// runs p_scanline on the same random spans with every kernel limit.
+static int check_spans(const char *p_name, TOVEscanlineFunction p_scanline, int p_pixel_size) {
+	const int width = 96;
+	std::vector<unsigned char> cover(width), input(width * 4), reference(width * 4), output(width * 4);
+
+	NSVGrasterizer r;
+	memset(&r, 0, sizeof(r));
+	r.stride = width * p_pixel_size;
+	TOVEclip clip;
+	memset(&clip, 0, sizeof(clip));
+	NSVGcachedPaint cache;
+	memset(&cache, 0, sizeof(cache));
+
+	int failures = 0;
+	for (int trial = 0; trial < 50000; trial++) {
+		const int x = rand() % 8;
+		const int count = rand() % (width - x + 1);
+		for (int i = 0; i < width; i++) {
+			cover[i] = random_byte();
+		}
+		for (auto &b : input) {
+			b = random_byte();
+		}
+		cache.colors[0] = random_byte() | (random_byte() << 8) | (random_byte() << 16) | (unsigned(random_byte()) << 24);
+
+		for (int limit = 0; limit <= 2; limit++) {
+			std::vector<unsigned char> scanline = cover;
+			std::vector<unsigned char> &bitmap = limit == 0 ? reference : output;
+			bitmap = input;
+			r.scanline = scanline.data();
+			r.bitmap = bitmap.data();
+			tove__rasterSIMDLimit = limit;
+			p_scanline(&r, x, 0, count, 0, 0, 1, &cache, &clip);
+			if (limit > 0 && memcmp(reference.data(), output.data(), output.size())) {
+				if (failures++ < 5) {
+					printf("  %s: %s differs, x %d, count %d, color %08x\n",
+							p_name, kernel_names[limit], x, count, cache.colors[0]);
+				}
+			}
+		}
+	}
+	printf("%-24s %d mismatches\n", p_name, failures);
+	return failures;
+}
+
+static std::string make_svg(unsigned p_seed) {
+	srand(p_seed);
+	std::string s = "<svg xmlns='http://www.w3.org/2000/svg' width='200' height='200'><defs>";
+	s += "<linearGradient id='g' x1='0' y1='0' x2='1' y2='1'>"
+		 "<stop offset='0' stop-color='#f00'/><stop offset='0.4' stop-color='#0f0' stop-opacity='0.3'/>"
+		 "<stop offset='1' stop-color='#00f' stop-opacity='0.5'/></linearGradient>";
+	s += "<radialGradient id='rg' gradientUnits='userSpaceOnUse' cx='100' cy='100' r='70' "
+		 "gradientTransform='rotate(20) scale(1.3 0.7)'>"
+		 "<stop offset='0' stop-color='#ff0'/><stop offset='1' stop-color='#0a0'/></radialGradient>";
+	s += "<clipPath id='c'><circle cx='100' cy='100' r='80'/></clipPath></defs>";
+	s += "<g" + std::string(p_seed % 2 ? " clip-path='url(#c)'" : "") + ">";
+	for (int i = 0; i < 200; i++) {
+		auto r = []() { return (rand() % 2600) / 10.0 - 30; };
+		const char *fill = i % 3 == 0 ? "url(#g)" : (i % 3 == 1 ? "url(#rg)" : "#3a7");
+		char buf[512];
+		snprintf(buf, sizeof(buf), "<path d='M%.1f %.1f C%.1f %.1f %.1f %.1f %.1f %.1f Q%.1f %.1f %.1f %.1f L%.1f %.1f Z' "
+								   "fill='%s' fill-opacity='%.2f' fill-rule='%s' stroke='url(#rg)' stroke-width='%.1f'/>",
+				r(), r(), r(), r(), r(), r(), r(), r(), r(), r(), r(), r(), r(), r(), fill,
+				(rand() % 100) / 100.0, (i & 1) ? "evenodd" : "nonzero", (rand() % 60) / 10.0);
+		s += buf;
+	}
+	return s + "</g></svg>";
+}
+
+// whole rasters with undithered gradients, the one kind that has kernels.
+static int check_rasters() {
+	ToveRasterizeSettings settings = *nsvg::getDefaultRasterizeSettings();
+	settings.quality.dither.type = TOVE_DITHER_NONE;
+
+	int failures = 0, rasters = 0;
+	for (unsigned seed = 1; seed <= 8; seed++) {
+		const std::string svg = make_svg(seed);
+		NSVGimage *image = nsvg::parseSVG(svg.c_str(), "px", 96);
+		for (int size : { 7, 61, 203, 517 }) {
+			for (int flags : { 0, (int)NSVG_RASTER_ALPHA }) {
+				const int stride = flags ? size : size * 4;
+				std::vector<uint8_t> reference(size_t(stride) * size), output(reference.size());
+				for (int limit = 0; limit <= 2; limit++) {
+					tove__rasterSIMDLimit = limit;
+					nsvg::rasterize(image, 0.3f, 0.7f, size / 200.0f, limit ? output.data() : reference.data(),
+							size, size, stride, &settings, flags);
+					if (limit > 0 && memcmp(reference.data(), output.data(), output.size())) {
+						printf("  raster: %s differs, seed %u, size %d%s\n",
+								kernel_names[limit], seed, size, flags ? ", alpha" : "");
+						failures++;
+					}
+				}
+				rasters++;
+			}
+		}
+		nsvgDelete(image);
+	}
+	printf("%-24s %d mismatches in %d rasters\n", "gradient rasters", failures, rasters);
+	return failures;
+}
+
+int main() {
+#if TOVE_RASTER_AVX2
+	const bool avx2 = __builtin_cpu_supports("avx2");
+#else
+	const bool avx2 = false;
+#endif
+	printf("kernels: SSE2 %s, AVX2 %s\n", TOVE_RASTER_SSE2 ? "yes" : "no",
+			avx2 ? "yes" : "no (its runs use SSE2 again)");
+
+	srand(1);
+	int failures = 0;
+	failures += check_spans("color spans", tove__drawColorScanline, 4);
+	failures += check_spans("alpha spans", tove__drawAlphaScanline, 1);
+	failures += check_rasters();
+	return failures ? 1 : 0;
+}
@@ -0,0 +1,14 @@
+// just enough of godot's error macros to build tove outside of the engine.
+#pragma once
+#include <cstdio>
+#include <cstring>
+#define ERR_PRINT(x) fprintf(stderr, "%s\n", x)
+#define WARN_PRINT(x) fprintf(stderr, "%s\n", x)
+#define ERR_FAIL_COND(x) \
+	if (x)               \
+	return
+#define ERR_FAIL_COND_V(x, v) \
+	if (x)                    \
+	return v
+#define CRASH_NOW()
+#define CRASH_NOW_MSG(x) ERR_PRINT(x)
@@ -0,0 +1,24 @@
+// declarations only, for building the parts of tove that do not clip.
+#pragma once
+#include <vector>
+#include <cstdint>
+namespace ClipperLib {
+typedef int64_t cInt;
+struct IntPoint { cInt X, Y; IntPoint(cInt x = 0, cInt y = 0) : X(x), Y(y) {} };
+typedef std::vector<IntPoint> Path;
+typedef std::vector<Path> Paths;
+enum ClipType { ctIntersection, ctUnion, ctDifference, ctXor };
+enum PolyType { ptSubject, ptClip };
+enum PolyFillType { pftEvenOdd, pftNonZero, pftPositive, pftNegative };
+enum JoinType { jtSquare, jtRound, jtMiter };
+enum EndType { etClosedPolygon, etClosedLine, etOpenButt, etOpenSquare, etOpenRound };
+class PolyNode { public: Path Contour; std::vector<PolyNode*> Childs; PolyNode *Parent; int ChildCount() const; bool IsHole() const; bool IsOpen() const; PolyNode *GetNext() const; };
+class PolyTree : public PolyNode { public: void Clear(); PolyNode *GetFirst() const; int Total() const; };
+class Clipper { public: Clipper(int = 0); bool AddPath(const Path&, PolyType, bool); bool AddPaths(const Paths&, PolyType, bool); void Clear();
+ bool Execute(ClipType, Paths&, PolyFillType = pftEvenOdd, PolyFillType = pftEvenOdd); bool Execute(ClipType, PolyTree&, PolyFillType = pftEvenOdd, PolyFillType = pftEvenOdd); };
+class ClipperOffset { public: ClipperOffset(double = 2.0, double = 0.25); double MiterLimit; double ArcTolerance; void AddPath(const Path&, JoinType, EndType); void AddPaths(const Paths&, JoinType, EndType); void Execute(Paths&, double); void Execute(PolyTree&, double); void Clear(); };
+void SimplifyPolygons(Paths&, PolyFillType = pftEvenOdd);
+void SimplifyPolygons(const Paths&, Paths&, PolyFillType = pftEvenOdd);
+void ClosedPathsFromPolyTree(const PolyTree&, Paths&);
+void OpenPathsFromPolyTree(PolyTree&, Paths&);
+}
@@ -0,0 +1,125 @@
+// allocations per path of Triangulate_EC on polypartition lists, as
+// Submesh::addClipperPaths did before, against TriangulationArena, and a
+// check that both give the same triangles.
+
+#include "mesh/triangulate.h"
+
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+#include <vector>
+
+using namespace tove;
+
+static long allocations = 0;
+
+void *operator new(size_t p_size) {
+	allocations++;
+	void *p = malloc(p_size ? p_size : 1);
+	if (!p) {
+		throw std::bad_alloc();
+	}
+	return p;
+}
+
+void *operator new[](size_t p_size) {
+	return operator new(p_size);
+}
+
+void operator delete(void *p) noexcept {
+	free(p);
+}
+
+void operator delete[](void *p) noexcept {
+	free(p);
+}
+
+void operator delete(void *p, size_t) noexcept {
+	free(p);
+}
+
+void operator delete[](void *p, size_t) noexcept {
+	free(p);
+}
+
+int main() {
+	const int paths = 2000;
+	const int warmup = 1000;
+
+	srand(1);
+	long legacy_allocations = 0, arena_allocations = 0;
+	int mismatches = 0, failures = 0;
+
+	for (int t = 0; t < paths; t++) {
+		TriangulationArena &arena = TriangulationArena::local();
+		arena.clear();
+		std::list<ToveTPPLPoly> polys;
+
+		// an outline with up to two holes.
+		const int npolys = 1 + rand() % 3;
+		int id = 0;
+		for (int k = 0; k < npolys; k++) {
+			const int n = 3 + rand() % 12;
+			const double r0 = k == 0 ? 100 : 20;
+			const double cx = k == 0 ? 0 : (k == 1 ? -40 : 40);
+			ToveTPPLPoly poly;
+			poly.Init(n);
+			TPPLPoint *points = arena.addPolygon(n);
+			for (int j = 0; j < n; j++) {
+				const double a = (k == 0 ? 1 : -1) * 2 * M_PI * j / n;
+				const double r = r0 * (0.6 + 0.4 * (rand() % 100) / 100.0);
+				poly[j].x = points[j].x = cx + r * cos(a);
+				poly[j].y = points[j].y = r * sin(a);
+				poly[j].id = points[j].id = id++;
+			}
+			if (poly.GetOrientation() == TPPL_CW) {
+				poly.SetHole(true);
+			}
+			arena.applyHoles(TOVE_HOLES_CW);
+			polys.push_back(poly);
+		}
+
+		long a0 = allocations;
+		ToveTPPLPartition partition;
+		std::list<ToveTPPLPoly> triangles;
+		const bool legacy_ok = partition.Triangulate_EC(&polys, &triangles);
+		legacy_allocations += allocations - a0;
+
+		// the arena's buffers only grow during the first paths.
+		a0 = allocations;
+		std::vector<ToveVertexIndex> indices;
+		const int count = arena.removeHoles() ? arena.countTriangles() : -1;
+		bool arena_ok = false;
+		if (count >= 0) {
+			indices.resize(count * 3);
+			arena_ok = arena.triangulate(indices.data());
+		}
+		// indices is not counted, Submesh writes into the TriangleStore.
+		if (t >= warmup) {
+			arena_allocations += allocations - a0 - (count > 0 ? 1 : 0);
+		}
+
+		if (!legacy_ok) {
+			failures++;
+		}
+		if (legacy_ok != arena_ok || (legacy_ok && (int)triangles.size() != count)) {
+			mismatches++;
+			continue;
+		}
+		int i = 0;
+		for (auto &triangle : triangles) {
+			if (triangle[0].id != indices[i] || triangle[1].id != indices[i + 1] || triangle[2].id != indices[i + 2]) {
+				mismatches++;
+				break;
+			}
+			i += 3;
+		}
+	}
+
+	printf("allocations per path: polypartition %.1f, arena %.3f (after %d paths)\n",
+			legacy_allocations / double(paths), arena_allocations / double(paths - warmup), warmup);
+	printf("%d paths, %d with different triangles, %d invalid, arena grew %llu times\n",
+			paths, mismatches, failures, (unsigned long long)TriangulationArena::local().getGrowCount());
+	return mismatches ? 1 : 0;
+}
@@ -0,0 +1,160 @@
+// time and triangle quality of the fill triangulators Submesh::addClipperPaths
+// can use, on large closed outlines with and without holes. quality is the
+// mean smallest angle of the triangles and the share of slivers, i.e.
+// triangles with an angle below 5 degrees.
+
+#include "mesh/triangulate.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <vector>
+
+using namespace tove;
+
+static double now_ms() {
+	return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+static double min_angle(const TPPLPoint &p_a, const TPPLPoint &p_b, const TPPLPoint &p_c) {
+	auto angle = [](const TPPLPoint &p, const TPPLPoint &q, const TPPLPoint &r) {
+		const double ux = q.x - p.x, uy = q.y - p.y, vx = r.x - p.x, vy = r.y - p.y;
+		const double d = (ux * vx + uy * vy) / (sqrt(ux * ux + uy * uy) * sqrt(vx * vx + vy * vy) + 1e-30);
+		return acos(std::max(-1.0, std::min(1.0, d)));
+	};
+	return std::min(angle(p_a, p_b, p_c), std::min(angle(p_b, p_c, p_a), angle(p_c, p_a, p_b))) * 180 / M_PI;
+}
+
+struct Quality {
+	double mean = 0;
+	double slivers = 0;
+	int triangles = 0;
+
+	void add(double p_angle) {
+		mean += p_angle;
+		slivers += p_angle < 5;
+		triangles++;
+	}
+
+	void finish() {
+		if (triangles > 0) {
+			mean /= triangles;
+			slivers = 100 * slivers / triangles;
+		}
+	}
+};
+
+// a coastline like outline of p_n points, with p_holes round holes of
+// p_n / 16 points each. holes run clockwise, as TOVE_HOLES_CW expects.
+static void make_shape(TriangulationArena &r_arena, std::vector<TPPLPoint> &r_points, int p_n, int p_holes) {
+	r_arena.clear();
+	r_points.clear();
+	int id = 0;
+	TPPLPoint *outline = r_arena.addPolygon(p_n);
+	for (int j = 0; j < p_n; j++) {
+		const double a = 2 * M_PI * j / p_n;
+		const double r = 100 * (1 + 0.3 * sin(17 * a) + 0.1 * sin(131 * a));
+		outline[j].x = r * cos(a);
+		outline[j].y = r * sin(a);
+		outline[j].id = id++;
+		r_points.push_back(outline[j]);
+	}
+	r_arena.applyHoles(TOVE_HOLES_CW);
+	for (int k = 0; k < p_holes; k++) {
+		const int n = std::max(3, p_n / 16);
+		const double cx = 30 * cos(2 * M_PI * k / p_holes), cy = 30 * sin(2 * M_PI * k / p_holes);
+		TPPLPoint *hole = r_arena.addPolygon(n);
+		for (int j = 0; j < n; j++) {
+			const double a = -2 * M_PI * j / n;
+			hole[j].x = cx + 8 * cos(a);
+			hole[j].y = cy + 8 * sin(a);
+			hole[j].id = id++;
+			r_points.push_back(hole[j]);
+		}
+		r_arena.applyHoles(TOVE_HOLES_CW);
+	}
+}
+
+// like Submesh::addClipperPaths with the given triangulator. returns the
+// time in ms, or a negative value if triangulation failed.
+static double triangulate(ToveTriangulator p_triangulator, int p_n, int p_holes, Quality &r_quality) {
+	TriangulationArena &arena = TriangulationArena::local();
+	std::vector<TPPLPoint> points;
+	make_shape(arena, points, p_n, p_holes);
+
+	const double t0 = now_ms();
+	if (p_triangulator == TOVE_TRIANGULATOR_EC) {
+		const int count = arena.removeHoles() ? arena.countTriangles() : -1;
+		std::vector<ToveVertexIndex> indices(std::max(0, count) * 3);
+		if (count < 0 || !arena.triangulate(indices.data())) {
+			return -1;
+		}
+		const double ms = now_ms() - t0;
+		for (int i = 0; i < count * 3; i += 3) {
+			r_quality.add(min_angle(points[indices[i]], points[indices[i + 1]], points[indices[i + 2]]));
+		}
+		r_quality.finish();
+		return ms;
+	}
+
+	std::list<ToveTPPLPoly> polys, triangles;
+	arena.copyPolygons(polys);
+	ToveTPPLPartition partition;
+	bool success;
+	if (p_triangulator == TOVE_TRIANGULATOR_MONO) {
+		success = partition.Triangulate_MONO(&polys, &triangles) != 0;
+	} else {
+		std::list<ToveTPPLPoly> outlines;
+		success = partition.RemoveHoles(&polys, &outlines) != 0;
+		for (auto i = outlines.begin(); success && i != outlines.end(); i++) {
+			success = partition.Triangulate_OPT(&*i, &triangles) != 0;
+		}
+	}
+	if (!success) {
+		return -1;
+	}
+	const double ms = now_ms() - t0;
+	for (auto &triangle : triangles) {
+		r_quality.add(min_angle(triangle[0], triangle[1], triangle[2]));
+	}
+	r_quality.finish();
+	return ms;
+}
+
+int main() {
+	const struct {
+		ToveTriangulator triangulator;
+		const char *name;
+		int max_points; // above this it takes far too long.
+	} triangulators[] = {
+		{ TOVE_TRIANGULATOR_EC, "EC", 16384 },
+		{ TOVE_TRIANGULATOR_MONO, "MONO", 1 << 30 },
+		{ TOVE_TRIANGULATOR_OPT, "OPT", 256 },
+	};
+
+	printf("points  holes  triangulator        time   mean min angle   slivers\n");
+	for (int holes : { 0, 4 }) {
+		for (int n : { 64, 256, 1024, 4096, 16384, 65536 }) {
+			for (const auto &t : triangulators) {
+				if (n > t.max_points) {
+					continue;
+				}
+				const int reps = n >= 4096 ? 1 : (n >= 1024 ? 3 : 20);
+				double best = 1e30;
+				Quality quality;
+				for (int rep = 0; rep < reps && best >= 0; rep++) {
+					quality = Quality();
+					best = std::min(best, triangulate(t.triangulator, n, holes, quality));
+				}
+				if (best < 0) {
+					printf("%6d  %5d  %-12s      failed\n", n, holes, t.name);
+				} else {
+					printf("%6d  %5d  %-12s %9.3f ms   %6.1f deg   %6.1f%%\n",
+							n, holes, t.name, best, quality.mean, quality.slivers);
+				}
+			}
+		}
+	}
+	return 0;
+}
@@ -36,7 +36,9 @@ public:
 	virtual int get_preset_count() const G_OVERRIDE { return 0; }
 	virtual String get_preset_name(int p_idx) const G_OVERRIDE { return String(); }
 
-	virtual void get_import_options(List<ImportOption> *r_options, int p_preset = 0) const G_OVERRIDE { }
+	virtual void get_import_options(List<ImportOption> *r_options, int p_preset = 0) const G_OVERRIDE {
+		r_options->push_back(ImportOption(PropertyInfo(Variant::INT, "triangulator", PROPERTY_HINT_ENUM, "Auto,Ear Clipping,Monotone,Optimal"), VGMeshRenderer::TRIANGULATOR_AUTO));
+	}
 	virtual bool get_option_visibility(const String &p_option, const Map<StringName, Variant> &p_options) const G_OVERRIDE { return true; }
 	virtual Error import(const String &p_source_file, const String &p_save_path, const Map<StringName, Variant> &p_options, List<String> *r_platform_variants, List<String> *r_gen_files = nullptr, Variant *r_metadata = nullptr) G_OVERRIDE;
 
@@ -75,26 +77,34 @@ Error ResourceImporterSVGNode2D::import(const String &p_source_file, const Strin
 	print_verbose(vformat("[SVG] Processing %d paths ...", n));
 	EditorProgress progress("import", TTR("Importing Vector Graphics"), n + 2);
 	Ref<VGMeshRenderer> renderer = newref(VGMeshRenderer);
+	renderer->set_triangulator(VGMeshRenderer::Triangulator(int(p_options["triangulator"])));
 	Node2D *root = memnew(Node2D);
 	VGPath *root_path = memnew(VGPath(tove::tove_make_shared<tove::Path>()));
 	root->add_child(root_path);
 	root_path->set_owner(root);
 	root_path->set_renderer(renderer);
+	Vector<VGPath *> paths;
+	paths.resize(n);
 	for (int i = 0; i < n; i++) {
-		progress.step(TTR("Importing Paths..."), i);
 		tove::PathRef tove_path = tove_graphics->getPath(i);
 		Point2 center = compute_center(tove_path);
 		tove_path->set(tove_path, tove::nsvg::Transform(1, 0, -center.x, 0, 1, -center.y));
 		VGPath *path = memnew(VGPath(tove_path));
 		path->set_position(center);
-		std::string name = tove_path->getName();
+		root_path->add_child(path);
+		path->set_owner(root);
+		paths.write[i] = path;
+	}
+	progress.step(TTR("Tesselating Paths..."), 0);
+	renderer->prepare_meshes(paths, true);
+	for (int i = 0; i < n; i++) {
+		progress.step(TTR("Importing Paths..."), i);
+		VGPath *path = paths[i];
+		std::string name = path->get_tove_path()->getName();
 		if (name.empty()) {
 			name = "Path";
 		}
 
-		root_path->add_child(path);
-		path->set_owner(root);
-
 		MeshInstance2D *mesh_inst = memnew(MeshInstance2D);
 		Ref<ArrayMesh> mesh;
 		mesh.instance();
@@ -107,7 +117,8 @@ Error ResourceImporterSVGNode2D::import(const String &p_source_file, const Strin
 		mesh_inst->set_mesh(mesh);
 		mesh_inst->set_material(renderer_material);
 		mesh_inst->set_texture(texture);
-		Transform2D path_xform = path->get_transform();
+		// meshes with bounds relative positions carry their own transform.
+		Transform2D path_xform = path->get_transform() * get_mesh_position_transform(mesh);
 		mesh_inst->set_transform(path_xform);
 		mesh_inst->set_name(String(name.c_str()));
 		mesh_inst->set_z_index(i);
@@ -142,7 +153,9 @@ public:
 	virtual int get_preset_count() const G_OVERRIDE { return 0; }
 	virtual String get_preset_name(int p_idx) const G_OVERRIDE { return String(); }
 
-	virtual void get_import_options(List<ImportOption> *r_options, int p_preset = 0) const G_OVERRIDE { }
+	virtual void get_import_options(List<ImportOption> *r_options, int p_preset = 0) const G_OVERRIDE {
+		r_options->push_back(ImportOption(PropertyInfo(Variant::INT, "triangulator", PROPERTY_HINT_ENUM, "Auto,Ear Clipping,Monotone,Optimal"), VGMeshRenderer::TRIANGULATOR_AUTO));
+	}
 	virtual bool get_option_visibility(const String &p_option, const Map<StringName, Variant> &p_options) const G_OVERRIDE { return true; }
 	virtual Error import(const String &p_source_file, const String &p_save_path, const Map<StringName, Variant> &p_options, List<String> *r_platform_variants, List<String> *r_gen_files = nullptr, Variant *r_metadata = nullptr) G_OVERRIDE;
 
@@ -181,6 +194,7 @@ Error ResourceImporterSVGSpatial::import(const String &p_source_file, const Stri
 	print_verbose(vformat("[SVG] Processing %d paths ...", n));
 	EditorProgress progress("import", TTR("Importing Vector Graphics"), n + 2);
 	Ref<VGMeshRenderer> renderer = newref(VGMeshRenderer);
+	renderer->set_triangulator(VGMeshRenderer::Triangulator(int(p_options["triangulator"])));
 	renderer->set_quality(0.4);
 	Spatial *root = memnew(Spatial);
 	VGPath *root_path = memnew(VGPath(tove::tove_make_shared<tove::Path>()));
@@ -193,8 +207,9 @@ Error ResourceImporterSVGSpatial::import(const String &p_source_file, const Stri
 		Ref<ArrayMesh> combined_mesh;
 		combined_mesh.instance();
 		Ref<SurfaceTool> st = newref(SurfaceTool);
+		Vector<VGPath *> paths;
+		paths.resize(n);
 		for (int i = 0; i < n; i++) {
-			progress.step(TTR("Importing and Merge Paths..."), i);
 			tove::PathRef tove_path = tove_graphics->getPath(i);
 			Point2 center = compute_center(tove_path);
 			tove_path->set(tove_path, tove::nsvg::Transform(1, 0, -center.x, 0, 1, -center.y));
@@ -202,6 +217,14 @@ Error ResourceImporterSVGSpatial::import(const String &p_source_file, const Stri
 			path->set_position(center);
 			root_path->add_child(path);
 			path->set_owner(root);
+			paths.write[i] = path;
+		}
+		progress.step(TTR("Tesselating Paths..."), 0);
+		renderer->prepare_meshes(paths, true);
+		for (int i = 0; i < n; i++) {
+			progress.step(TTR("Importing and Merge Paths..."), i);
+			VGPath *path = paths[i];
+			const Point2 center = path->get_position();
 			Ref<ArrayMesh> mesh = newref(ArrayMesh);
 			Ref<Texture> texture;
 			Ref<Material> renderer_material;
@@ -234,8 +257,9 @@ Error ResourceImporterSVGSpatial::import(const String &p_source_file, const Stri
 		root->add_child(spatial);
 		spatial->set_owner(root);
 		AABB bounds;
+		Vector<VGPath *> paths;
+		paths.resize(n);
 		for (int mesh_i = 0; mesh_i < n; mesh_i++) {
-			progress.step(TTR("Importing Paths..."), mesh_i);
 			tove::PathRef tove_path = tove_graphics->getPath(mesh_i);
 			Point2 center = compute_center(tove_path);
 			tove_path->set(tove_path, tove::nsvg::Transform(1, 0, -center.x, 0, 1, -center.y));
@@ -243,6 +267,15 @@ Error ResourceImporterSVGSpatial::import(const String &p_source_file, const Stri
 			path->set_position(center);
 			root_path->add_child(path);
 			path->set_owner(root);
+			paths.write[mesh_i] = path;
+		}
+		progress.step(TTR("Tesselating Paths..."), 0);
+		renderer->prepare_meshes(paths, true);
+		for (int mesh_i = 0; mesh_i < n; mesh_i++) {
+			progress.step(TTR("Importing Paths..."), mesh_i);
+			VGPath *path = paths[mesh_i];
+			tove::PathRef tove_path = path->get_tove_path();
+			const Point2 center = path->get_position();
 			Ref<ArrayMesh> mesh = newref(ArrayMesh);
 			Ref<Texture> texture;
 			Ref<Material> renderer_material;
@@ -307,7 +340,9 @@ public:
 	virtual int get_preset_count() const G_OVERRIDE { return 0; }
 	virtual String get_preset_name(int p_idx) const G_OVERRIDE { return String(); }
 
-	virtual void get_import_options(List<ImportOption> *r_options, int p_preset = 0) const G_OVERRIDE { }
+	virtual void get_import_options(List<ImportOption> *r_options, int p_preset = 0) const G_OVERRIDE {
+		r_options->push_back(ImportOption(PropertyInfo(Variant::INT, "triangulator", PROPERTY_HINT_ENUM, "Auto,Ear Clipping,Monotone,Optimal"), VGMeshRenderer::TRIANGULATOR_AUTO));
+	}
 	virtual bool get_option_visibility(const String &p_option, const Map<StringName, Variant> &p_options) const G_OVERRIDE { return true; }
 	virtual Error import(const String &p_source_file, const String &p_save_path, const Map<StringName, Variant> &p_options, List<String> *r_platform_variants, List<String> *r_gen_files = nullptr, Variant *r_metadata = nullptr) G_OVERRIDE;
 
@@ -347,6 +382,7 @@ Error ResourceImporterSVGVGPath::import(const String &p_source_file, const Strin
 	print_verbose(vformat("[SVG] Processing %d paths ...", n));
 	EditorProgress progress("import", TTR("Importing Vector Graphics"), n + 2);
 	Ref<VGMeshRenderer> renderer = newref(VGMeshRenderer);
+	renderer->set_triangulator(VGMeshRenderer::Triangulator(int(p_options["triangulator"])));
 	Node2D *root = memnew(Node2D);
 	VGPath *root_path = memnew(VGPath(tove::tove_make_shared<tove::Path>()));
 	root->add_child(root_path);
@@ -425,6 +461,8 @@ Node *EditorSceneImporterSVG::import_scene(const String &p_path, uint32_t p_flag
 	root_path->set_renderer(renderer);
 	Node *root = memnew(Node);
 	Ref<SurfaceTool> st = newref(SurfaceTool);
+	Vector<VGPath *> paths;
+	paths.resize(n);
 	for (int mesh_i = 0; mesh_i < n; mesh_i++) {
 		tove::PathRef tove_path = tove_graphics->getPath(mesh_i);
 		Point2 center = compute_center(tove_path);
@@ -433,6 +471,12 @@ Node *EditorSceneImporterSVG::import_scene(const String &p_path, uint32_t p_flag
 		path->set_position(center);
 		root_path->add_child(path, true);
 		path->set_owner(root);
+		paths.write[mesh_i] = path;
+	}
+	renderer->prepare_meshes(paths, true);
+	for (int mesh_i = 0; mesh_i < n; mesh_i++) {
+		VGPath *path = paths[mesh_i];
+		const Point2 center = path->get_position();
 		Ref<ArrayMesh> mesh = newref(ArrayMesh);
 		Ref<Texture> texture;
 		Ref<Material> renderer_material;
@@ -12,7 +12,11 @@
 #include "vector_graphics_radial_gradient.h"
 #include "vector_graphics_renderer.h"
 #include "vector_graphics_texture_renderer.h"
+#include "vector_graphics_sdf_renderer.h"
 #include "vector_graphics_adaptive_renderer.h"
+#include "vector_graphics_rigid_renderer.h"
+#include "vector_graphics_morph.h"
+#include "utils.h"
 
 #ifdef TOOLS_ENABLED
 #include "vector_graphics_editor_plugin.h"
@@ -25,6 +29,7 @@ static void editor_init_callback() {
 
 void register_gd_svg_mesh_types() {
 	ClassDB::register_class<VGPath>();
+	ClassDB::register_class<VGMorph>();
 	ClassDB::register_virtual_class<VGPaint>();
 	ClassDB::register_class<VGColor>();
 	ClassDB::register_class<VGGradient>();
@@ -32,8 +37,11 @@ void register_gd_svg_mesh_types() {
 	ClassDB::register_class<VGRadialGradient>();
 
 	ClassDB::register_virtual_class<VGRenderer>();
+	ClassDB::register_virtual_class<VGAbstractMeshRenderer>();
 	ClassDB::register_class<VGSpriteRenderer>();
+	ClassDB::register_class<VGSDFRenderer>();
 	ClassDB::register_class<VGMeshRenderer>();
+	ClassDB::register_class<VGRigidMeshRenderer>();
 
 	Ref<ResourceImporterSVGSpatial> svg_spatial_loader;
 	svg_spatial_loader.instance();
@@ -53,4 +61,8 @@ void register_gd_svg_mesh_types() {
 }
 
 void unregister_gd_svg_mesh_types() {
+	free_gradient_shaders();
+	free_sdf_shader();
+	free_sprite_materials();
+	finish_tesselation_pool();
 }
@@ -16,12 +16,9 @@
 // BSD-style license that can be found in the LICENSE.txt file.
 
 
-#ifdef __linux__
-// fixes a nasty compilation problem under Ubuntu.
-# undef __SSE3__
-#endif
-
+#include <cmath>
 #include <cstdint>
+#include <limits>
 #include <vector>
 #include <random>
 #include <algorithm>
@@ -45,7 +42,7 @@ class BlueNoise {
 		float * const data;
 		const int size;
 		
-		Matrix(int size) : size(size), data(new float[size * size]) {
+		Matrix(int size) : data(new float[size * size]), size(size) {
 		}
 
 		~Matrix() {
@@ -78,9 +75,9 @@ public:
 		return matrix->data;
 	}
 
-	BlueNoise(const int Sm = 128) : Sm(Sm) {
-		std::random_device rng;
-		std::mt19937 urng(rng());
+	// the same seed gives the same matrix on every run.
+	BlueNoise(const int Sm = 128, const unsigned int seed = 1) : Sm(Sm) {
+		std::mt19937 urng(seed);
 
 		const int Smk = Sm * Sm;
 		matrix = new Matrix(Sm);
@@ -62,9 +62,48 @@ void nsvgRasterize(NSVGrasterizer* r,
 				   NSVGimage* image, float tx, float ty, float scale,
 				   unsigned char* dst, int w, int h, int stride);
 
+// Flags for nsvgRasterizeFlags() and nsvgCreateRasterJob().
+enum NSVGrasterFlags {
+	// Keeps premultiplied alpha, i.e. skips unpremultiplying and defringing.
+	NSVG_RASTER_PREMULTIPLIED = 1,
+	// The caller already cleared dst wherever shapes can cover pixels.
+	NSVG_RASTER_NO_CLEAR = 2,
+	// dst has 1 byte per pixel and receives only the alpha that RGBA
+	// rasterization would give. Colors are ignored, gradients use the alpha
+	// of their first stop. Implies NSVG_RASTER_PREMULTIPLIED.
+	NSVG_RASTER_ALPHA = 4
+};
+
+// Same as nsvgRasterize(), with a combination of NSVGrasterFlags.
+void nsvgRasterizeFlags(NSVGrasterizer* r,
+				   NSVGimage* image, float tx, float ty, float scale,
+				   unsigned char* dst, int w, int h, int stride, int flags);
+
 // Deletes rasterizer context.
 void nsvgDeleteRasterizer(NSVGrasterizer*);
 
+// Banded rasterization. nsvgCreateRasterJob() flattens all shapes of the
+// image up front, after which horizontal bands of rows can be rasterized
+// independently, each with its own rasterizer context (e.g. one per thread).
+// Once all bands are done, nsvgDefringeBand() needs to run over all bands,
+// unless NSVG_RASTER_PREMULTIPLIED is given. The result is identical to
+// nsvgRasterizeFlags().
+typedef struct NSVGrasterJob NSVGrasterJob;
+
+NSVGrasterJob* nsvgCreateRasterJob(NSVGrasterizer* r,
+				   NSVGimage* image, float tx, float ty, float scale,
+				   unsigned char* dst, int w, int h, int stride, int flags);
+
+// Returns 0 if bands depend on each other (dithered gradients), in which
+// case the whole image needs to go through one nsvgRasterizeBand() call.
+int nsvgRasterJobIsBandable(NSVGrasterJob* job);
+
+// Rasterizes rows y0 to y1 (exclusive), using the given rasterizer context.
+void nsvgRasterizeBand(NSVGrasterizer* r, NSVGrasterJob* job, int y0, int y1);
+void nsvgDefringeBand(NSVGrasterJob* job, int y0, int y1);
+
+void nsvgDeleteRasterJob(NSVGrasterJob* job);
+
 
 #ifndef NANOSVGRAST_CPLUSPLUS
 #ifdef __cplusplus
@@ -79,6 +118,9 @@ void nsvgDeleteRasterizer(NSVGrasterizer*);
 #include <math.h>
 
 #define NSVG__SUBSAMPLES	5
+#define NSVG__EDGE_CACHE_SLOTS	4096	// power of two
+#define NSVG__EDGE_CACHE_MAX_EDGES	(1 << 18)
+#define NSVG__STROKE_BOUNDS_SLOTS	8192	// power of two
 #ifndef NSVG__FIXSHIFT
 #define NSVG__FIXSHIFT		10
 #endif
@@ -115,6 +157,21 @@ typedef struct NSVGmemPage {
 	struct NSVGmemPage* next;
 } NSVGmemPage;
 
+// flattened edges of one fill or stroke, before translation.
+typedef struct NSVGedgeCacheSlot {
+	unsigned long long key;
+	int edge;
+	int nedges;
+	float bounds[4];
+} NSVGedgeCacheSlot;
+
+// extents of the flattened edges of a stroke, kept for longer than the
+// edges so that strokes out of view need not be flattened again.
+typedef struct NSVGstrokeBoundsSlot {
+	unsigned long long key;
+	float bounds[4];
+} NSVGstrokeBoundsSlot;
+
 typedef struct NSVGcachedPaint {
 	char type;
 	char spread;
@@ -152,10 +209,39 @@ struct NSVGrasterizer
 	unsigned char* bitmap;
 	int width, height, stride;
 
+	// gradient colors: 0 plain, 1 error diffusion, 2 ordered dithering.
 	unsigned int quality;
+	int engine;
+	// vertical samples per pixel of TOVE_RASTERIZE_SUBSAMPLED, a divisor of
+	// 255 so that full coverage stays 255.
+	int subsamples;
+	// paints write NSVG_RASTER_ALPHA masks.
+	int alphaOnly;
+
+	// analytic engine: signed area per pixel, edges bucketed by row.
+	float* accum;
+	int caccum;
+	int* buckets;
+	int cbuckets;
+	int* order;
+	int* active;
+	int corder;
+
+	// edge cache: slots point into one edge arena that gets emptied when it
+	// is full.
+	NSVGedgeCacheSlot* cacheSlots;
+	NSVGedge* cacheEdges;
+	int ncacheEdges;
+	int ccacheEdges;
+	int edgeCacheHits;
+	int edgeCacheMisses;
+	// of the edges nsvg__flattenShapeCached() gave last.
+	float edgeBounds[4];
+	NSVGstrokeBoundsSlot* strokeBounds;
 
 	TOVEstencil stencil;
 	TOVEdither dither;
+	TOVEorderedDither ordered;
 };
 
 NSVGrasterizer* nsvgCreateRasterizer()
@@ -166,6 +252,7 @@ NSVGrasterizer* nsvgCreateRasterizer()
 
 	r->tessTol = 0.25f;
 	r->distTol = 0.01f;
+	r->subsamples = NSVG__SUBSAMPLES;
 
 	return r;
 
@@ -191,6 +278,13 @@ void nsvgDeleteRasterizer(NSVGrasterizer* r)
 	if (r->points) free(r->points);
 	if (r->points2) free(r->points2);
 	if (r->scanline) free(r->scanline);
+	if (r->accum) free(r->accum);
+	if (r->buckets) free(r->buckets);
+	if (r->order) free(r->order);
+	if (r->active) free(r->active);
+	if (r->cacheSlots) free(r->cacheSlots);
+	if (r->strokeBounds) free(r->strokeBounds);
+	if (r->cacheEdges) free(r->cacheEdges);
 
 	tove_deleteRasterizer(r);
 
@@ -844,8 +938,10 @@ static void nsvg__flattenShapeStroke(NSVGrasterizer* r, NSVGshape* shape, float
 				}
 			}
 			// Stroke any leftover path
-			if (r->npoints > 1 && dashState)
+			if (r->npoints > 1 && dashState) {
+				nsvg__prepareStroke(r, miterLimit, lineJoin);
 				nsvg__expandStroke(r, r->points, r->npoints, 0, lineJoin, lineCap, lineWidth);
+			}
 		} else {
 			nsvg__prepareStroke(r, miterLimit, lineJoin);
 			nsvg__expandStroke(r, r->points, r->npoints, closed, lineJoin, lineCap, lineWidth);
@@ -1004,16 +1100,16 @@ static void nsvg__rasterizeSortedEdges(
 	NSVGactiveEdge *active = NULL;
 	int y, s;
 	int e = 0;
-	int maxWeight = (255 / NSVG__SUBSAMPLES);  // weight per vertical scanline
+	int maxWeight = (255 / r->subsamples);  // weight per vertical scanline
 	int xmin, xmax;
 
 	for (y = 0; y < r->height; y++) {
 		memset(r->scanline, 0, r->width);
 		xmin = r->width;
 		xmax = 0;
-		for (s = 0; s < NSVG__SUBSAMPLES; ++s) {
+		for (s = 0; s < r->subsamples; ++s) {
 			// find center of pixel for this scanline
-			float scany = (float)(y*NSVG__SUBSAMPLES + s) + 0.5f;
+			float scany = (float)(y*r->subsamples + s) + 0.5f;
 			NSVGactiveEdge **step = &active;
 
 			// update all active edges;
@@ -1087,12 +1183,263 @@ static void nsvg__rasterizeSortedEdges(
 
 }
 
-static void nsvg__unpremultiplyAlpha(unsigned char* image, int w, int h, int stride)
+// Analytic coverage, as in font rasterizers (libart, font-rs): every edge
+// adds the signed area it covers to an accumulation buffer, and a running
+// sum over the row gives the exact coverage of each pixel. Rows only depend
+// on the edges, so edges are bucketed by their first row instead of sorted,
+// and bands can start anywhere.
+
+static int nsvg__reserveAnalytic(NSVGrasterizer* r, int w, int rows, int nedges)
+{
+	if (w + 2 > r->caccum) {
+		r->caccum = w + 2;
+		r->accum = (float*)realloc(r->accum, sizeof(float) * r->caccum);
+		if (r->accum == NULL) { r->caccum = 0; return 0; }
+		// rows leave the buffer zeroed behind them.
+		memset(r->accum, 0, sizeof(float) * r->caccum);
+	}
+	if (rows + 1 > r->cbuckets) {
+		r->cbuckets = rows + 1;
+		r->buckets = (int*)realloc(r->buckets, sizeof(int) * r->cbuckets);
+		if (r->buckets == NULL) { r->cbuckets = 0; return 0; }
+	}
+	if (nedges > r->corder) {
+		r->corder = nedges;
+		r->order = (int*)realloc(r->order, sizeof(int) * r->corder);
+		r->active = (int*)realloc(r->active, sizeof(int) * r->corder);
+		if (r->order == NULL || r->active == NULL) { r->corder = 0; return 0; }
+	}
+	return 1;
+}
+
+// area of a line piece within one row, with x inside [0, w]. d is the
+// signed height of the piece.
+static void nsvg__accumulateSpan(float* accum, float xa, float xb, float d)
+{
+	float x0 = xa < xb ? xa : xb;
+	float x1 = xa < xb ? xb : xa;
+	int x0i = (int)x0;
+	int x1i = (int)ceilf(x1);
+
+	if (x1i <= x0i + 1) {
+		float xmf = 0.5f * (xa + xb) - x0i;
+		accum[x0i] += d - d * xmf;
+		accum[x0i + 1] += d * xmf;
+	} else {
+		float s = 1.0f / (x1 - x0);
+		float x0f = x0 - x0i;
+		float a0 = 0.5f * s * (1.0f - x0f) * (1.0f - x0f);
+		float x1f = x1 - x1i + 1.0f;
+		float am = 0.5f * s * x1f * x1f;
+
+		accum[x0i] += d * a0;
+		if (x1i == x0i + 2) {
+			accum[x0i + 1] += d * (1.0f - a0 - am);
+		} else {
+			float a1 = s * (1.5f - x0f);
+			int xi;
+			accum[x0i + 1] += d * (a1 - a0);
+			for (xi = x0i + 2; xi < x1i - 1; xi++)
+				accum[xi] += d * s;
+			accum[x1i - 1] += d * (1.0f - (a1 + (x1i - x0i - 3) * s) - am);
+		}
+		accum[x1i] += d * am;
+	}
+}
+
+// clips a line piece within one row against [0, w]. parts left of the
+// image become vertical at x = 0, parts right of it do not matter.
+static void nsvg__accumulateEdge(float* accum, int w, float xa, float xb, float d, int* xmin, int* xmax)
+{
+	float t0 = 0.0f, t1 = 1.0f, left = 0.0f;
+	float dx = xb - xa;
+	float x0, x1;
+	int i;
+
+	if (dx == 0.0f) {
+		if (xa >= (float)w) return;
+		if (xa <= 0.0f) { left = 1.0f; t0 = t1; }
+	} else {
+		float tl = -xa / dx;
+		float tr = ((float)w - xa) / dx;
+		if (dx > 0.0f) {
+			if (tl > t0) { left = (tl < 1.0f ? tl : 1.0f); t0 = tl; }
+			if (tr < t1) t1 = tr;
+		} else {
+			if (tl < t1) { left = 1.0f - (tl > 0.0f ? tl : 0.0f); t1 = tl; }
+			if (tr > t0) t0 = tr;
+		}
+	}
+
+	if (left > 0.0f) {
+		accum[0] += d * left;
+		*xmin = 0;
+		if (*xmax < 0) *xmax = 0;
+	}
+	if (t1 <= t0) return;
+
+	x0 = nsvg__clampf(xa + dx * t0, 0.0f, (float)w);
+	x1 = nsvg__clampf(xa + dx * t1, 0.0f, (float)w);
+	nsvg__accumulateSpan(accum, x0, x1, d * (t1 - t0));
+
+	i = (int)(x0 < x1 ? x0 : x1);
+	if (i < *xmin) *xmin = i;
+	i = (int)ceilf(x0 < x1 ? x1 : x0) + 1;
+	if (i > *xmax) *xmax = i;
+}
+
+static inline unsigned char nsvg__analyticCoverage(float sum, char fillRule)
+{
+	float c = sum < 0.0f ? -sum : sum;
+	if (fillRule == NSVG_FILLRULE_EVENODD) {
+		// winding numbers fold into 0..1..0, odd counts are inside.
+		c = fmodf(c, 2.0f);
+		if (c > 1.0f) c = 2.0f - c;
+	} else if (c > 1.0f) {
+		c = 1.0f;
+	}
+	return (unsigned char)(c * 255.0f + 0.5f);
+}
+
+// running sum over accum[x0..x1), which it clears, into coverage bytes.
+// returns the sum at x1 - 1.
+static float nsvg__accumulateRow(NSVGrasterizer* r, int x0, int x1, char fillRule)
+{
+	float* accum = r->accum;
+	unsigned char* cover = r->scanline;
+	float sum = 0.0f;
+	int x = x0;
+
+#if TOVE_RASTER_SSE2
+	if (fillRule != NSVG_FILLRULE_EVENODD) {
+		// prefix sums four at a time, as in font-rs.
+		const __m128 sign = _mm_set1_ps(-0.0f);
+		const __m128 one = _mm_set1_ps(1.0f);
+		const __m128 full = _mm_set1_ps(255.0f);
+		const __m128 half = _mm_set1_ps(0.5f);
+		__m128 offset = _mm_setzero_ps();
+
+		for (; x + 4 <= x1; x += 4) {
+			__m128 v = _mm_loadu_ps(&accum[x]);
+			__m128i c;
+			int packed;
+
+			v = _mm_add_ps(v, _mm_castsi128_ps(_mm_slli_si128(_mm_castps_si128(v), 4)));
+			v = _mm_add_ps(v, _mm_castsi128_ps(_mm_slli_si128(_mm_castps_si128(v), 8)));
+			v = _mm_add_ps(v, offset);
+			offset = _mm_shuffle_ps(v, v, _MM_SHUFFLE(3, 3, 3, 3));
+			_mm_storeu_ps(&accum[x], _mm_setzero_ps());
+
+			v = _mm_min_ps(_mm_andnot_ps(sign, v), one);
+			c = _mm_cvttps_epi32(_mm_add_ps(_mm_mul_ps(v, full), half));
+			c = _mm_packs_epi32(c, c);
+			c = _mm_packus_epi16(c, c);
+			packed = _mm_cvtsi128_si32(c);
+			memcpy(&cover[x], &packed, 4);
+		}
+		sum = _mm_cvtss_f32(offset);
+	}
+#endif
+
+	for (; x < x1; x++) {
+		sum += accum[x];
+		accum[x] = 0.0f;
+		cover[x] = nsvg__analyticCoverage(sum, fillRule);
+	}
+	return sum;
+}
+
+// edges in pixel units, already translated, but not subsampled.
+static void nsvg__rasterizeAnalytic(
+	NSVGrasterizer* r, NSVGedge* edges, int nedges, int y0, int y1,
+	float tx, float ty, float scale,
+	NSVGcachedPaint* cache, char fillRule, TOVEclip* clip,
+	TOVEscanlineFunction scanline)
+{
+	const int w = r->width;
+	const int rows = y1 - y0;
+	int* buckets;
+	int* active;
+	int nactive = 0, total = 0;
+	int i, y;
+
+	if (rows <= 0 || !nsvg__reserveAnalytic(r, w, rows, nedges))
+		return;
+	buckets = r->buckets;
+	active = r->active;
+
+	// counting sort by first row.
+	memset(buckets, 0, sizeof(int) * (rows + 1));
+	for (i = 0; i < nedges; i++) {
+		const NSVGedge* e = &edges[i];
+		int row;
+		if (e->y1 <= (float)y0 || e->y0 >= (float)y1) continue;
+		row = (int)floorf(e->y0) - y0;
+		buckets[(row < 0 ? 0 : row) + 1]++;
+	}
+	for (i = 0; i < rows; i++)
+		buckets[i + 1] += buckets[i];
+	for (i = 0; i < nedges; i++) {
+		const NSVGedge* e = &edges[i];
+		int row;
+		if (e->y1 <= (float)y0 || e->y0 >= (float)y1) continue;
+		row = (int)floorf(e->y0) - y0;
+		r->order[buckets[row < 0 ? 0 : row]++] = i;
+		total++;
+	}
+	// buckets[k] now is where row k + 1 starts.
+
+	for (y = y0; y < y1; y++) {
+		const int k = y - y0;
+		int xmin = w + 1, xmax = -1, x, xend;
+		float sum;
+
+		for (i = (k == 0 ? 0 : buckets[k - 1]); i < buckets[k]; i++)
+			active[nactive++] = r->order[i];
+		if (nactive == 0) {
+			if (buckets[k] >= total) break;
+			continue;
+		}
+
+		for (i = 0; i < nactive; ) {
+			const NSVGedge* e = &edges[active[i]];
+			float ya = e->y0 > (float)y ? e->y0 : (float)y;
+			float yb = e->y1 < (float)(y + 1) ? e->y1 : (float)(y + 1);
+			if (yb > ya) {
+				float dxdy = (e->x1 - e->x0) / (e->y1 - e->y0);
+				nsvg__accumulateEdge(r->accum, w,
+					e->x0 + (ya - e->y0) * dxdy, e->x0 + (yb - e->y0) * dxdy,
+					(yb - ya) * e->dir, &xmin, &xmax);
+			}
+			if (e->y1 <= (float)(y + 1))
+				active[i] = active[--nactive];
+			else
+				i++;
+		}
+		if (xmax < xmin) continue;
+
+		if (xmax > w + 1) xmax = w + 1;
+		xend = xmax < w - 1 ? xmax : w - 1;
+		sum = xmin <= xend ? nsvg__accumulateRow(r, xmin, xend + 1, fillRule) : 0.0f;
+		for (x = xend + 1 > xmin ? xend + 1 : xmin; x <= xmax; x++)
+			r->accum[x] = 0.0f;
+		if (xmin > xend) continue;
+
+		// shapes that leave the image on the right cover the rest of the row.
+		if (xmax < w - 1 && nsvg__analyticCoverage(sum, fillRule) > 0) {
+			memset(&r->scanline[xmax + 1], nsvg__analyticCoverage(sum, fillRule), w - 1 - xmax);
+			xend = w - 1;
+		}
+
+		scanline(r, xmin, y, xend - xmin + 1, tx, ty, scale, cache, clip);
+	}
+}
+
+static void nsvg__unpremultiplyRows(unsigned char* image, int w, int y0, int y1, int stride)
 {
 	int x,y;
 
-	// Unpremultiply
-	for (y = 0; y < h; y++) {
+	for (y = y0; y < y1; y++) {
 		unsigned char *row = &image[y*stride];
 		for (x = 0; x < w; x++) {
 			int r = row[0], g = row[1], b = row[2], a = row[3];
@@ -1104,9 +1451,15 @@ static void nsvg__unpremultiplyAlpha(unsigned char* image, int w, int h, int str
 			row += 4;
 		}
 	}
+}
+
+// Only writes pixels with zero alpha and only reads pixels with non-zero
+// alpha, so rows may be processed in any order once all are unpremultiplied.
+static void nsvg__defringeRows(unsigned char* image, int w, int h, int y0, int y1, int stride)
+{
+	int x,y;
 
-	// Defringe
-	for (y = 0; y < h; y++) {
+	for (y = y0; y < y1; y++) {
 		unsigned char *row = &image[y*stride];
 		for (x = 0; x < w; x++) {
 			int r = 0, g = 0, b = 0, a = row[3], n = 0;
@@ -1146,6 +1499,12 @@ static void nsvg__unpremultiplyAlpha(unsigned char* image, int w, int h, int str
 	}
 }
 
+static void nsvg__unpremultiplyAlpha(unsigned char* image, int w, int h, int stride)
+{
+	nsvg__unpremultiplyRows(image, w, 0, h, stride);
+	nsvg__defringeRows(image, w, h, 0, h, stride);
+}
+
 
 static TOVEscanlineFunction nsvg__initPaint(NSVGcachedPaint* cache, NSVGpaint* paint, float opacity,
 	NSVGrasterizer* r, TOVEscanlineFunction scanline)
@@ -1160,6 +1519,13 @@ static TOVEscanlineFunction nsvg__initPaint(NSVGcachedPaint* cache, NSVGpaint* p
 
 	cache->type = paint->type;
 
+	if (r->alphaOnly) {
+		cache->colors[0] = nsvg__applyOpacity(paint->type == NSVG_PAINT_COLOR ?
+			paint->color : paint->gradient->nstops > 0 ?
+			paint->gradient->stops[0].color : 0, opacity);
+		return tove__drawAlphaScanline;
+	}
+
 	if (paint->type == NSVG_PAINT_COLOR) {
 		cache->colors[0] = nsvg__applyOpacity(paint->color, opacity);
 		return tove__drawColorScanline;
@@ -1261,6 +1627,215 @@ static void dumpEdges(NSVGrasterizer* r, const char* name)
 }
 */
 
+// Edge cache. Flattening and stroke expansion only depend on the geometry,
+// the stroke style, the scale and the tolerances, not on the paint or the
+// offset, so shapes that are rasterized again with other colors or into
+// another tile reuse their edges. Sorting before translating gives the same
+// order, since translation keeps edges monotonic in y. The analytic engine
+// buckets edges by row itself and gets them unsorted.
+
+static inline unsigned long long nsvg__hashWord(unsigned long long h, unsigned int v)
+{
+	return (h ^ v) * 0x100000001b3ULL;
+}
+
+static inline unsigned long long nsvg__hashFloat(unsigned long long h, float v)
+{
+	unsigned int bits;
+	memcpy(&bits, &v, sizeof(bits));
+	return nsvg__hashWord(h, bits);
+}
+
+static unsigned long long nsvg__shapeEdgeKey(NSVGrasterizer* r, NSVGshape* shape, float scale, int stroke)
+{
+	unsigned long long h = 0xcbf29ce484222325ULL;
+	NSVGpath* path;
+	int i;
+
+	h = nsvg__hashWord(h, stroke);
+	h = nsvg__hashWord(h, r->engine == TOVE_RASTERIZE_ANALYTIC);
+	h = nsvg__hashFloat(h, scale);
+	h = nsvg__hashFloat(h, r->tessTol);
+	h = nsvg__hashFloat(h, r->distTol);
+
+	if (stroke) {
+		h = nsvg__hashFloat(h, shape->strokeWidth);
+		h = nsvg__hashFloat(h, shape->miterLimit);
+		h = nsvg__hashWord(h, shape->strokeLineJoin);
+		h = nsvg__hashWord(h, shape->strokeLineCap);
+		h = nsvg__hashWord(h, shape->strokeDashCount);
+		for (i = 0; i < shape->strokeDashCount; i++)
+			h = nsvg__hashFloat(h, shape->strokeDashArray[i]);
+		h = nsvg__hashFloat(h, shape->strokeDashOffset);
+	}
+
+	for (path = shape->paths; path != NULL; path = path->next) {
+		h = nsvg__hashWord(h, path->npts);
+		h = nsvg__hashWord(h, path->closed);
+		for (i = 0; i < path->npts * 2; i++)
+			h = nsvg__hashFloat(h, path->pts[i]);
+	}
+
+	// low bits pick the slot, but floats with short mantissas leave them
+	// all but unmixed.
+	h ^= h >> 33;
+	h *= 0xff51afd7ed558ccdULL;
+	h ^= h >> 33;
+
+	// 0 marks empty slots.
+	return h != 0 ? h : 1;
+}
+
+// same as nsvg__flattenShape() or nsvg__flattenShapeStroke(), followed by
+// sorting the edges for the subsampled engine.
+static void nsvg__flattenShapeCached(NSVGrasterizer* r, NSVGshape* shape, float scale, int stroke)
+{
+	unsigned long long key;
+	NSVGedgeCacheSlot* slot;
+	NSVGedge* edges;
+	int n;
+
+	if (r->cacheSlots == NULL) {
+		r->cacheSlots = (NSVGedgeCacheSlot*)malloc(sizeof(NSVGedgeCacheSlot) * NSVG__EDGE_CACHE_SLOTS);
+		if (r->cacheSlots != NULL)
+			memset(r->cacheSlots, 0, sizeof(NSVGedgeCacheSlot) * NSVG__EDGE_CACHE_SLOTS);
+	}
+
+	key = nsvg__shapeEdgeKey(r, shape, scale, stroke);
+	slot = NULL;
+	if (r->cacheSlots != NULL) {
+		// two ways per set, a full set gives up its first way.
+		slot = &r->cacheSlots[key & (NSVG__EDGE_CACHE_SLOTS - 2)];
+		if (slot->key != key && slot->key != 0 && (slot[1].key == key || slot[1].key == 0))
+			slot++;
+	}
+
+	if (slot != NULL && slot->key == key) {
+		if (slot->nedges > r->cedges) {
+			r->cedges = slot->nedges;
+			r->edges = (NSVGedge*)realloc(r->edges, sizeof(NSVGedge) * r->cedges);
+			if (r->edges == NULL) { r->cedges = 0; r->nedges = 0; return; }
+		}
+		memcpy(r->edges, &r->cacheEdges[slot->edge], sizeof(NSVGedge) * slot->nedges);
+		r->nedges = slot->nedges;
+		memcpy(r->edgeBounds, slot->bounds, sizeof(r->edgeBounds));
+		r->edgeCacheHits++;
+		return;
+	}
+
+	if (stroke)
+		nsvg__flattenShapeStroke(r, shape, scale);
+	else
+		nsvg__flattenShape(r, shape, scale);
+	if (r->engine != TOVE_RASTERIZE_ANALYTIC)
+		qsort(r->edges, r->nedges, sizeof(NSVGedge), nsvg__cmpEdge);
+	r->edgeCacheMisses++;
+
+	// edges are stored with y0 <= y1.
+	r->edgeBounds[0] = r->edgeBounds[1] = 1e30f;
+	r->edgeBounds[2] = r->edgeBounds[3] = -1e30f;
+	for (n = 0; n < r->nedges; n++) {
+		const NSVGedge* e = &r->edges[n];
+		r->edgeBounds[0] = nsvg__minf(r->edgeBounds[0], nsvg__minf(e->x0, e->x1));
+		r->edgeBounds[1] = nsvg__minf(r->edgeBounds[1], e->y0);
+		r->edgeBounds[2] = nsvg__maxf(r->edgeBounds[2], nsvg__maxf(e->x0, e->x1));
+		r->edgeBounds[3] = nsvg__maxf(r->edgeBounds[3], e->y1);
+	}
+
+	if (stroke && r->strokeBounds != NULL) {
+		NSVGstrokeBoundsSlot* b = &r->strokeBounds[key & (NSVG__STROKE_BOUNDS_SLOTS - 1)];
+		b->key = key;
+		memcpy(b->bounds, r->edgeBounds, sizeof(b->bounds));
+	}
+
+	if (slot == NULL || r->nedges > NSVG__EDGE_CACHE_MAX_EDGES / 4)
+		return;
+
+	if (r->ncacheEdges + r->nedges > NSVG__EDGE_CACHE_MAX_EDGES) {
+		// start over rather than keep track of which edges are still in use.
+		memset(r->cacheSlots, 0, sizeof(NSVGedgeCacheSlot) * NSVG__EDGE_CACHE_SLOTS);
+		r->ncacheEdges = 0;
+	}
+	if (r->ncacheEdges + r->nedges > r->ccacheEdges) {
+		n = r->ccacheEdges > 0 ? r->ccacheEdges * 2 : 1024;
+		while (n < r->ncacheEdges + r->nedges) n *= 2;
+		if (n > NSVG__EDGE_CACHE_MAX_EDGES) n = NSVG__EDGE_CACHE_MAX_EDGES;
+		edges = (NSVGedge*)realloc(r->cacheEdges, sizeof(NSVGedge) * n);
+		if (edges == NULL) return;
+		r->cacheEdges = edges;
+		r->ccacheEdges = n;
+	}
+
+	memcpy(&r->cacheEdges[r->ncacheEdges], r->edges, sizeof(NSVGedge) * r->nedges);
+	slot->key = key;
+	slot->edge = r->ncacheEdges;
+	slot->nedges = r->nedges;
+	memcpy(slot->bounds, r->edgeBounds, sizeof(slot->bounds));
+	r->ncacheEdges += r->nedges;
+}
+
+// puts the extents of the stroke's flattened edges into r->edgeBounds, if
+// they are known without flattening.
+static int nsvg__strokeBoundsCached(NSVGrasterizer* r, NSVGshape* shape, float scale)
+{
+	unsigned long long key;
+	NSVGstrokeBoundsSlot* b;
+
+	if (r->strokeBounds == NULL) {
+		r->strokeBounds = (NSVGstrokeBoundsSlot*)malloc(sizeof(NSVGstrokeBoundsSlot) * NSVG__STROKE_BOUNDS_SLOTS);
+		if (r->strokeBounds == NULL)
+			return 0;
+		memset(r->strokeBounds, 0, sizeof(NSVGstrokeBoundsSlot) * NSVG__STROKE_BOUNDS_SLOTS);
+	}
+
+	key = nsvg__shapeEdgeKey(r, shape, scale, 1);
+	b = &r->strokeBounds[key & (NSVG__STROKE_BOUNDS_SLOTS - 1)];
+	if (b->key != key)
+		return 0;
+	memcpy(r->edgeBounds, b->bounds, sizeof(r->edgeBounds));
+	return 1;
+}
+
+static void nsvg__rasterizeEdges(
+	NSVGrasterizer* r, float tx, float ty, float scale,
+	NSVGcachedPaint* cache, char fillRule, TOVEclip* clip,
+	TOVEscanlineFunction scanline)
+{
+	const float ysub = r->engine == TOVE_RASTERIZE_ANALYTIC ? 1.0f : (float)r->subsamples;
+	NSVGedge *e = NULL;
+	int i;
+
+	// Scale and translate edges
+	for (i = 0; i < r->nedges; i++) {
+		e = &r->edges[i];
+		e->x0 = tx + e->x0;
+		e->y0 = (ty + e->y0) * ysub;
+		e->x1 = tx + e->x1;
+		e->y1 = (ty + e->y1) * ysub;
+	}
+
+	if (r->engine == TOVE_RASTERIZE_ANALYTIC) {
+		nsvg__rasterizeAnalytic(r, r->edges, r->nedges, 0, r->height,
+			tx, ty, scale, cache, fillRule, clip, scanline);
+		return;
+	}
+
+	// edges come sorted from nsvg__flattenShapeCached().
+	// now, traverse the scanlines and find the intersections on each scanline, use non-zero rule
+	nsvg__rasterizeSortedEdges(r, tx,ty,scale, cache, fillRule, clip, scanline);
+}
+
+// Whether anything inside bounds can touch the w x h pixels. Fills stay
+// inside the shape's bounds. Strokes need the bounds of their edges, since
+// inner miter joins are not limited and can reach far out.
+static int nsvg__boundsInView(const float* bounds, float scale, float tx, float ty, int w, int h)
+{
+	return bounds[0] * scale + tx < (float)(w + 1) &&
+		bounds[1] * scale + ty < (float)(h + 1) &&
+		bounds[2] * scale + tx > -1.0f &&
+		bounds[3] * scale + ty > -1.0f;
+}
+
 static void nsvg__rasterizeShapes(
 	NSVGrasterizer* r,
 	NSVGshape* shapes, float tx, float ty, float scale,
@@ -1268,10 +1843,8 @@ static void nsvg__rasterizeShapes(
 	TOVEscanlineFunction scanline)
 {
 	NSVGshape *shape = NULL;
-	NSVGedge *e = NULL;
 	NSVGcachedPaint cache;
 	TOVEscanlineFunction scanline2;
-	int i;
 
 	r->bitmap = dst;
 	r->width = w;
@@ -1288,55 +1861,34 @@ static void nsvg__rasterizeShapes(
 		if (!(shape->flags & NSVG_FLAGS_VISIBLE))
 			continue;
 
-		if (shape->fill.type != NSVG_PAINT_NONE) {
+		if (shape->fill.type != NSVG_PAINT_NONE && nsvg__boundsInView(shape->bounds, scale, tx, ty, w, h)) {
 			nsvg__resetPool(r);
 			r->freelist = NULL;
 			r->nedges = 0;
 
-			nsvg__flattenShape(r, shape, scale);
-
-			// Scale and translate edges
-			for (i = 0; i < r->nedges; i++) {
-				e = &r->edges[i];
-				e->x0 = tx + e->x0;
-				e->y0 = (ty + e->y0) * NSVG__SUBSAMPLES;
-				e->x1 = tx + e->x1;
-				e->y1 = (ty + e->y1) * NSVG__SUBSAMPLES;
-			}
-
-			// Rasterize edges
-			qsort(r->edges, r->nedges, sizeof(NSVGedge), nsvg__cmpEdge);
+			nsvg__flattenShapeCached(r, shape, scale, 0);
 
-			// now, traverse the scanlines and find the intersections on each scanline, use non-zero rule
 			scanline2 = nsvg__initPaint(&cache, &shape->fill, shape->opacity, r, scanline);
 
-			nsvg__rasterizeSortedEdges(r, tx,ty,scale, &cache, shape->fillRule, &shape->clip, scanline2);
+			nsvg__rasterizeEdges(r, tx,ty,scale, &cache, shape->fillRule, &shape->clip, scanline2);
 		}
 		if (shape->stroke.type != NSVG_PAINT_NONE && (shape->strokeWidth * scale) > 0.01f) {
+			if (nsvg__strokeBoundsCached(r, shape, scale) && !nsvg__boundsInView(r->edgeBounds, 1.0f, tx, ty, w, h))
+				continue;
+
 			nsvg__resetPool(r);
 			r->freelist = NULL;
 			r->nedges = 0;
 
-			nsvg__flattenShapeStroke(r, shape, scale);
+			nsvg__flattenShapeCached(r, shape, scale, 1);
+			if (!nsvg__boundsInView(r->edgeBounds, 1.0f, tx, ty, w, h))
+				continue;
 
 //			dumpEdges(r, "edge.svg");
 
-			// Scale and translate edges
-			for (i = 0; i < r->nedges; i++) {
-				e = &r->edges[i];
-				e->x0 = tx + e->x0;
-				e->y0 = (ty + e->y0) * NSVG__SUBSAMPLES;
-				e->x1 = tx + e->x1;
-				e->y1 = (ty + e->y1) * NSVG__SUBSAMPLES;
-			}
-
-			// Rasterize edges
-			qsort(r->edges, r->nedges, sizeof(NSVGedge), nsvg__cmpEdge);
-
-			// now, traverse the scanlines and find the intersections on each scanline, use non-zero rule
 			scanline2 = nsvg__initPaint(&cache, &shape->stroke, shape->opacity, r, scanline);
 
-			nsvg__rasterizeSortedEdges(r, tx,ty,scale, &cache, NSVG_FILLRULE_NONZERO, &shape->clip, scanline2);
+			nsvg__rasterizeEdges(r, tx,ty,scale, &cache, NSVG_FILLRULE_NONZERO, &shape->clip, scanline2);
 		}
 	}
 
@@ -1346,26 +1898,447 @@ static void nsvg__rasterizeShapes(
 	r->stride = 0;
 }
 
-void nsvgRasterize(
+void nsvgRasterizeFlags(
 	NSVGrasterizer* r,
 	NSVGimage* image, float tx, float ty, float scale,
-	unsigned char* dst, int w, int h, int stride)
+	unsigned char* dst, int w, int h, int stride, int flags)
 {
 	int i;
 
-	for (i = 0; i < h; i++)
-		memset(&dst[i*stride], 0, w*4);
+	if (!(flags & NSVG_RASTER_NO_CLEAR)) {
+		for (i = 0; i < h; i++)
+			memset(&dst[i*stride], 0, (flags & NSVG_RASTER_ALPHA) ? w : w*4);
+	}
 
 	if (!tove__rasterize(r, image, w, h, tx, ty, scale)) {
 		return;
 	}
 
+	r->alphaOnly = (flags & NSVG_RASTER_ALPHA) != 0;
 	nsvg__rasterizeShapes(r, image->shapes, tx, ty, scale,
 		dst, w, h, stride,  NULL);
+	r->alphaOnly = 0;
 
-	nsvg__unpremultiplyAlpha(dst, w, h, stride);
+	if (!(flags & (NSVG_RASTER_PREMULTIPLIED | NSVG_RASTER_ALPHA))) {
+		nsvg__unpremultiplyAlpha(dst, w, h, stride);
+	}
+}
+
+void nsvgRasterize(
+	NSVGrasterizer* r,
+	NSVGimage* image, float tx, float ty, float scale,
+	unsigned char* dst, int w, int h, int stride)
+{
+	nsvgRasterizeFlags(r, image, tx, ty, scale, dst, w, h, stride, 0);
 }
 
 #include "../tove/svgrast.cpp"
 
+// One fill or stroke of one shape, flattened, translated and sorted.
+typedef struct NSVGrasterPass {
+	int edge;
+	int nedges;
+	float miny, maxy;
+	char fillRule;
+	TOVEclip* clip;
+	int cache;
+	int stencil;
+	TOVEscanlineFunction scanline;
+} NSVGrasterPass;
+
+struct NSVGrasterJob {
+	float tx, ty, scale;
+	unsigned char* dst;
+	int width, height, stride;
+	int flags;
+	int bandable;
+	int engine;
+	int subsamples;
+
+	NSVGedge* edges;
+	int nedges;
+	int cedges;
+
+	NSVGrasterPass* passes;
+	int npasses;
+	int cpasses;
+
+	NSVGcachedPaint* caches;
+	int ncaches;
+	int ccaches;
+
+	TOVEstencil stencil;
+	int nstencils;
+};
+
+static int nsvg__addRasterPass(NSVGrasterJob* job, NSVGrasterizer* r,
+	NSVGshape* shape, NSVGpaint* paint, char fillRule, int stencil)
+{
+	const float ysub = job->engine == TOVE_RASTERIZE_ANALYTIC ? 1.0f : (float)job->subsamples;
+	NSVGrasterPass* pass;
+	NSVGedge* e;
+	int i;
+
+	if (r->nedges == 0)
+		return 1;
+
+	// Scale and translate edges
+	for (i = 0; i < r->nedges; i++) {
+		e = &r->edges[i];
+		e->x0 = job->tx + e->x0;
+		e->y0 = (job->ty + e->y0) * ysub;
+		e->x1 = job->tx + e->x1;
+		e->y1 = (job->ty + e->y1) * ysub;
+	}
+
+	// edges come from nsvg__flattenShapeCached(), just as in
+	// nsvg__rasterizeShapes(), so equal edges end up in the same order.
+
+	if (job->nedges + r->nedges > job->cedges) {
+		job->cedges = job->nedges + r->nedges > job->cedges * 2 ? job->nedges + r->nedges : job->cedges * 2;
+		job->edges = (NSVGedge*)realloc(job->edges, sizeof(NSVGedge) * job->cedges);
+		if (job->edges == NULL) return 0;
+	}
+	if (job->npasses + 1 > job->cpasses) {
+		job->cpasses = job->cpasses > 0 ? job->cpasses * 2 : 16;
+		job->passes = (NSVGrasterPass*)realloc(job->passes, sizeof(NSVGrasterPass) * job->cpasses);
+		if (job->passes == NULL) return 0;
+	}
+
+	pass = &job->passes[job->npasses++];
+	pass->edge = job->nedges;
+	pass->nedges = r->nedges;
+	pass->miny = r->edges[0].y0;
+	pass->maxy = r->edges[0].y1;
+	for (i = 0; i < r->nedges; i++) {
+		if (r->edges[i].y0 < pass->miny) pass->miny = r->edges[i].y0;
+		if (r->edges[i].y1 > pass->maxy) pass->maxy = r->edges[i].y1;
+	}
+	pass->fillRule = fillRule;
+	pass->clip = &shape->clip;
+	pass->stencil = stencil;
+	memcpy(&job->edges[job->nedges], r->edges, sizeof(NSVGedge) * r->nedges);
+	job->nedges += r->nedges;
+
+	if (stencil >= 0) {
+		pass->cache = -1;
+		pass->scanline = tove__scanlineBit;
+	} else {
+		if (job->ncaches + 1 > job->ccaches) {
+			job->ccaches = job->ccaches > 0 ? job->ccaches * 2 : 16;
+			job->caches = (NSVGcachedPaint*)realloc(job->caches, sizeof(NSVGcachedPaint) * job->ccaches);
+			if (job->caches == NULL) return 0;
+		}
+		pass->cache = job->ncaches++;
+		pass->scanline = nsvg__initPaint(&job->caches[pass->cache], paint, shape->opacity, r, NULL);
+		if (paint->type != NSVG_PAINT_COLOR && !r->alphaOnly && BestGradientColors::enabled(r)) {
+			// error diffusion carries over from row to row.
+			job->bandable = 0;
+		}
+	}
+
+	return 1;
+}
+
+static int nsvg__addRasterPasses(NSVGrasterJob* job, NSVGrasterizer* r, NSVGshape* shapes, int stencil)
+{
+	NSVGshape *shape;
+
+	for (shape = shapes; shape != NULL; shape = shape->next) {
+		if (!(shape->flags & NSVG_FLAGS_VISIBLE))
+			continue;
+
+		if (shape->fill.type != NSVG_PAINT_NONE &&
+			nsvg__boundsInView(shape->bounds, job->scale, job->tx, job->ty, job->width, job->height)) {
+			nsvg__resetPool(r);
+			r->freelist = NULL;
+			r->nedges = 0;
+
+			nsvg__flattenShapeCached(r, shape, job->scale, 0);
+
+			if (!nsvg__addRasterPass(job, r, shape, &shape->fill, shape->fillRule, stencil))
+				return 0;
+		}
+		if (shape->stroke.type != NSVG_PAINT_NONE && (shape->strokeWidth * job->scale) > 0.01f) {
+			if (nsvg__strokeBoundsCached(r, shape, job->scale) && !nsvg__boundsInView(r->edgeBounds, 1.0f, job->tx, job->ty, job->width, job->height))
+				continue;
+
+			nsvg__resetPool(r);
+			r->freelist = NULL;
+			r->nedges = 0;
+
+			nsvg__flattenShapeCached(r, shape, job->scale, 1);
+			if (!nsvg__boundsInView(r->edgeBounds, 1.0f, job->tx, job->ty, job->width, job->height))
+				continue;
+
+			if (!nsvg__addRasterPass(job, r, shape, &shape->stroke, NSVG_FILLRULE_NONZERO, stencil))
+				return 0;
+		}
+	}
+
+	return 1;
+}
+
+NSVGrasterJob* nsvgCreateRasterJob(NSVGrasterizer* r,
+	NSVGimage* image, float tx, float ty, float scale,
+	unsigned char* dst, int w, int h, int stride, int flags)
+{
+	NSVGrasterJob* job;
+	TOVEclipPath* clipPath;
+
+	job = (NSVGrasterJob*)malloc(sizeof(NSVGrasterJob));
+	if (job == NULL) return NULL;
+	memset(job, 0, sizeof(NSVGrasterJob));
+
+	job->tx = tx;
+	job->ty = ty;
+	job->scale = scale;
+	job->dst = dst;
+	job->width = w;
+	job->height = h;
+	job->stride = stride;
+	job->flags = flags;
+	job->bandable = 1;
+	job->engine = r->engine;
+	job->subsamples = r->subsamples;
+
+	for (clipPath = image->clipPaths; clipPath != NULL; clipPath = clipPath->next)
+		job->nstencils++;
+
+	if (job->nstencils > 0) {
+		// bands clear their own rows.
+		job->stencil.stride = w / 8 + (w % 8 != 0 ? 1 : 0);
+		job->stencil.size = h * job->stencil.stride;
+		job->stencil.data = (unsigned char*)malloc(job->stencil.size * job->nstencils);
+		if (job->stencil.data == NULL) goto error;
+	}
+
+	for (clipPath = image->clipPaths; clipPath != NULL; clipPath = clipPath->next) {
+		if (!nsvg__addRasterPasses(job, r, clipPath->shapes, clipPath->index))
+			goto error;
+	}
+
+	r->alphaOnly = (flags & NSVG_RASTER_ALPHA) != 0;
+	if (!nsvg__addRasterPasses(job, r, image->shapes, -1)) {
+		r->alphaOnly = 0;
+		goto error;
+	}
+	r->alphaOnly = 0;
+
+	return job;
+
+error:
+	nsvgDeleteRasterJob(job);
+	return NULL;
+}
+
+int nsvgRasterJobIsBandable(NSVGrasterJob* job)
+{
+	return job->bandable;
+}
+
+// Same as nsvg__rasterizeSortedEdges(), but rows above y0 only advance the
+// active edge list. Fixed point positions accumulate rounding from the row
+// an edge became active on, so starting fresh at y0 would not give the same
+// coverage.
+static void nsvg__rasterizePassBand(NSVGrasterizer* r, NSVGrasterJob* job,
+	NSVGrasterPass* pass, int y0, int y1)
+{
+	NSVGactiveEdge *active = NULL;
+	NSVGedge* edges = &job->edges[pass->edge];
+	NSVGcachedPaint* cache = pass->cache >= 0 ? &job->caches[pass->cache] : NULL;
+	int nedges = pass->nedges;
+	int y, s, ystart;
+	int e = 0;
+	int maxWeight = (255 / job->subsamples);  // weight per vertical scanline
+	int xmin = 0, xmax = 0;
+	int draw;
+
+	if (job->engine == TOVE_RASTERIZE_ANALYTIC) {
+		// rows do not depend on the ones above them.
+		nsvg__rasterizeAnalytic(r, edges, nedges, y0, y1,
+			job->tx, job->ty, job->scale, cache, pass->fillRule, pass->clip, pass->scanline);
+		return;
+	}
+
+	nsvg__resetPool(r);
+	r->freelist = NULL;
+
+	// rows above the first edge have nothing to do.
+	ystart = (int)floorf(edges[0].y0 / job->subsamples) - 1;
+	if (ystart < 0) ystart = 0;
+
+	for (y = ystart; y < y1; y++) {
+		draw = y >= y0;
+		if (draw) {
+			memset(r->scanline, 0, r->width);
+			xmin = r->width;
+			xmax = 0;
+		}
+		for (s = 0; s < job->subsamples; ++s) {
+			// find center of pixel for this scanline
+			float scany = (float)(y*job->subsamples + s) + 0.5f;
+			NSVGactiveEdge **step = &active;
+
+			// update all active edges;
+			// remove all active edges that terminate before the center of this scanline
+			while (*step) {
+				NSVGactiveEdge *z = *step;
+				if (z->ey <= scany) {
+					*step = z->next; // delete from list
+					nsvg__freeActive(r, z);
+				} else {
+					z->x += z->dx; // advance to position for current scanline
+					step = &((*step)->next); // advance through list
+				}
+			}
+
+			// resort the list if needed
+			for (;;) {
+				int changed = 0;
+				step = &active;
+				while (*step && (*step)->next) {
+					if ((*step)->x > (*step)->next->x) {
+						NSVGactiveEdge* t = *step;
+						NSVGactiveEdge* q = t->next;
+						t->next = q->next;
+						q->next = t;
+						*step = q;
+						changed = 1;
+					}
+					step = &(*step)->next;
+				}
+				if (!changed) break;
+			}
+
+			// insert all edges that start before the center of this scanline -- omit ones that also end on this scanline
+			while (e < nedges && edges[e].y0 <= scany) {
+				if (edges[e].y1 > scany) {
+					NSVGactiveEdge* z = nsvg__addActive(r, &edges[e], scany);
+					if (z == NULL) break;
+					// find insertion point
+					if (active == NULL) {
+						active = z;
+					} else if (z->x < active->x) {
+						// insert at front
+						z->next = active;
+						active = z;
+					} else {
+						// find thing to insert AFTER
+						NSVGactiveEdge* p = active;
+						while (p->next && p->next->x < z->x)
+							p = p->next;
+						// at this point, p->next->x is NOT < z->x
+						z->next = p->next;
+						p->next = z;
+					}
+				}
+				e++;
+			}
+
+			// now process all active edges in non-zero fashion
+			if (draw && active != NULL)
+				nsvg__fillActiveEdges(r->scanline, r->width, active, maxWeight, &xmin, &xmax, pass->fillRule);
+		}
+		// Blit
+		if (draw) {
+			if (xmin < 0) xmin = 0;
+			if (xmax > r->width-1) xmax = r->width-1;
+			if (xmin <= xmax) {
+				pass->scanline(r, xmin, y, xmax-xmin+1, job->tx, job->ty, job->scale, cache, pass->clip);
+			}
+		}
+		if (e >= nedges && active == NULL)
+			break;
+	}
+}
+
+void nsvgRasterizeBand(NSVGrasterizer* r, NSVGrasterJob* job, int y0, int y1)
+{
+	TOVEstencil stencil;
+	int i, y;
+
+	if (y0 < 0) y0 = 0;
+	if (y1 > job->height) y1 = job->height;
+	if (y0 >= y1) return;
+
+	if (job->width > r->cscanline) {
+		r->cscanline = job->width;
+		r->scanline = (unsigned char*)realloc(r->scanline, job->width);
+		if (r->scanline == NULL) return;
+	}
+	if (!BestGradientColors::allocate(r, job->width)) {
+		return;
+	}
+
+	if (!(job->flags & NSVG_RASTER_NO_CLEAR)) {
+		for (y = y0; y < y1; y++)
+			memset(&job->dst[y*job->stride], 0,
+				(job->flags & NSVG_RASTER_ALPHA) ? job->width : job->width*4);
+	}
+	for (i = 0; i < job->nstencils; i++)
+		memset(&job->stencil.data[job->stencil.size * i + y0 * job->stencil.stride], 0, (y1 - y0) * job->stencil.stride);
+
+	// clip masks are shared by all bands, each band writes its own rows.
+	stencil = r->stencil;
+	r->stencil = job->stencil;
+	r->width = job->width;
+	r->height = job->height;
+
+	for (i = 0; i < job->npasses; i++) {
+		NSVGrasterPass* pass = &job->passes[i];
+
+		// skip passes that are done before this band or start after it.
+		if (job->engine == TOVE_RASTERIZE_ANALYTIC) {
+			if (pass->maxy <= (float)y0 || pass->miny >= (float)y1)
+				continue;
+		} else {
+			if (pass->maxy <= (float)(y0 * job->subsamples) + 0.5f)
+				continue;
+			if (pass->miny > (float)(y1 * job->subsamples))
+				continue;
+		}
+
+		if (pass->stencil >= 0) {
+			r->bitmap = &job->stencil.data[job->stencil.size * pass->stencil];
+			r->stride = job->stencil.stride;
+		} else {
+			r->bitmap = job->dst;
+			r->stride = job->stride;
+		}
+
+		nsvg__rasterizePassBand(r, job, pass, y0, y1);
+	}
+
+	r->stencil = stencil;
+	r->bitmap = NULL;
+	r->width = 0;
+	r->height = 0;
+	r->stride = 0;
+
+	if (!(job->flags & (NSVG_RASTER_PREMULTIPLIED | NSVG_RASTER_ALPHA)))
+		nsvg__unpremultiplyRows(job->dst, job->width, y0, y1, job->stride);
+}
+
+void nsvgDefringeBand(NSVGrasterJob* job, int y0, int y1)
+{
+	if (job->flags & (NSVG_RASTER_PREMULTIPLIED | NSVG_RASTER_ALPHA)) return;
+	if (y0 < 0) y0 = 0;
+	if (y1 > job->height) y1 = job->height;
+
+	nsvg__defringeRows(job->dst, job->width, job->height, y0, y1, job->stride);
+}
+
+void nsvgDeleteRasterJob(NSVGrasterJob* job)
+{
+	if (job == NULL) return;
+
+	if (job->edges) free(job->edges);
+	if (job->passes) free(job->passes);
+	if (job->caches) free(job->caches);
+	if (job->stencil.data) free(job->stencil.data);
+
+	free(job);
+}
+
 #endif
@@ -0,0 +1,44 @@
+/*
+ * TÖVE - Animated vector graphics for LÖVE.
+ * https://github.com/poke1024/Tove
+ *
+ * Copyright (c) 2019, Bernhard Liebl
+ *
+ * Distributed under the MIT license. See LICENSE file for details.
+ *
+ * All rights reserved.
+ */
+
+#ifndef __TOVE_SVGRAST_SIMD
+#define __TOVE_SVGRAST_SIMD 1
+
+// span kernels in svgrast.cpp. define TOVE_RASTER_SIMD to 0 to get the
+// scalar reference implementation everywhere, or TOVE_RASTER_TEST to pick
+// the kernels at runtime through tove__rasterSIMDLimit. this header needs
+// to be included outside of any namespace, svgrast.cpp itself is not.
+
+#ifndef TOVE_RASTER_SIMD
+#define TOVE_RASTER_SIMD 1
+#endif
+
+#if TOVE_RASTER_SIMD && (defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2))
+#define TOVE_RASTER_SSE2 1
+#include <emmintrin.h>
+
+// AVX2 is picked at runtime, so it needs per function target attributes.
+#if !defined(TOVE_RASTER_AVX2) && (defined(__GNUC__) || defined(__clang__))
+#define TOVE_RASTER_AVX2 1
+#define TOVE_TARGET_AVX2 __attribute__((target("avx2")))
+#include <immintrin.h>
+#endif
+#endif
+
+#ifndef TOVE_RASTER_SSE2
+#define TOVE_RASTER_SSE2 0
+#endif
+
+#ifndef TOVE_RASTER_AVX2
+#define TOVE_RASTER_AVX2 0
+#endif
+
+#endif // __TOVE_SVGRAST_SIMD
@@ -56,6 +56,188 @@ inline void maskClip(
 	}
 }
 
+// scalar reference for the span kernels below: scale the paint's alpha by
+// coverage, premultiply and blend over dst.
+inline void tove__blendPixel(
+	unsigned char* dst,
+	int cover,
+	unsigned int c) {
+
+	int r, g, b;
+	const int cr = c & 0xff;
+	const int cg = (c >> 8) & 0xff;
+	const int cb = (c >> 16) & 0xff;
+	const int ca = (c >> 24) & 0xff;
+
+	int a = nsvg__div255(cover * ca);
+	const int ia = 255 - a;
+	// Premultiply
+	r = nsvg__div255(cr * a);
+	g = nsvg__div255(cg * a);
+	b = nsvg__div255(cb * a);
+
+	// Blend over
+	r += nsvg__div255(ia * (int)dst[0]);
+	g += nsvg__div255(ia * (int)dst[1]);
+	b += nsvg__div255(ia * (int)dst[2]);
+	a += nsvg__div255(ia * (int)dst[3]);
+
+	dst[0] = (unsigned char)r;
+	dst[1] = (unsigned char)g;
+	dst[2] = (unsigned char)b;
+	dst[3] = (unsigned char)a;
+}
+
+// the widest kernels the span functions may use: 0 is the scalar reference
+// only, 1 allows SSE2 and 2 AVX2. with TOVE_RASTER_TEST, tests can lower it
+// at runtime to compare the kernels in one binary.
+#ifdef TOVE_RASTER_TEST
+int tove__rasterSIMDLimit = 2;
+#else
+static const int tove__rasterSIMDLimit = 2;
+#endif
+
+#if TOVE_RASTER_SSE2
+inline bool tove__useSSE2() {
+	return tove__rasterSIMDLimit >= 1;
+}
+
+// nsvg__div255() on 8 lanes, exact for x <= 255 * 255.
+inline __m128i tove__div255x8(__m128i x) {
+	return _mm_mulhi_epu16(
+		_mm_add_epi16(x, _mm_set1_epi16(1)), _mm_set1_epi16(257));
+}
+
+// tove__blendPixel() on two pixels, unpacked to 16 bits per channel.
+inline __m128i tove__blend2(__m128i src, __m128i cover, __m128i dst) {
+	const __m128i ca = _mm_shufflehi_epi16(_mm_shufflelo_epi16(src, 0xff), 0xff);
+	const __m128i a = tove__div255x8(_mm_mullo_epi16(cover, ca));
+	const __m128i ia = _mm_sub_epi16(_mm_set1_epi16(255), a);
+	const __m128i alpha = _mm_setr_epi16(0, 0, 0, -1, 0, 0, 0, -1);
+
+	// premultiplies rgb, alpha stays a.
+	const __m128i p = _mm_or_si128(
+		_mm_andnot_si128(alpha, tove__div255x8(_mm_mullo_epi16(src, a))),
+		_mm_and_si128(alpha, a));
+
+	// sums never exceed 255, so packing does not saturate.
+	return _mm_add_epi16(p, tove__div255x8(_mm_mullo_epi16(dst, ia)));
+}
+
+inline void tove__blend4(
+	unsigned char* dst,
+	const unsigned char* cover,
+	__m128i src) {
+
+	int32_t c;
+	memcpy(&c, cover, 4);
+	__m128i cv = _mm_cvtsi32_si128(c);
+	cv = _mm_unpacklo_epi8(cv, cv);
+	cv = _mm_unpacklo_epi16(cv, cv);
+
+	const __m128i zero = _mm_setzero_si128();
+	const __m128i d = _mm_loadu_si128((const __m128i*)dst);
+
+	const __m128i lo = tove__blend2(_mm_unpacklo_epi8(src, zero),
+		_mm_unpacklo_epi8(cv, zero), _mm_unpacklo_epi8(d, zero));
+	const __m128i hi = tove__blend2(_mm_unpackhi_epi8(src, zero),
+		_mm_unpackhi_epi8(cv, zero), _mm_unpackhi_epi8(d, zero));
+
+	_mm_storeu_si128((__m128i*)dst, _mm_packus_epi16(lo, hi));
+}
+
+// FastGradientColors lookup on 4 lanes.
+inline __m128i tove__gradientColors4(
+	const unsigned int* colors,
+	__m128 gy) {
+
+	// max() picks 0 for NaNs, the scalar path would index out of bounds.
+	const __m128 v = _mm_min_ps(_mm_max_ps(
+		_mm_mul_ps(gy, _mm_set1_ps(255.0f)), _mm_setzero_ps()), _mm_set1_ps(255.0f));
+
+	int32_t i[4];
+	_mm_storeu_si128((__m128i*)i, _mm_cvttps_epi32(v));
+	return _mm_setr_epi32(colors[i[0]], colors[i[1]], colors[i[2]], colors[i[3]]);
+}
+#endif
+
+#if TOVE_RASTER_AVX2
+inline bool tove__useAVX2() {
+	static const bool avx2 = __builtin_cpu_supports("avx2");
+	return avx2 && tove__rasterSIMDLimit >= 2;
+}
+
+TOVE_TARGET_AVX2 inline __m256i tove__div255x16(__m256i x) {
+	return _mm256_mulhi_epu16(
+		_mm256_add_epi16(x, _mm256_set1_epi16(1)), _mm256_set1_epi16(257));
+}
+
+// same as tove__blend2(), on two pixels in each 128-bit lane.
+TOVE_TARGET_AVX2 inline __m256i tove__blend4x2(__m256i src, __m256i cover, __m256i dst) {
+	const __m256i ca = _mm256_shufflehi_epi16(_mm256_shufflelo_epi16(src, 0xff), 0xff);
+	const __m256i a = tove__div255x16(_mm256_mullo_epi16(cover, ca));
+	const __m256i ia = _mm256_sub_epi16(_mm256_set1_epi16(255), a);
+	const __m256i alpha = _mm256_setr_epi16(
+		0, 0, 0, -1, 0, 0, 0, -1, 0, 0, 0, -1, 0, 0, 0, -1);
+
+	const __m256i p = _mm256_or_si256(
+		_mm256_andnot_si256(alpha, tove__div255x16(_mm256_mullo_epi16(src, a))),
+		_mm256_and_si256(alpha, a));
+
+	return _mm256_add_epi16(p, tove__div255x16(_mm256_mullo_epi16(dst, ia)));
+}
+
+TOVE_TARGET_AVX2 inline void tove__blend8(
+	unsigned char* dst,
+	const unsigned char* cover,
+	__m256i src) {
+
+	__m128i cv = _mm_loadl_epi64((const __m128i*)cover);
+	cv = _mm_unpacklo_epi8(cv, cv);
+	// pixels 0-3 go to the low lane, 4-7 to the high one, like in src and dst.
+	const __m256i cv2 = _mm256_inserti128_si256(_mm256_castsi128_si256(
+		_mm_unpacklo_epi16(cv, cv)), _mm_unpackhi_epi16(cv, cv), 1);
+
+	const __m256i zero = _mm256_setzero_si256();
+	const __m256i d = _mm256_loadu_si256((const __m256i*)dst);
+
+	const __m256i lo = tove__blend4x2(_mm256_unpacklo_epi8(src, zero),
+		_mm256_unpacklo_epi8(cv2, zero), _mm256_unpacklo_epi8(d, zero));
+	const __m256i hi = tove__blend4x2(_mm256_unpackhi_epi8(src, zero),
+		_mm256_unpackhi_epi8(cv2, zero), _mm256_unpackhi_epi8(d, zero));
+
+	_mm256_storeu_si256((__m256i*)dst, _mm256_packus_epi16(lo, hi));
+}
+
+TOVE_TARGET_AVX2 inline __m256i tove__gradientColors8(
+	const unsigned int* colors,
+	__m256 gy) {
+
+	const __m256 v = _mm256_min_ps(_mm256_max_ps(
+		_mm256_mul_ps(gy, _mm256_set1_ps(255.0f)), _mm256_setzero_ps()), _mm256_set1_ps(255.0f));
+
+	// plain loads beat vpgatherdd on most cores.
+	int32_t i[8];
+	_mm256_storeu_si256((__m256i*)i, _mm256_cvttps_epi32(v));
+	return _mm256_setr_epi32(colors[i[0]], colors[i[1]], colors[i[2]], colors[i[3]],
+		colors[i[4]], colors[i[5]], colors[i[6]], colors[i[7]]);
+}
+
+TOVE_TARGET_AVX2 int tove__drawColorSpanAVX2(
+	unsigned char* dst,
+	const unsigned char* cover,
+	int count,
+	unsigned int c) {
+
+	const __m256i src = _mm256_set1_epi32(c);
+	int i = 0;
+	for (; i + 8 <= count; i += 8) {
+		tove__blend8(dst + i * 4, cover + i, src);
+	}
+	return i;
+}
+#endif
+
 void tove__drawColorScanline(
 	NSVGrasterizer* r,
 	int xmin,
@@ -71,34 +253,68 @@ void tove__drawColorScanline(
 	unsigned char* cover = &r->scanline[xmin];
 	maskClip(r, clip, xmin, y, count);
 
-	int i, cr, cg, cb, ca;
-	cr = cache->colors[0] & 0xff;
-	cg = (cache->colors[0] >> 8) & 0xff;
-	cb = (cache->colors[0] >> 16) & 0xff;
-	ca = (cache->colors[0] >> 24) & 0xff;
-
-	for (i = 0; i < count; i++) {
-		int r,g,b;
-		int a = nsvg__div255((int)cover[0] * ca);
-		int ia = 255 - a;
-		// Premultiply
-		r = nsvg__div255(cr * a);
-		g = nsvg__div255(cg * a);
-		b = nsvg__div255(cb * a);
-
-		// Blend over
-		r += nsvg__div255(ia * (int)dst[0]);
-		g += nsvg__div255(ia * (int)dst[1]);
-		b += nsvg__div255(ia * (int)dst[2]);
-		a += nsvg__div255(ia * (int)dst[3]);
-
-		dst[0] = (unsigned char)r;
-		dst[1] = (unsigned char)g;
-		dst[2] = (unsigned char)b;
-		dst[3] = (unsigned char)a;
+	const unsigned int c = cache->colors[0];
+	int i = 0;
 
-		cover++;
-		dst += 4;
+#if TOVE_RASTER_AVX2
+	if (tove__useAVX2()) {
+		i = tove__drawColorSpanAVX2(dst, cover, count, c);
+	}
+#endif
+
+#if TOVE_RASTER_SSE2
+	if (tove__useSSE2()) {
+		const __m128i src = _mm_set1_epi32(c);
+		for (; i + 4 <= count; i += 4) {
+			tove__blend4(dst + i * 4, cover + i, src);
+		}
+	}
+#endif
+
+	for (; i < count; i++) {
+		tove__blendPixel(dst + i * 4, cover[i], c);
+	}
+}
+
+// alpha channel of tove__drawColorScanline() only, into 1 byte per pixel.
+void tove__drawAlphaScanline(
+	NSVGrasterizer* r,
+	int xmin,
+	int y,
+	int count,
+	float tx,
+	float ty,
+	float scale,
+	NSVGcachedPaint* cache,
+	TOVEclip* clip) {
+
+	unsigned char* dst = &r->bitmap[y * r->stride] + xmin;
+	unsigned char* cover = &r->scanline[xmin];
+	maskClip(r, clip, xmin, y, count);
+
+	const int ca = (cache->colors[0] >> 24) & 0xff;
+	int i = 0;
+
+#if TOVE_RASTER_SSE2
+	if (tove__useSSE2()) {
+		const __m128i zero = _mm_setzero_si128();
+		const __m128i cav = _mm_set1_epi16(ca);
+		for (; i + 8 <= count; i += 8) {
+			const __m128i cv = _mm_unpacklo_epi8(
+				_mm_loadl_epi64((const __m128i*)(cover + i)), zero);
+			const __m128i d = _mm_unpacklo_epi8(
+				_mm_loadl_epi64((const __m128i*)(dst + i)), zero);
+			const __m128i a = tove__div255x8(_mm_mullo_epi16(cv, cav));
+			const __m128i ia = _mm_sub_epi16(_mm_set1_epi16(255), a);
+			const __m128i v = _mm_add_epi16(a, tove__div255x8(_mm_mullo_epi16(d, ia)));
+			_mm_storel_epi64((__m128i*)(dst + i), _mm_packus_epi16(v, v));
+		}
+	}
+#endif
+
+	for (; i < count; i++) {
+		const int a = nsvg__div255(cover[i] * ca);
+		dst[i] = (unsigned char)(a + nsvg__div255((255 - a) * (int)dst[i]));
 	}
 }
 
@@ -112,6 +328,21 @@ public:
 	inline float operator()(float fx, float fy) const {
 		return fx*t[1] + fy*t[3] + t[5];
 	}
+
+	// the vector versions round exactly like the scalar one.
+#if TOVE_RASTER_SSE2
+	inline __m128 operator()(__m128 fx, float fy) const {
+		return _mm_add_ps(_mm_add_ps(
+			_mm_mul_ps(fx, _mm_set1_ps(t[1])), _mm_set1_ps(fy*t[3])), _mm_set1_ps(t[5]));
+	}
+#endif
+
+#if TOVE_RASTER_AVX2
+	TOVE_TARGET_AVX2 inline __m256 operator()(__m256 fx, float fy) const {
+		return _mm256_add_ps(_mm256_add_ps(
+			_mm256_mul_ps(fx, _mm256_set1_ps(t[1])), _mm256_set1_ps(fy*t[3])), _mm256_set1_ps(t[5]));
+	}
+#endif
 };
 
 class RadialGradient {
@@ -126,6 +357,26 @@ public:
 		const float gy = fx*t[1] + fy*t[3] + t[5];
 		return sqrtf(gx*gx + gy*gy);
 	}
+
+#if TOVE_RASTER_SSE2
+	inline __m128 operator()(__m128 fx, float fy) const {
+		const __m128 gx = _mm_add_ps(_mm_add_ps(
+			_mm_mul_ps(fx, _mm_set1_ps(t[0])), _mm_set1_ps(fy*t[2])), _mm_set1_ps(t[4]));
+		const __m128 gy = _mm_add_ps(_mm_add_ps(
+			_mm_mul_ps(fx, _mm_set1_ps(t[1])), _mm_set1_ps(fy*t[3])), _mm_set1_ps(t[5]));
+		return _mm_sqrt_ps(_mm_add_ps(_mm_mul_ps(gx, gx), _mm_mul_ps(gy, gy)));
+	}
+#endif
+
+#if TOVE_RASTER_AVX2
+	TOVE_TARGET_AVX2 inline __m256 operator()(__m256 fx, float fy) const {
+		const __m256 gx = _mm256_add_ps(_mm256_add_ps(
+			_mm256_mul_ps(fx, _mm256_set1_ps(t[0])), _mm256_set1_ps(fy*t[2])), _mm256_set1_ps(t[4]));
+		const __m256 gy = _mm256_add_ps(_mm256_add_ps(
+			_mm256_mul_ps(fx, _mm256_set1_ps(t[1])), _mm256_set1_ps(fy*t[3])), _mm256_set1_ps(t[5]));
+		return _mm256_sqrt_ps(_mm256_add_ps(_mm256_mul_ps(gx, gx), _mm256_mul_ps(gy, gy)));
+	}
+#endif
 };
 
 class FastGradientColors {
@@ -149,6 +400,73 @@ public:
 	}
 };
 
+// walks the stops of a gradient along a scanline, and gives the colors
+// between them unrounded, for the dithered gradient colors below.
+class GradientStops {
+	const NSVGgradient * const gradient;
+	const NSVGgradientStop *stop;
+	const NSVGgradientStop *const stopN;
+
+public:
+	inline GradientStops(const NSVGcachedPaint *cache) :
+		gradient(cache->tove.paint->gradient),
+		stop(gradient->stops),
+		stopN(gradient->stops + gradient->nstops) {
+	}
+
+	static void init(
+		NSVGcachedPaint* cache,
+		NSVGpaint* paint,
+		float opacity) {
+
+		cache->tove.paint = paint;
+
+		NSVGgradientStop *stop = paint->gradient->stops;
+		const int n = paint->gradient->nstops;
+
+		for (int i = 0; i < n; i++) {
+			stop->tove.color = nsvg__applyOpacity(stop->color, opacity);
+			stop->tove.offset = nsvg__clampf(stop->offset, 0.0f, 1.0f);
+			stop++;
+		}
+	}
+
+	inline bool good() const {
+		return stop + 1 < stopN;
+	}
+
+	inline void operator()(const float gy, float *rgba) {
+		while (gy >= (stop + 1)->tove.offset && (stop + 2) < stopN) {
+			stop++;
+		}
+		while (gy < stop->tove.offset && stop > gradient->stops) {
+			stop--;
+		}
+
+		const unsigned int c0 = stop->tove.color;
+		const int cr0 = (c0) & 0xff;
+		const int cg0 = (c0 >> 8) & 0xff;
+		const int cb0 = (c0 >> 16) & 0xff;
+		const int ca0 = (c0 >> 24) & 0xff;
+
+		const unsigned int c1 = (stop + 1)->tove.color;
+		const int cr1 = (c1) & 0xff;
+		const int cg1 = (c1 >> 8) & 0xff;
+		const int cb1 = (c1 >> 16) & 0xff;
+		const int ca1 = (c1 >> 24) & 0xff;
+
+		const float offset0 = stop->tove.offset;
+		const float range = (stop + 1)->tove.offset - offset0;
+		const float t = nsvg__clampf((gy - offset0) / range, 0.0f, 1.0f);
+		const float s = 1.0f - t;
+
+		rgba[0] = cr0 * s + cr1 * t;
+		rgba[1] = cg0 * s + cg1 * t;
+		rgba[2] = cb0 * s + cb1 * t;
+		rgba[3] = ca0 * s + ca1 * t;
+	}
+};
+
 class BestGradientColors {
 	typedef float dither_error_t;
 	
@@ -158,9 +476,7 @@ class BestGradientColors {
 
 	dither_error_t *diffusion[diffusion_matrix_height];
 
-	const NSVGgradient * const gradient;
-	const NSVGgradientStop *stop;
-	const NSVGgradientStop *const stopN;
+	GradientStops stops;
 
 	inline void rotate(
 		const NSVGrasterizer* r,
@@ -226,15 +542,13 @@ public:
 		int y,
 		int count) :
 
-		gradient(cache->tove.paint->gradient),
-		stop(gradient->stops),
-		stopN(gradient->stops + gradient->nstops) {
+		stops(cache) {
 
 		rotate(r, cache, x, y, count);
 	}
 
 	static inline bool enabled(const NSVGrasterizer* r) {
-		return r->quality > 0;
+		return r->quality == 1;
 	}
 
 	static inline bool allocate(NSVGrasterizer* r, int w) {
@@ -254,56 +568,26 @@ public:
 		NSVGpaint* paint,
 		float opacity) {
 
-		cache->tove.paint = paint;
+		GradientStops::init(cache, paint, opacity);
 		cache->tove.ditherY = -diffusion_matrix_height;
-
-		NSVGgradientStop *stop = paint->gradient->stops;
-		const int n = paint->gradient->nstops;
-
-		for (int i = 0; i < n; i++) {
-			stop->tove.color = nsvg__applyOpacity(stop->color, opacity);
-			stop->tove.offset = nsvg__clampf(stop->offset, 0.0f, 1.0f);
-			stop++;
-		}
 	}
 
 	inline bool good() const {
-		return stop + 1 < stopN;
+		return stops.good();
 	}
 
 	inline uint32_t operator()(const int x, const float gy) {
-		while (gy >= (stop + 1)->tove.offset && (stop + 2) < stopN) {
-			stop++;
-		}
-		while (gy < stop->tove.offset && stop > gradient->stops) {
-			stop--;
-		}
+		float c[4];
+		stops(gy, c);
 
 		dither_error_t * const r0 = diffusion[0];
 		dither_error_t * const r1 = diffusion[1];
 		dither_error_t * const r2 = diffusion[2];
 
-		const unsigned int c0 = stop->tove.color;
-		const int cr0 = (c0) & 0xff;
-		const int cg0 = (c0 >> 8) & 0xff;
-		const int cb0 = (c0 >> 16) & 0xff;
-		const int ca0 = (c0 >> 24) & 0xff;
-
-		const unsigned int c1 = (stop + 1)->tove.color;
-		const int cr1 = (c1) & 0xff;
-		const int cg1 = (c1 >> 8) & 0xff;
-		const int cb1 = (c1 >> 16) & 0xff;
-		const int ca1 = (c1 >> 24) & 0xff;
-
-		const float offset0 = stop->tove.offset;
-		const float range = (stop + 1)->tove.offset - offset0;
-		const float t = nsvg__clampf((gy - offset0) / range, 0.0f, 1.0f);
-		const float s = 1.0f - t;
-
-		const float f_cr = (cr0 * s + cr1 * t) + r0[x * dither_components + 0];
-		const float f_cg = (cg0 * s + cg1 * t) + r0[x * dither_components + 1];
-		const float f_cb = (cb0 * s + cb1 * t) + r0[x * dither_components + 2];
-		const float f_ca = (ca0 * s + ca1 * t) + r0[x * dither_components + 3];
+		const float f_cr = c[0] + r0[x * dither_components + 0];
+		const float f_cg = c[1] + r0[x * dither_components + 1];
+		const float f_cb = c[2] + r0[x * dither_components + 2];
+		const float f_ca = c[3] + r0[x * dither_components + 3];
 
 		const int cr = nsvg__clampf(f_cr + 0.5, 0.0f, 255.0f);
 		const int cg = nsvg__clampf(f_cg + 0.5, 0.0f, 255.0f);
@@ -339,6 +623,141 @@ public:
 	}
 };
 
+// ordered dithering only depends on where a pixel is, so unlike error
+// diffusion it gives the same result for bands rasterized in any order.
+class OrderedGradientColors {
+	GradientStops stops;
+	const float *row;
+	const int mask;
+	const float spread;
+
+public:
+	inline OrderedGradientColors(
+		NSVGrasterizer* r,
+		NSVGcachedPaint *cache,
+		int x,
+		int y,
+		int count) :
+
+		stops(cache),
+		row(r->ordered.matrix + (y & (r->ordered.size - 1)) * r->ordered.size),
+		mask(r->ordered.size - 1),
+		spread(r->ordered.spread) {
+	}
+
+	static inline bool enabled(const NSVGrasterizer* r) {
+		return r->quality == 2;
+	}
+
+	static void init(
+		NSVGcachedPaint* cache,
+		NSVGpaint* paint,
+		float opacity) {
+
+		GradientStops::init(cache, paint, opacity);
+	}
+
+	inline bool good() const {
+		return stops.good();
+	}
+
+	inline uint32_t operator()(const int x, const float gy) {
+		float c[4];
+		stops(gy, c);
+
+		const float threshold = row[x & mask] * spread + 0.5f;
+		const int cr = nsvg__clampf(c[0] + threshold, 0.0f, 255.0f);
+		const int cg = nsvg__clampf(c[1] + threshold, 0.0f, 255.0f);
+		const int cb = nsvg__clampf(c[2] + threshold, 0.0f, 255.0f);
+		const int ca = nsvg__clampf(c[3] + threshold, 0.0f, 255.0f);
+
+		return cr | (cg << 8) | (cb << 16) | (ca << 24);
+	}
+};
+
+// diffused colors depend on the pixel before, so only FastGradientColors
+// gets vector kernels. these return the number of pixels done and advance
+// fx exactly like the scalar loop would.
+template<typename Gradient, typename Colors>
+inline int tove__drawGradientSpan(
+	const Gradient &gradient,
+	Colors &colors,
+	const NSVGcachedPaint* cache,
+	unsigned char* dst,
+	const unsigned char* cover,
+	int count,
+	float &fx,
+	float fy,
+	float dx) {
+
+	return 0;
+}
+
+#if TOVE_RASTER_AVX2
+template<typename Gradient>
+TOVE_TARGET_AVX2 int tove__drawGradientSpanAVX2(
+	const Gradient &gradient,
+	const NSVGcachedPaint* cache,
+	unsigned char* dst,
+	const unsigned char* cover,
+	int count,
+	float &fx,
+	float fy,
+	float dx) {
+
+	float lanes[8];
+	int i = 0;
+	for (; i + 8 <= count; i += 8) {
+		for (int j = 0; j < 8; j++) {
+			lanes[j] = fx;
+			fx += dx;
+		}
+		tove__blend8(dst + i * 4, cover + i, tove__gradientColors8(
+			cache->colors, gradient(_mm256_loadu_ps(lanes), fy)));
+	}
+	return i;
+}
+#endif
+
+#if TOVE_RASTER_SSE2
+template<typename Gradient>
+inline int tove__drawGradientSpan(
+	const Gradient &gradient,
+	FastGradientColors &colors,
+	const NSVGcachedPaint* cache,
+	unsigned char* dst,
+	const unsigned char* cover,
+	int count,
+	float &fx,
+	float fy,
+	float dx) {
+
+	if (!tove__useSSE2()) {
+		return 0;
+	}
+
+	int i = 0;
+
+#if TOVE_RASTER_AVX2
+	if (tove__useAVX2()) {
+		i = tove__drawGradientSpanAVX2(gradient, cache, dst, cover, count, fx, fy, dx);
+	}
+#endif
+
+	// the scalar loop adds dx pixel by pixel, so lanes do the same.
+	float lanes[4];
+	for (; i + 4 <= count; i += 4) {
+		for (int j = 0; j < 4; j++) {
+			lanes[j] = fx;
+			fx += dx;
+		}
+		tove__blend4(dst + i * 4, cover + i, tove__gradientColors4(
+			cache->colors, gradient(_mm_loadu_ps(lanes), fy)));
+	}
+	return i;
+}
+#endif
+
 template<typename Gradient, typename Colors>
 void drawGradientScanline(
 	NSVGrasterizer* r,
@@ -351,17 +770,13 @@ void drawGradientScanline(
 	NSVGcachedPaint* cache,
 	TOVEclip* clip) {
 
-	using tove::nsvg__div255;
-
 	unsigned char* dst = &r->bitmap[y * r->stride] + x*4;
 	unsigned char* cover = &r->scanline[x];
 	maskClip(r, clip, x, y, count);
 
 	// TODO: spread modes.
-	// TODO: plenty of opportunities to optimize.
 	float fx, fy, dx;
-	int i, cr, cg, cb, ca;
-	unsigned int c;
+	int i;
 	Gradient gradient(cache);
 	Colors colors(r, cache, x, y, count);
 
@@ -369,32 +784,13 @@ void drawGradientScanline(
 	fy = ((float)y - ty) / scale;
 	dx = 1.0f / scale;
 
-	for (i = 0; i < count; i++) {
-		int r,g,b,a,ia;
-		c = colors(x, gradient(fx, fy));
-		cr = (c) & 0xff;
-		cg = (c >> 8) & 0xff;
-		cb = (c >> 16) & 0xff;
-		ca = (c >> 24) & 0xff;
-
-		a = nsvg__div255((int)cover[0] * ca);
-		ia = 255 - a;
-
-		// Premultiply
-		r = nsvg__div255(cr * a);
-		g = nsvg__div255(cg * a);
-		b = nsvg__div255(cb * a);
-
-		// Blend over
-		r += nsvg__div255(ia * (int)dst[0]);
-		g += nsvg__div255(ia * (int)dst[1]);
-		b += nsvg__div255(ia * (int)dst[2]);
-		a += nsvg__div255(ia * (int)dst[3]);
-
-		dst[0] = (unsigned char)r;
-		dst[1] = (unsigned char)g;
-		dst[2] = (unsigned char)b;
-		dst[3] = (unsigned char)a;
+	i = tove__drawGradientSpan(gradient, colors, cache, dst, cover, count, fx, fy, dx);
+	dst += i * 4;
+	cover += i;
+	x += i;
+
+	for (; i < count; i++) {
+		tove__blendPixel(dst, cover[0], colors(x, gradient(fx, fy)));
 
 		cover++;
 		dst += 4;
@@ -423,6 +819,19 @@ TOVEscanlineFunction tove__initPaint(
 		}
 	}
 
+	if (r && OrderedGradientColors::enabled(r)) {
+		switch (cache->type) {
+			case NSVG_PAINT_LINEAR_GRADIENT:
+				OrderedGradientColors::init(cache, paint, opacity);
+				initCacheColors = false;
+				return drawGradientScanline<LinearGradient, OrderedGradientColors>;
+			case NSVG_PAINT_RADIAL_GRADIENT:
+				OrderedGradientColors::init(cache, paint, opacity);
+				initCacheColors = false;
+				return drawGradientScanline<RadialGradient, OrderedGradientColors>;
+		}
+	}
+
 	initCacheColors = true;
 	switch (cache->type) {
 		case NSVG_PAINT_LINEAR_GRADIENT:
@@ -26,6 +26,14 @@ struct TOVEdither {
 	uint32_t stride;
 };
 
+// threshold matrix of ordered dithering, centered on 0 like
+// ToveDither's, size * size with size a power of 2.
+struct TOVEorderedDither {
+	const float* matrix;
+	int32_t size;
+	float spread;
+};
+
 struct TOVEcachedPaint {
 	NSVGpaint *paint;
 	int32_t ditherY;
@@ -71,3 +79,14 @@ void tove__drawColorScanline(
 	float scale,
 	NSVGcachedPaint* cache,
 	TOVEclip* clip);
+
+void tove__drawAlphaScanline(
+	NSVGrasterizer* r,
+	int xmin,
+	int y,
+	int count,
+	float tx,
+	float ty,
+	float scale,
+	NSVGcachedPaint* cache,
+	TOVEclip* clip);
@@ -0,0 +1,46 @@
+// generated by bench/blue_noise_table.cpp, do not edit.
+//
+// 32x32 BlueNoise from thirdparty/bluenoise.h, seed 1, centered on 0
+// like the bayer matrices, so thresholds are in [-0.5, 0.5].
+
+#ifndef __TOVE_BLUENOISE_TABLE
+#define __TOVE_BLUENOISE_TABLE 1
+
+#define TOVE_BLUE_NOISE_SIZE 32
+
+static const float tove_blue_noise[TOVE_BLUE_NOISE_SIZE * TOVE_BLUE_NOISE_SIZE] = {
+	-0.217497557f, 0.369012713f, -0.489247322f, -0.130498528f, 0.120723367f, 0.368035197f, 0.0395894647f, 0.42082113f, 0.201857269f, 0.00830888748f, -0.26539588f, 0.239980459f, -0.301564038f, 0.0190615654f, 0.170576751f, 0.36999023f, -0.483382195f, 0.379765391f, -0.109970689f, 0.339687169f, -0.457966775f, 0.495112419f, 0.0425220132f, -0.30351907f, 0.446236551f, -0.260508299f, 0.341642201f, -0.397360712f, 0.277126074f, -0.178396881f, -0.444281518f, 0.458944261f,
+	-0.0278592408f, 0.266373396f, -0.153958946f, 0.477517128f, -0.365102649f, -0.254643202f, 0.250733137f, -0.394428134f, -0.259530783f, 0.45405668f, -0.0865102708f, 0.276148558f, 0.112903237f, 0.423753679f, -0.400293261f, 0.0816226602f, -0.193059623f, -0.331867039f, 0.153958917f, -0.242913008f, -0.0513196588f, 0.214564979f, -0.39540568f, 0.233137846f, 0.0239491463f, 0.239002943f, -0.322091877f, 0.086510241f, -0.0522971749f, 0.44134897f, 0.190127075f, -0.310361683f,
+	0.0689149499f, -0.282991201f, 0.218475044f, -0.304496586f, 0.159824073f, -0.175464332f, 0.0200390816f, 0.117790818f, -0.121700883f, -0.355327487f, 0.347507358f, -0.470674485f, -0.320136845f, -0.11485827f, -0.0151515007f, 0.321114361f, -0.0493646264f, 0.246823072f, -0.360215068f, 0.432551324f, 0.064027369f, -0.3113392f, 0.273216009f, -0.064027369f, -0.431573808f, 0.152003884f, -0.146138817f, 0.410068452f, -0.472629517f, -0.253665686f, -0.119745851f, 0.331867039f,
+	-0.0777125955f, 0.402248263f, 0.0923753381f, -0.460899323f, 0.287878811f, -0.0630498528f, 0.292766392f, -0.456011742f, 0.381720424f, 0.0464320779f, -0.00733137131f, 0.150048852f, 0.46676439f, -0.233137816f, 0.220430136f, -0.36999023f, 0.394428134f, -0.138318658f, 0.297653973f, -0.0141739845f, -0.478494614f, 0.383675456f, -0.205767363f, 0.401270747f, -0.147116333f, -0.249755621f, 0.28299123f, -0.00635385513f, 0.116813302f, 0.310361683f, 0.156891525f, -0.405180842f,
+	-0.346529812f, -0.0249266922f, -0.206744879f, 0.433528841f, -0.162756592f, 0.492179871f, -0.294721425f, 0.320136845f, 0.184261978f, -0.149071366f, -0.208699912f, -0.413978487f, 0.326979458f, 0.0747800469f, -0.450146616f, 0.158846557f, -0.295698941f, 0.115835786f, -0.435483873f, 0.188172042f, -0.203812331f, 0.109970689f, -0.411045939f, -0.0826002061f, 0.164711654f, 0.485337257f, -0.373900294f, -0.29081136f, -0.0835777223f, -0.423753679f, 0.00342130661f, 0.488269806f,
+	0.132453561f, 0.342619717f, -0.413000971f, 0.174486816f, -0.0131964684f, -0.436461389f, 0.0571847558f, -0.377810359f, -0.0933528841f, 0.418866098f, 0.251710653f, -0.269305944f, -0.0689149499f, -0.18621701f, 0.405180812f, -0.129521012f, 0.483382225f, -0.215542525f, 0.0601173043f, 0.456989229f, -0.0718474984f, 0.358260036f, -0.241935492f, 0.318181813f, -0.48729229f, 0.041544497f, 0.346529841f, -0.0562072396f, 0.414956033f, 0.203812301f, -0.273216009f, -0.165689141f,
+	-0.494134903f, 0.270283461f, 0.0454545617f, -0.326001942f, 0.255620718f, -0.239002943f, 0.363147616f, 0.134408593f, -0.313294232f, 0.183284461f, -0.485337257f, 0.104105592f, 0.29081136f, 0.0171065331f, -0.34946236f, 0.249755621f, -0.493157387f, 0.334799588f, -0.264418364f, -0.104105562f, -0.381720424f, 0.256598234f, -0.0337243378f, 0.14809382f, 0.419843614f, -0.192082107f, 0.0962854624f, -0.446236551f, 0.0366569161f, -0.224340171f, 0.2243402f, 0.380742908f,
+	0.0904203057f, -0.220430106f, -0.101173013f, 0.429618776f, -0.0650048852f, 0.0992180109f, -0.19892472f, 0.413978517f, -0.0434994996f, -0.344574779f, 0.439393938f, -0.24486804f, 0.476539612f, -0.387585521f, 0.211632431f, -0.117790818f, 0.135386109f, -0.0327468216f, 0.288856328f, 0.0259041786f, 0.450146616f, -0.275171071f, 0.0845552087f, -0.33675465f, -0.0884653032f, -0.370967746f, 0.3113392f, 0.176441848f, -0.329912007f, 0.462854326f, -0.451124132f, -0.0738025308f,
+	0.392473102f, 0.0102639198f, -0.341642231f, 0.352394938f, -0.417888552f, 0.212609947f, -0.476539582f, -0.133431077f, 0.344574809f, 0.0493646264f, 0.26539588f, -0.00439882278f, -0.172531784f, -0.0591397882f, 0.0249266624f, 0.366080165f, -0.330889523f, -0.157869011f, 0.0982404947f, -0.40811339f, -0.189149559f, 0.234115362f, -0.465786904f, 0.471652031f, 0.187194526f, 0.0151515007f, -0.272238493f, -0.135386109f, 0.357282519f, 0.126588464f, -0.185239494f, 0.301564038f,
+	-0.391495585f, -0.14027369f, 0.238025427f, 0.0552297235f, -0.250733137f, 0.447214067f, 0.000488758087f, 0.175464332f, -0.399315745f, -0.100195497f, -0.426686227f, -0.286901265f, 0.226295233f, -0.458944291f, 0.430596292f, -0.297653973f, 0.192082107f, 0.491202354f, -0.440371454f, 0.398338199f, 0.142228723f, -0.155913979f, 0.217497528f, -0.305474102f, -0.106060594f, 0.442326486f, -0.176441848f, 0.281036139f, -0.0210166276f, -0.379765391f, 0.237047911f, -0.277126104f,
+	0.182306945f, 0.480449677f, -0.468719453f, 0.335777104f, -0.125610948f, -0.291788876f, 0.299609005f, -0.247800589f, 0.0630498528f, 0.496089935f, -0.174486816f, 0.40322578f, 0.0913978219f, 0.305474102f, -0.163734108f, 0.0562072396f, -0.475562066f, -0.214565009f, 0.298631489f, 0.00244379044f, 0.272238493f, -0.368035197f, 0.0307917595f, 0.407135904f, -0.42864126f, 0.080645144f, 0.248778105f, -0.461876839f, 0.463831842f, -0.108993143f, -0.034701854f, 0.0786901116f,
+	-0.230205268f, -0.0669599175f, 0.103128076f, -0.32404691f, -0.0796676576f, 0.468719423f, -0.366080165f, -0.0474095941f, 0.230205297f, -0.234115332f, 0.306451619f, 0.0728250146f, -0.199902236f, -0.333822072f, 0.199902236f, -0.0229716599f, 0.351417422f, -0.0904203355f, 0.0434995294f, -0.287878782f, -0.120723367f, 0.323069394f, -0.0366568863f, -0.229227751f, 0.378787875f, -0.239980459f, -0.338709682f, 0.0669599175f, -0.299609005f, 0.208699882f, -0.481427163f, 0.333822072f,
+	-0.315249264f, 0.157869041f, 0.413001001f, 0.0347018838f, -0.429618776f, 0.118768334f, 0.200879753f, 0.389540553f, -0.488269806f, 0.139296174f, -0.353372455f, -0.0376344025f, -0.445259035f, 0.459921777f, -0.27810362f, 0.284946263f, -0.350439876f, 0.417888582f, -0.392473102f, 0.19892472f, -0.345552295f, 0.494134903f, -0.479472131f, 0.169599235f, -0.0532746911f, 0.267350912f, 0.144183755f, 0.372922778f, -0.201857269f, -0.0200391114f, 0.5f, -0.158846527f,
+	0.189149559f, -0.407135874f, -0.188172042f, 0.240957975f, 0.350439906f, -0.309384167f, -0.116813302f, -0.356305003f, 0.0268816948f, 0.37487781f, -0.0982404649f, 0.396383166f, 0.247800589f, -0.170576721f, 0.146138787f, -0.401270777f, -0.113880754f, 0.0826001763f, -0.0259042084f, 0.375855327f, 0.130498528f, -0.141251236f, 0.0620723367f, 0.356305003f, -0.289833844f, 0.0141739845f, -0.136363626f, -0.398338228f, 0.425708711f, 0.0317693353f, -0.432551324f, 0.285923779f,
+	-0.367057681f, 0.360215068f, -0.151026398f, -0.263440847f, -0.0161290467f, 0.0855327249f, 0.27810359f, 0.444281518f, -0.182306945f, -0.270283461f, 0.172531784f, -0.393450618f, 0.10703814f, 0.00928640366f, 0.38269794f, -0.0620723367f, 0.179374397f, 0.455034196f, -0.184261978f, -0.453079164f, -0.21945259f, 0.00635385513f, -0.314271748f, -0.385630488f, 0.307429135f, -0.499022484f, 0.279081106f, -0.161779076f, 0.131476045f, -0.352394938f, 0.393450618f, -0.0552297235f,
+	0.245845556f, -0.00146627426f, 0.427663743f, 0.129521012f, -0.0962854326f, -0.447214067f, -0.210654944f, -0.0288367569f, 0.330889523f, -0.469696969f, 0.0122189522f, 0.47947216f, -0.143206269f, -0.497067451f, -0.25757575f, 0.327956975f, -0.433528841f, -0.306451619f, 0.271260977f, 0.213587463f, 0.475562096f, 0.167644203f, 0.435483873f, -0.0913978517f, 0.122678399f, 0.473607063f, 0.0835776925f, -0.262463331f, 0.225317717f, -0.10215053f, 0.0650048852f, -0.235092878f,
+	-0.123655915f, -0.455034196f, 0.309384167f, -0.496089935f, 0.484359741f, 0.168621719f, 0.412023485f, -0.390518069f, 0.154936433f, -0.0786901414f, 0.235092878f, -0.228250235f, 0.355327487f, -0.0122189522f, 0.445259035f, -0.231182784f, 0.124633431f, 0.0767350793f, -0.0425219834f, -0.128543496f, -0.421798646f, -0.255620718f, -0.169599205f, 0.242913008f, -0.207722396f, -0.412023455f, -0.00830888748f, 0.409090936f, -0.467741936f, 0.322091877f, -0.279081136f, 0.1529814f,
+	0.451124132f, 0.0953079462f, -0.0698924661f, -0.213587493f, 0.216520011f, -0.276148587f, 0.0288367271f, 0.105083108f, -0.171554238f, 0.194037139f, -0.425708711f, 0.289833844f, -0.340664715f, 0.205767334f, -0.371945262f, -0.0992179811f, 0.313294232f, -0.266373396f, -0.486314774f, 0.371945262f, 0.0522971749f, 0.262463331f, 0.102150559f, -0.41593352f, 0.33675462f, -0.0679374337f, 0.202834785f, -0.202834785f, 0.293743908f, -0.0386119187f, 0.48729229f, -0.339687198f,
+	-0.183284461f, -0.359237552f, 0.275171041f, 0.027859211f, -0.376832843f, 0.295698941f, -0.139296174f, -0.335777104f, 0.457966745f, -0.298631489f, 0.40811342f, -0.0464320481f, 0.0444770455f, -0.15298143f, 0.274193525f, 0.145161271f, -0.212609977f, 0.348484874f, 0.222385168f, -0.00342130661f, -0.317204297f, 0.421798646f, -0.462854356f, 0.0356794f, -0.280058652f, 0.431573808f, -0.386608005f, 0.111925721f, -0.308406651f, 0.0405669808f, -0.437438905f, 0.123655915f,
+	0.178396881f, 0.370967746f, -0.115835786f, -0.296676457f, 0.424731195f, -0.459921807f, -0.00928640366f, 0.314271748f, -0.0894428194f, 0.0659824014f, -0.396383196f, 0.121700883f, 0.497067451f, -0.307429135f, -0.463831872f, 0.0298142433f, 0.443304002f, -0.325024426f, -0.087487787f, -0.384652972f, 0.328934491f, -0.0855327547f, -0.0268817246f, 0.384652972f, 0.161779106f, -0.142228752f, 0.011241436f, 0.460899293f, 0.196969688f, -0.126588464f, 0.254643202f, -0.0542522073f,
+	-0.416911036f, -0.248778105f, 0.329912007f, 0.11485827f, -0.0601173043f, 0.193059623f, 0.3621701f, -0.240957975f, 0.261485815f, -0.482404679f, 0.25757575f, -0.112903237f, -0.238025427f, 0.0972629786f, 0.406158328f, -0.134408593f, -0.409090906f, 0.207722366f, 0.478494644f, 0.0894427896f, -0.194037139f, 0.147116303f, -0.363147616f, 0.229227781f, -0.252688169f, 0.319159329f, -0.334799588f, -0.191104591f, -0.480449647f, 0.359237552f, -0.326979458f, 0.437438905f,
+	0.0610948205f, 0.231182814f, -0.37487781f, -0.180351913f, 0.465786874f, -0.403225809f, -0.274193555f, 0.136363626f, -0.357282519f, 0.376832843f, -0.190127075f, 0.166666687f, 0.343597233f, -0.422776163f, -0.0767350793f, 0.296676457f, 0.00733137131f, -0.0171065629f, -0.156891495f, -0.44134897f, 0.253665686f, -0.288856298f, 0.453079164f, -0.159824044f, 0.0933528543f, -0.443304002f, 0.263440847f, -0.0708699822f, 0.308406651f, -0.168621689f, 0.0542522073f, -0.226295203f,
+	0.415933549f, -0.492179871f, 0.386608005f, -0.0239491761f, 0.191104591f, -0.152003914f, 0.0483871102f, 0.489247322f, -0.0610948205f, 0.0131964684f, 0.291788876f, -0.439393938f, -0.258553267f, 0.058162272f, 0.137341142f, -0.372922778f, 0.385630488f, -0.246823072f, 0.180351913f, 0.361192584f, -0.221407622f, 0.16568917f, -0.0728250146f, -0.490224838f, 0.397360682f, -0.111925721f, 0.377810359f, 0.0738025308f, -0.361192584f, 0.482404709f, 0.195992172f, -0.00537633896f,
+	0.260508299f, -0.0923753679f, 0.0874877572f, -0.216520041f, -0.430596292f, 0.0708699822f, 0.252688169f, -0.47458455f, -0.2321603f, 0.46187681f, -0.347507328f, 0.09433043f, 0.367057681f, -0.177419364f, 0.438416421f, 0.21945262f, -0.302541554f, 0.113880754f, -0.473607033f, -0.108015627f, 0.499022484f, -0.406158358f, 0.0718474984f, 0.236070395f, -0.040566951f, -0.227272719f, -0.319159329f, 0.163734138f, -0.011241436f, -0.268328428f, -0.456989259f, -0.283968717f,
+	-0.150048882f, -0.323069394f, 0.354349971f, 0.162756622f, 0.449169099f, -0.318181813f, -0.122678399f, 0.400293231f, -0.00244379044f, -0.154936463f, -0.292766392f, 0.197947204f, -0.0483871102f, -0.491202354f, -0.327956975f, -0.0219941437f, -0.195992172f, 0.416911066f, 0.0474095941f, 0.325024426f, -0.342619747f, 0.0219941139f, 0.286901295f, -0.300586522f, 0.464809358f, 0.138318658f, 0.426686227f, -0.402248293f, 0.204789817f, 0.340664685f, -0.10703811f, 0.151026368f,
+	0.498044968f, 0.0337243676f, -0.404203326f, -0.0444770157f, -0.225317687f, 0.332844555f, 0.23216033f, 0.108015656f, -0.452101648f, 0.221407652f, 0.338709652f, -0.110948205f, 0.440371454f, 0.282013714f, 0.1735093f, -0.105083078f, 0.268328428f, -0.058162272f, -0.364125133f, 0.210654914f, -0.132453561f, 0.317204297f, -0.204789847f, -0.0356793702f, -0.383675456f, -0.145161301f, 0.0161290169f, 0.30351907f, -0.209677428f, -0.0454545319f, 0.39540565f, -0.427663743f,
+	0.128543496f, 0.337732136f, -0.0943304002f, 0.283968747f, -0.464809388f, -0.0298142731f, -0.348484844f, -0.181329429f, 0.434506357f, -0.251710653f, 0.0327468514f, -0.388563037f, -0.0102639198f, -0.414956003f, -0.223362654f, 0.486314774f, -0.449169099f, 0.125610948f, 0.452101648f, -0.271260977f, -0.000488758087f, -0.442326486f, 0.411045969f, 0.0503421426f, 0.365102649f, -0.477517098f, 0.0884652734f, -0.42082113f, 0.223362684f, -0.3621701f, 0.269305944f, -0.200879753f,
+	-0.018084079f, -0.261485815f, -0.354349971f, 0.469696999f, 0.0757575631f, 0.155913949f, 0.388563037f, 0.0210165977f, -0.321114361f, 0.185239494f, -0.137341142f, 0.472629547f, 0.12756598f, -0.148093849f, 0.24486804f, 0.0386119485f, 0.302541554f, -0.179374397f, -0.495112419f, 0.280058622f, 0.119745851f, -0.256598234f, 0.195014656f, -0.358260036f, 0.258553267f, -0.267350912f, 0.345552325f, -0.118768334f, 0.110948205f, 0.456011713f, -0.293743908f, 0.0180840492f,
+	-0.484359741f, 0.304496586f, 0.209677398f, -0.131476045f, -0.245845556f, -0.410068423f, -0.0747800469f, 0.264418364f, 0.353372455f, -0.438416421f, 0.326001942f, 0.0513196588f, -0.471652001f, 0.404203296f, -0.282013685f, -0.378787875f, -0.237047911f, -0.0757575631f, 0.390518069f, -0.337732166f, -0.167644173f, 0.467741907f, -0.0953079164f, 0.14027369f, -0.1735093f, -0.0806451738f, 0.490224838f, -0.236070395f, -0.0659824014f, -0.45405668f, 0.0796676278f, 0.436461389f,
+	0.108993173f, -0.187194526f, -0.312316716f, 0.243890524f, 0.399315715f, 0.141251206f, -0.284946233f, -0.369012713f, 0.0679374337f, -0.08162269f, -0.197947204f, -0.343597263f, 0.143206239f, -0.0571847558f, 0.20674485f, 0.0777125955f, 0.34946239f, 0.0591397882f, 0.00146627426f, 0.149071336f, 0.259530783f, -0.0317693055f, -0.46676442f, 0.422776163f, -0.332844555f, 0.177419364f, 0.0376344323f, -0.375855327f, 0.373900294f, 0.241935492f, -0.164711624f, -0.0845552385f,
+	0.312316716f, 0.0532746911f, 0.42864126f, -0.418866098f, -0.0415444672f, -0.196969688f, 0.227272749f, 0.493157387f, -0.218475074f, 0.387585521f, 0.160801589f, 0.294721425f, -0.21163246f, 0.315249264f, -0.166666657f, 0.470674515f, -0.31622678f, -0.419843614f, 0.448191583f, -0.281036168f, -0.389540553f, 0.364125133f, 0.0698924661f, -0.243890524f, 0.100195527f, 0.300586522f, -0.498044968f, 0.181329429f, -0.0307917893f, -0.328934491f, 0.391495585f, -0.351417392f,
+	-0.380742908f, -0.103128046f, 0.171554267f, 0.00537633896f, 0.32404691f, -0.448191583f, -0.0503421426f, -0.144183785f, -0.5f, 0.101173043f, -0.38269794f, -0.0395894349f, 0.481427193f, -0.434506357f, -0.285923749f, -0.0972629488f, 0.228250265f, -0.0190615952f, -0.16080156f, 0.106060624f, 0.18621701f, -0.124633431f, -0.195014656f, 0.31622678f, -0.424731195f, 0.00439882278f, -0.12756598f, 0.474584579f, -0.222385138f, 0.215542495f, 0.0229716301f, 0.133431077f,
+};
+
+#endif // __TOVE_BLUENOISE_TABLE
@@ -78,6 +78,13 @@ typedef enum {
 	TOVE_HOLES_CCW
 } ToveHoles;
 
+typedef enum {
+	TOVE_TRIANGULATOR_AUTO,
+	TOVE_TRIANGULATOR_EC,
+	TOVE_TRIANGULATOR_MONO,
+	TOVE_TRIANGULATOR_OPT
+} ToveTriangulator;
+
 typedef enum {
 	TOVE_HANDLE_FREE,
 	TOVE_HANDLE_ALIGNED
@@ -181,6 +188,13 @@ typedef struct {
 	float spread;
 } ToveDither;
 
+typedef enum {
+	// nanosvg's vertical subsampling.
+	TOVE_RASTERIZE_SUBSAMPLED = 0,
+	// exact signed area per pixel, like font rasterizers.
+	TOVE_RASTERIZE_ANALYTIC = 1
+} ToveRasterizeEngine;
+
 typedef struct {
 	float tessTolerance;
 	float distTolerance;
@@ -193,6 +207,10 @@ typedef struct {
 		} noise;
 		TovePaletteRef palette;
 	} quality;
+	ToveRasterizeEngine engine;
+	// vertical samples per pixel of TOVE_RASTERIZE_SUBSAMPLED, a divisor of
+	// 255. 0 keeps nanosvg's 5.
+	int subsamples;
 } ToveRasterizeSettings;
 
 typedef struct {
@@ -12,13 +12,17 @@
 #include "mesh.h"
 #include "../common.h"
 #include "../path.h"
+#include "triangulate.h"
 #if TOVE_DEBUG
 #include <iostream>
 #endif
 
 BEGIN_TOVE_NAMESPACE
 
-inline void triangulationFailed(const std::list<ToveTPPLPoly> &polys) {
+// above this many points, auto triangulation switches to monotone partitioning.
+#define TOVE_MONOTONE_MIN_POINTS 256
+
+inline void triangulationFailed() {
 	tove::report::warn("triangulation failed.");
 }
 
@@ -134,13 +138,15 @@ void Submesh::cache(bool keyframe) {
 void Submesh::addClipperPaths(
 		const ClipperPaths &paths,
 		float scale,
-		ToveHoles holes) {
+		ToveHoles holes,
+		ToveTriangulator triangulator) {
+
+	TriangulationArena &arena = TriangulationArena::local();
+	arena.clear();
 
-	std::list<ToveTPPLPoly> polys;
 	for (const ClipperPath &path : paths) {
 		const int n = path.size();
-		ToveTPPLPoly poly;
-		poly.Init(n);
+		TPPLPoint *poly = arena.addPolygon(n);
 		int index = mMesh->getVertexCount();
 		auto v = vertices(index, n);
 
@@ -159,18 +165,58 @@ void Submesh::addClipperPaths(
 			poly[j].id = index++;
 		}
 
-		applyHoles(holes, poly);
-		polys.push_back(poly);
+		arena.applyHoles(holes);
 	}
 
-	ToveTPPLPartition partition;
-	std::list<ToveTPPLPoly> triangles;
-	if (partition.Triangulate_EC(&polys, &triangles) == 0) {
-		triangulationFailed(polys);
+	if (triangulator == TOVE_TRIANGULATOR_AUTO) {
+		// ear clipping is quadratic, but gives nicer triangles on small fills.
+		triangulator = arena.getPointCount() > TOVE_MONOTONE_MIN_POINTS ?
+			TOVE_TRIANGULATOR_MONO : TOVE_TRIANGULATOR_EC;
+	}
+
+	if (triangulator != TOVE_TRIANGULATOR_EC) {
+		std::list<ToveTPPLPoly> polys;
+		arena.copyPolygons(polys);
+
+		ToveTPPLPartition partition;
+		std::list<ToveTPPLPoly> triangles;
+		bool success;
+
+		if (triangulator == TOVE_TRIANGULATOR_MONO) {
+			success = partition.Triangulate_MONO(&polys, &triangles) != 0;
+		} else {
+			// Triangulate_OPT does not know about holes.
+			std::list<ToveTPPLPoly> outlines;
+			success = partition.RemoveHoles(&polys, &outlines) != 0;
+			for (auto i = outlines.begin(); success && i != outlines.end(); i++) {
+				success = partition.Triangulate_OPT(&*i, &triangles) != 0;
+			}
+		}
+
+		if (success) {
+			mTriangles.add(triangles);
+			return;
+		}
+
+		// degenerate input can trip up the other algorithms, so
+		// still give ear clipping a chance.
+	}
+
+	const int32_t triangleCount = arena.removeHoles() ? arena.countTriangles() : -1;
+	if (triangleCount < 0) {
+		triangulationFailed();
+		return;
+	}
+	if (triangleCount == 0) {
 		return;
 	}
 
-	mTriangles.add(triangles);
+	const int32_t indexCount = mTriangles.getIndexCount();
+	ToveVertexIndex *indices = mTriangles.allocate(TRIANGLES_LIST, triangleCount);
+	if (!indices || !arena.triangulate(indices)) {
+		mTriangles.truncate(indexCount);
+		triangulationFailed();
+	}
 }
 
 void Submesh::clearTriangles() {
@@ -401,7 +447,7 @@ void Submesh::triangulateFixedResolutionFill(
 
 		//if (partition.Triangulate_MONO(&p, &triangles) == 0) {
 		if (partition.Triangulate_EC(&p, &triangles) == 0) {
-			triangulationFailed(polys);
+			triangulationFailed();
 			continue;
 		}
 		//}
@@ -421,7 +467,10 @@ void AbstractMesh::setFillColor(
 }
 
 Submesh *AbstractMesh::submesh(const PathRef &path, int line) {
-	const SubmeshId id = path->getIndex() * 2 + line;
+	return submesh(path->getIndex() * 2 + line);
+}
+
+Submesh *AbstractMesh::submesh(SubmeshId id) {
 	const auto i = mSubmeshes.find(id);
 	if (i != mSubmeshes.end()) {
 		return i->second;
@@ -432,6 +481,37 @@ Submesh *AbstractMesh::submesh(const PathRef &path, int line) {
 	}
 }
 
+void AbstractMesh::append(const AbstractMesh &mesh) {
+	assert(mStride == mesh.mStride);
+
+	const int32_t n = mesh.mVertexCount;
+	if (n < 1) {
+		return;
+	}
+
+	const int32_t i0 = mVertexCount;
+	reserve(i0 + n);
+	std::memcpy(
+		static_cast<uint8_t*>(mVertices) + i0 * mStride,
+		mesh.mVertices,
+		n * mStride);
+
+	std::vector<ToveVertexIndex> triangles;
+	for (auto entry : mesh.mSubmeshes) {
+		const Submesh *m = entry.second;
+		if (m->getIndexMode() != TRIANGLES_LIST) {
+			tove::report::warn("cannot append triangle strips.");
+			continue;
+		}
+		triangles.resize(m->getIndexCount());
+		if (triangles.empty()) {
+			continue;
+		}
+		m->copyIndexData(triangles.data(), triangles.size());
+		submesh(entry.first)->addTriangles(triangles, i0);
+	}
+}
+
 Mesh::Mesh() :
 		AbstractMesh(sizeof(float) * 2) {
 }
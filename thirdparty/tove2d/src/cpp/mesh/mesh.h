@@ -73,6 +73,10 @@ public:
 		return mVertexCount;
 	}
 
+	inline const std::map<SubmeshId, Submesh*> &getSubmeshes() const {
+		return mSubmeshes;
+	}
+
 	inline void copyVertexData(void *buffer, size_t bufferByteSize) {
 		const size_t size = mStride * mVertexCount;
 		assert(bufferByteSize == size);
@@ -80,6 +84,11 @@ public:
 	}
 
 	Submesh *submesh(const PathRef &path, int line);
+	Submesh *submesh(SubmeshId id);
+
+	// appends the vertices and triangles of another mesh with the same
+	// vertex layout; triangle indices are rebased to the new vertices.
+	void append(const AbstractMesh &mesh);
 };
 
 class Submesh {
@@ -109,6 +118,13 @@ public:
 	void cache(bool keyframe);
 	void clearTriangles();
 
+	inline void addTriangles(
+		const std::vector<ToveVertexIndex> &triangles,
+		ToveVertexIndex i0) {
+
+		mTriangles.add(triangles, i0);
+	}
+
 	inline Vertices vertices(int from, int n) {
 		return mMesh->vertices(from, n);
 	}
@@ -117,7 +133,8 @@ public:
 	void addClipperPaths(
 		const ClipperPaths &paths,
 		float scale,
-		ToveHoles holes);
+		ToveHoles holes,
+		ToveTriangulator triangulator = TOVE_TRIANGULATOR_AUTO);
 
 	// used by fixed flattener.
 	void triangulateFixedResolutionFill(
@@ -100,8 +100,10 @@ static void clip(
 }
 
 AdaptiveTesselator::AdaptiveTesselator(
-	AbstractAdaptiveFlattener *flattener) :
-	flattener(flattener) {
+	AbstractAdaptiveFlattener *flattener,
+	ToveTriangulator triangulator) :
+	flattener(flattener),
+	triangulator(triangulator) {
 }
 
 AdaptiveTesselator::~AdaptiveTesselator() {
@@ -146,7 +148,7 @@ void AdaptiveTesselator::renderStrokes(
 			paths.insert(paths.end(), holes.begin(), holes.end());
 			clip(graphics, path, paths);
 			submesh->addClipperPaths(
-				paths, flattener->getClipperScale(), TOVE_HOLES_CW);
+				paths, flattener->getClipperScale(), TOVE_HOLES_CW, triangulator);
 		}
 		holes.clear();
 	}
@@ -183,7 +185,7 @@ ToveMeshUpdateFlags AdaptiveTesselator::pathToMesh(
 		const int index0 = fill->getVertexCount();
  		// ClipperLib always gives us TOVE_HOLES_CW.
  		fill->submesh(path, 0)->addClipperPaths(
-			t.fill, flattener->getClipperScale(), TOVE_HOLES_CW);
+			t.fill, flattener->getClipperScale(), TOVE_HOLES_CW, triangulator);
 		fill->setFillColor(path, index0, fill->getVertexCount() - index0);
 	}
 
@@ -63,10 +63,12 @@ private:
 		Submesh *submesh);
 
 	AbstractAdaptiveFlattener *flattener;
+	ToveTriangulator triangulator;
 
 public:
 	AdaptiveTesselator(
-		AbstractAdaptiveFlattener *flattener);
+		AbstractAdaptiveFlattener *flattener,
+		ToveTriangulator triangulator = TOVE_TRIANGULATOR_AUTO);
 
 	virtual ~AdaptiveTesselator();
 
@@ -82,6 +82,11 @@ public:
 		mSize = 0;
 	}
 
+	// drops indices beyond the given count, e.g. after a failed triangulation.
+	inline void truncate(int32_t size) {
+		mSize = std::min(mSize, size);
+	}
+
 	inline size_t size() const {
 		return mSize;
 	}
@@ -103,7 +108,10 @@ public:
 };
 
 struct Triangulation {
-	inline Triangulation(ToveTrianglesMode mode) : triangles(mode) {
+	inline Triangulation(ToveTrianglesMode mode) :
+		triangles(mode),
+		useCount(0),
+		keyframe(false) {
 	}
 
 	inline Triangulation(const std::list<ToveTPPLPoly> &convex) :
@@ -201,6 +209,12 @@ public:
 		}
 	}
 
+	inline void truncate(int32_t indexCount) {
+		if (current < (int32_t)triangulations.size()) {
+			triangulations[current]->triangles.truncate(indexCount);
+		}
+	}
+
 	inline ToveTrianglesMode getIndexMode() const {
 		if (current < (int32_t)triangulations.size()) {
 			return triangulations[current]->triangles.mode();
@@ -0,0 +1,393 @@
+/*
+ * TÖVE - Animated vector graphics for LÖVE.
+ * https://github.com/poke1024/tove2d
+ *
+ * Copyright (c) 2018, Bernhard Liebl
+ *
+ * Distributed under the MIT license. See LICENSE file for details.
+ *
+ * All rights reserved.
+ */
+
+#include "triangulate.h"
+#include "triangles.h"
+
+#include <algorithm>
+#include <cmath>
+
+BEGIN_TOVE_NAMESPACE
+
+// the geometric predicates below follow polypartition, so that results stay
+// identical to ToveTPPLPartition::Triangulate_EC.
+
+inline bool isConvex(const TPPLPoint &p1, const TPPLPoint &p2, const TPPLPoint &p3) {
+	return (p3.y - p1.y) * (p2.x - p1.x) - (p3.x - p1.x) * (p2.y - p1.y) > 0;
+}
+
+inline bool isInside(const TPPLPoint &p1, const TPPLPoint &p2, const TPPLPoint &p3, const TPPLPoint &p) {
+	return !isConvex(p1, p, p2) && !isConvex(p2, p, p3) && !isConvex(p3, p, p1);
+}
+
+inline bool inCone(const TPPLPoint &p1, const TPPLPoint &p2, const TPPLPoint &p3, const TPPLPoint &p) {
+	if (isConvex(p1, p2, p3)) {
+		return isConvex(p1, p2, p) && isConvex(p2, p3, p);
+	} else {
+		return isConvex(p1, p2, p) || isConvex(p2, p3, p);
+	}
+}
+
+inline bool samePoint(const TPPLPoint &a, const TPPLPoint &b) {
+	return a.x == b.x && a.y == b.y;
+}
+
+inline TPPLPoint normalize(const TPPLPoint &p) {
+	const tppl_float n = std::sqrt(p.x * p.x + p.y * p.y);
+	TPPLPoint r;
+	if (n != 0) {
+		r.x = p.x / n;
+		r.y = p.y / n;
+	} else {
+		r.x = 0;
+		r.y = 0;
+	}
+	return r;
+}
+
+static bool intersects(const TPPLPoint &p11, const TPPLPoint &p12, const TPPLPoint &p21, const TPPLPoint &p22) {
+	if (samePoint(p11, p21) || samePoint(p11, p22) || samePoint(p12, p21) || samePoint(p12, p22)) {
+		return false;
+	}
+
+	const tppl_float v1x = p12.y - p11.y;
+	const tppl_float v1y = p11.x - p12.x;
+	const tppl_float v2x = p22.y - p21.y;
+	const tppl_float v2y = p21.x - p22.x;
+
+	const tppl_float dot21 = (p21.x - p11.x) * v1x + (p21.y - p11.y) * v1y;
+	const tppl_float dot22 = (p22.x - p11.x) * v1x + (p22.y - p11.y) * v1y;
+	const tppl_float dot11 = (p11.x - p21.x) * v2x + (p11.y - p21.y) * v2y;
+	const tppl_float dot12 = (p12.x - p21.x) * v2x + (p12.y - p21.y) * v2y;
+
+	return dot11 * dot12 <= 0 && dot21 * dot22 <= 0;
+}
+
+TPPLPoint *TriangulationArena::addPolygon(int32_t n) {
+	const int32_t offset = mPoints.size();
+	grow(mPoints, offset + n);
+
+	Polygon polygon;
+	polygon.offset = offset;
+	polygon.size = n;
+	polygon.hole = false;
+	grow(mPolygons, mPolygons.size() + 1);
+	mPolygons.back() = polygon;
+
+	return &mPoints[offset];
+}
+
+void TriangulationArena::applyHoles(ToveHoles holes) {
+	assert(!mPolygons.empty());
+	Polygon &polygon = mPolygons.back();
+	TPPLPoint *points = &mPoints[polygon.offset];
+	const int32_t n = polygon.size;
+
+	auto orientation = [points, n] () {
+		tppl_float area = 0;
+		for (int32_t i = 0; i < n; i++) {
+			const TPPLPoint &p1 = points[i];
+			const TPPLPoint &p2 = points[i + 1 == n ? 0 : i + 1];
+			area += p1.x * p2.y - p1.y * p2.x;
+		}
+		return area > 0 ? TPPL_CCW : (area < 0 ? TPPL_CW : 0);
+	};
+
+	switch (holes) {
+		case TOVE_HOLES_NONE:
+			if (orientation() == TPPL_CW) {
+				std::reverse(points, points + n);
+			}
+			break;
+		case TOVE_HOLES_CW:
+			if (orientation() == TPPL_CW) {
+				polygon.hole = true;
+			}
+			break;
+		case TOVE_HOLES_CCW:
+			std::reverse(points, points + n);
+			if (orientation() == TPPL_CW) {
+				polygon.hole = true;
+			}
+			break;
+	}
+}
+
+void TriangulationArena::copyPolygons(std::list<ToveTPPLPoly> &polys) const {
+	for (const Polygon &polygon : mPolygons) {
+		ToveTPPLPoly poly;
+		poly.Init(polygon.size);
+		std::copy(
+			mPoints.begin() + polygon.offset,
+			mPoints.begin() + polygon.offset + polygon.size,
+			poly.GetPoints());
+		poly.SetHole(polygon.hole);
+		polys.push_back(poly);
+	}
+}
+
+bool TriangulationArena::removeHoles() {
+	bool hasHoles = false;
+	for (const Polygon &polygon : mPolygons) {
+		if (polygon.hole) {
+			hasHoles = true;
+			break;
+		}
+	}
+
+	if (!hasHoles) {
+		mOutput = mPoints.data();
+		mOutputPolygons = mPolygons.data();
+		mOutputPolygonCount = mPolygons.size();
+		return true;
+	}
+
+	grow(mMerged, mPoints.size());
+	std::copy(mPoints.begin(), mPoints.end(), mMerged.begin());
+	grow(mMergedPolygons, mPolygons.size());
+	std::copy(mPolygons.begin(), mPolygons.end(), mMergedPolygons.begin());
+
+	const auto point = [this] (const Polygon &polygon, int32_t i) -> const TPPLPoint& {
+		return mMerged[polygon.offset + (i % polygon.size)];
+	};
+
+	while (true) {
+		// find the hole point with the largest x.
+		int32_t hole = -1;
+		int32_t holePoint = 0;
+		for (int32_t k = 0; k < (int32_t)mMergedPolygons.size(); k++) {
+			const Polygon &polygon = mMergedPolygons[k];
+			if (!polygon.hole) {
+				continue;
+			}
+			if (hole < 0) {
+				hole = k;
+				holePoint = 0;
+			}
+			for (int32_t i = 0; i < polygon.size; i++) {
+				if (point(polygon, i).x > point(mMergedPolygons[hole], holePoint).x) {
+					hole = k;
+					holePoint = i;
+				}
+			}
+		}
+		if (hole < 0) {
+			break;
+		}
+		const TPPLPoint holeP = point(mMergedPolygons[hole], holePoint);
+
+		bool found = false;
+		TPPLPoint best;
+		int32_t outline = -1;
+		int32_t outlinePoint = 0;
+
+		for (int32_t k = 0; k < (int32_t)mMergedPolygons.size(); k++) {
+			const Polygon &polygon = mMergedPolygons[k];
+			if (polygon.hole) {
+				continue;
+			}
+			for (int32_t i = 0; i < polygon.size; i++) {
+				const TPPLPoint &p = point(polygon, i);
+				if (p.x <= holeP.x) {
+					continue;
+				}
+				if (!inCone(point(polygon, i + polygon.size - 1), p, point(polygon, i + 1), holeP)) {
+					continue;
+				}
+				if (found) {
+					const TPPLPoint v1 = normalize(p - holeP);
+					const TPPLPoint v2 = normalize(best - holeP);
+					if (v2.x > v1.x) {
+						continue;
+					}
+				}
+				bool visible = true;
+				for (int32_t k2 = 0; k2 < (int32_t)mMergedPolygons.size() && visible; k2++) {
+					const Polygon &other = mMergedPolygons[k2];
+					if (other.hole) {
+						continue;
+					}
+					for (int32_t i2 = 0; i2 < other.size; i2++) {
+						if (intersects(holeP, p, point(other, i2), point(other, i2 + 1))) {
+							visible = false;
+							break;
+						}
+					}
+				}
+				if (visible) {
+					found = true;
+					best = p;
+					outline = k;
+					outlinePoint = i;
+				}
+			}
+		}
+
+		if (!found) {
+			return false;
+		}
+
+		const Polygon h = mMergedPolygons[hole];
+		const Polygon o = mMergedPolygons[outline];
+
+		Polygon bridged;
+		bridged.offset = mMerged.size();
+		bridged.size = h.size + o.size + 2;
+		bridged.hole = false;
+		grow(mMerged, bridged.offset + bridged.size);
+
+		int32_t j = bridged.offset;
+		for (int32_t i = 0; i <= outlinePoint; i++) {
+			mMerged[j++] = mMerged[o.offset + i];
+		}
+		for (int32_t i = 0; i <= h.size; i++) {
+			mMerged[j++] = mMerged[h.offset + (i + holePoint) % h.size];
+		}
+		for (int32_t i = outlinePoint; i < o.size; i++) {
+			mMerged[j++] = mMerged[o.offset + i];
+		}
+
+		mMergedPolygons.erase(mMergedPolygons.begin() + std::max(hole, outline));
+		mMergedPolygons.erase(mMergedPolygons.begin() + std::min(hole, outline));
+		grow(mMergedPolygons, mMergedPolygons.size() + 1);
+		mMergedPolygons.back() = bridged;
+	}
+
+	mOutput = mMerged.data();
+	mOutputPolygons = mMergedPolygons.data();
+	mOutputPolygonCount = mMergedPolygons.size();
+	return true;
+}
+
+int32_t TriangulationArena::countTriangles() const {
+	int32_t count = 0;
+	for (int32_t k = 0; k < mOutputPolygonCount; k++) {
+		const int32_t n = mOutputPolygons[k].size;
+		if (n < 3) {
+			return -1;
+		}
+		count += n - 2;
+	}
+	return count;
+}
+
+void TriangulationArena::updateVertex(int32_t i, const TPPLPoint *points, int32_t n) {
+	Vertex &v = mVertices[i];
+	const TPPLPoint &p = points[i];
+	const TPPLPoint &p1 = points[v.previous];
+	const TPPLPoint &p3 = points[v.next];
+
+	v.isConvex = isConvex(p1, p, p3);
+
+	const TPPLPoint vec1 = normalize(p1 - p);
+	const TPPLPoint vec3 = normalize(p3 - p);
+	v.angle = vec1.x * vec3.x + vec1.y * vec3.y;
+
+	v.isEar = v.isConvex;
+	if (v.isEar) {
+		for (int32_t j = 0; j < n; j++) {
+			const TPPLPoint &q = points[j];
+			if (samePoint(q, p) || samePoint(q, p1) || samePoint(q, p3)) {
+				continue;
+			}
+			if (isInside(p1, p, p3, q)) {
+				v.isEar = false;
+				break;
+			}
+		}
+	}
+}
+
+bool TriangulationArena::triangulate(const TPPLPoint *points, int32_t n, ToveVertexIndex *&out) {
+	if (n < 3) {
+		return false;
+	}
+
+	const auto emit = [&out, points] (int32_t a, int32_t b, int32_t c) {
+		*out++ = ToLoveVertexMapIndex(points[a].id);
+		*out++ = ToLoveVertexMapIndex(points[b].id);
+		*out++ = ToLoveVertexMapIndex(points[c].id);
+	};
+
+	if (n == 3) {
+		emit(0, 1, 2);
+		return true;
+	}
+
+	grow(mVertices, n);
+	for (int32_t i = 0; i < n; i++) {
+		Vertex &v = mVertices[i];
+		v.isActive = true;
+		v.previous = i == 0 ? n - 1 : i - 1;
+		v.next = i == n - 1 ? 0 : i + 1;
+	}
+	for (int32_t i = 0; i < n; i++) {
+		updateVertex(i, points, n);
+	}
+
+	for (int32_t i = 0; i < n - 3; i++) {
+		// find the most extruded ear.
+		int32_t ear = -1;
+		for (int32_t j = 0; j < n; j++) {
+			const Vertex &v = mVertices[j];
+			if (!v.isActive || !v.isEar) {
+				continue;
+			}
+			if (ear < 0 || v.angle > mVertices[ear].angle) {
+				ear = j;
+			}
+		}
+		if (ear < 0) {
+			return false;
+		}
+
+		Vertex &v = mVertices[ear];
+		emit(v.previous, ear, v.next);
+
+		v.isActive = false;
+		mVertices[v.previous].next = v.next;
+		mVertices[v.next].previous = v.previous;
+
+		if (i == n - 4) {
+			break;
+		}
+
+		updateVertex(v.previous, points, n);
+		updateVertex(v.next, points, n);
+	}
+
+	for (int32_t i = 0; i < n; i++) {
+		const Vertex &v = mVertices[i];
+		if (v.isActive) {
+			emit(v.previous, i, v.next);
+			break;
+		}
+	}
+
+	return true;
+}
+
+bool TriangulationArena::triangulate(ToveVertexIndex *out) {
+	for (int32_t k = 0; k < mOutputPolygonCount; k++) {
+		const Polygon &polygon = mOutputPolygons[k];
+		if (!triangulate(mOutput + polygon.offset, polygon.size, out)) {
+			return false;
+		}
+	}
+	return true;
+}
+
+TriangulationArena &TriangulationArena::local() {
+	static thread_local TriangulationArena arena;
+	return arena;
+}
+
+END_TOVE_NAMESPACE
@@ -0,0 +1,118 @@
+/*
+ * TÖVE - Animated vector graphics for LÖVE.
+ * https://github.com/poke1024/tove2d
+ *
+ * Copyright (c) 2018, Bernhard Liebl
+ *
+ * Distributed under the MIT license. See LICENSE file for details.
+ *
+ * All rights reserved.
+ */
+
+#ifndef __TOVE_MESH_TRIANGULATE
+#define __TOVE_MESH_TRIANGULATE 1
+
+#include "../common.h"
+
+#include <vector>
+
+BEGIN_TOVE_NAMESPACE
+
+// ear clipping triangulation with the same results as polypartition's
+// Triangulate_EC, but all polygons, hole bridges and clipping state live in
+// contiguous buffers that are reused from one call to the next. once warmed
+// up, triangulating a path does not touch the heap at all; the triangles go
+// straight into the caller's index buffer.
+class TriangulationArena {
+private:
+	struct Polygon {
+		int32_t offset;
+		int32_t size;
+		bool hole;
+	};
+
+	struct Vertex {
+		int32_t previous;
+		int32_t next;
+		bool isActive;
+		bool isConvex;
+		bool isEar;
+		tppl_float angle;
+	};
+
+	std::vector<TPPLPoint> mPoints;
+	std::vector<Polygon> mPolygons;
+
+	// polygons after holes have been bridged into their outlines.
+	std::vector<TPPLPoint> mMerged;
+	std::vector<Polygon> mMergedPolygons;
+	const TPPLPoint *mOutput;
+	const Polygon *mOutputPolygons;
+	int32_t mOutputPolygonCount;
+
+	std::vector<Vertex> mVertices;
+
+	uint64_t mGrowCount;
+
+	template<typename T>
+	inline void grow(std::vector<T> &v, size_t n) {
+		if (n > v.capacity()) {
+			v.reserve(nextpow2(n));
+			mGrowCount++;
+		}
+		v.resize(n);
+	}
+
+	void updateVertex(int32_t i, const TPPLPoint *points, int32_t n);
+	bool triangulate(const TPPLPoint *points, int32_t n, ToveVertexIndex *&out);
+
+public:
+	inline TriangulationArena() :
+		mOutput(nullptr),
+		mOutputPolygons(nullptr),
+		mOutputPolygonCount(0),
+		mGrowCount(0) {
+	}
+
+	inline void clear() {
+		mPoints.clear();
+		mPolygons.clear();
+		mOutput = nullptr;
+		mOutputPolygons = nullptr;
+		mOutputPolygonCount = 0;
+	}
+
+	// returns storage for n points of a new polygon.
+	TPPLPoint *addPolygon(int32_t n);
+
+	// orients the last polygon and marks it as hole, if needed.
+	void applyHoles(ToveHoles holes);
+
+	inline int32_t getPointCount() const {
+		return mPoints.size();
+	}
+
+	// copies the polygons added so far, holes included, for polypartition.
+	void copyPolygons(std::list<ToveTPPLPoly> &polys) const;
+
+	// bridges holes into their enclosing polygons, like RemoveHoles.
+	bool removeHoles();
+
+	// number of triangles triangulate() will write, or -1 on invalid input.
+	int32_t countTriangles() const;
+
+	// writes 3 * countTriangles() indices to out.
+	bool triangulate(ToveVertexIndex *out);
+
+	// number of times one of the buffers had to grow.
+	inline uint64_t getGrowCount() const {
+		return mGrowCount;
+	}
+
+	// one arena per thread, as paths get tesselated on worker threads.
+	static TriangulationArena &local();
+};
+
+END_TOVE_NAMESPACE
+
+#endif // __TOVE_MESH_TRIANGULATE
@@ -15,6 +15,8 @@
 #include <unordered_map>
 
 #include "../thirdparty/tinyxml2/tinyxml2.h"
+#include "../thirdparty/nanosvg/tove/simd.h"
+#include "bluenoise_table.h"
 
 #if TOVE_DEBUG
 #include <iostream>
@@ -33,7 +35,18 @@ BEGIN_TOVE_NAMESPACE
 namespace nsvg {
 
 thread_local NSVGparser *_parser = nullptr;
-thread_local NSVGrasterizer *rasterizer = nullptr;
+// the rasterizer of each thread, with its edge and scanline buffers, lives
+// until the thread exits.
+struct ThreadRasterizer {
+	NSVGrasterizer *rasterizer = nullptr;
+
+	~ThreadRasterizer() {
+		if (rasterizer) {
+			nsvgDeleteRasterizer(rasterizer);
+		}
+	}
+};
+thread_local ThreadRasterizer threadRasterizer;
 thread_local ToveRasterizeSettings defaultSettings = {-1.0f, -1.0f};
 
 // scoping the locale should no longer be necessary.
@@ -242,35 +255,40 @@ NSVGimage *parseSVG(const char *svg, const char *units, float dpi) {
 }
 
 static NSVGrasterizer *ensureRasterizer() {
-	if (!rasterizer) {
-		rasterizer = nsvgCreateRasterizer();
+	if (!threadRasterizer.rasterizer) {
+		threadRasterizer.rasterizer = nsvgCreateRasterizer();
 	}
-	return rasterizer;
+	return threadRasterizer.rasterizer;
 }
 
 const ToveRasterizeSettings *getDefaultRasterizeSettings() {
 
 	if (defaultSettings.tessTolerance < 0.0f) {
-		rasterizer = ensureRasterizer();
+		NSVGrasterizer *rasterizer = ensureRasterizer();
 		if (!rasterizer) {
 			return nullptr;
 		}
 
 		defaultSettings.tessTolerance = rasterizer->tessTol;
 		defaultSettings.distTolerance = rasterizer->distTol;
+		defaultSettings.engine = TOVE_RASTERIZE_SUBSAMPLED;
+		defaultSettings.subsamples = NSVG__SUBSAMPLES;
 	}
 
 	return &defaultSettings;
 }
 
+const float *getBlueNoise(int size) {
+	return size == TOVE_BLUE_NOISE_SIZE ? tove_blue_noise : nullptr;
+}
+
 static NSVGrasterizer *getRasterizer(
 	const ToveRasterizeSettings *settings) {
 
-	rasterizer = ensureRasterizer();
+	NSVGrasterizer *rasterizer = ensureRasterizer();
 	if (!rasterizer) {
 		return nullptr;
 	}
-	// skipping nsvgDeleteRasterizer(rasterizer)
 
 	if (!settings) {
 		settings = getDefaultRasterizeSettings();
@@ -278,6 +296,23 @@ static NSVGrasterizer *getRasterizer(
 
 	rasterizer->tessTol = settings->tessTolerance;
 	rasterizer->distTol = settings->distTolerance;
+	rasterizer->engine = settings->engine;
+	rasterizer->subsamples = settings->subsamples > 0 && 255 % settings->subsamples == 0 ?
+		settings->subsamples : NSVG__SUBSAMPLES;
+	// diffusion always uses the rasterizer's own kernel. ordered dithering
+	// needs a square matrix with a power of 2 as size.
+	const ToveDither &dither = settings->quality.dither;
+	rasterizer->quality = 0;
+	if (dither.type == TOVE_DITHER_DIFFUSION) {
+		rasterizer->quality = 1;
+	} else if (dither.type == TOVE_DITHER_ORDERED && dither.matrix &&
+			dither.matrix_width > 0 && dither.matrix_width == dither.matrix_height &&
+			(dither.matrix_width & (dither.matrix_width - 1)) == 0) {
+		rasterizer->quality = 2;
+		rasterizer->ordered.matrix = dither.matrix;
+		rasterizer->ordered.size = dither.matrix_width;
+		rasterizer->ordered.spread = dither.spread;
+	}
 
 	rasterizer->nedges = 0;
 	rasterizer->npoints = 0;
@@ -447,12 +482,49 @@ bool shapeStrokeBounds(float *bounds, const NSVGshape *shape,
 
 void rasterize(NSVGimage *image, float tx, float ty, float scale,
 	uint8_t* pixels, int width, int height, int stride,
+	const ToveRasterizeSettings *quality, int flags) {
+
+	NSVGrasterizer *rasterizer = getRasterizer(quality);
+
+	nsvgRasterizeFlags(rasterizer, image, tx, ty, scale,
+			pixels, width, height, stride, flags);
+}
+
+NSVGrasterJob *beginRasterize(NSVGimage *image, float tx, float ty, float scale,
+	uint8_t* pixels, int width, int height, int stride,
+	const ToveRasterizeSettings *quality, int flags) {
+
+	NSVGrasterizer *rasterizer = getRasterizer(quality);
+	if (!rasterizer) {
+		return nullptr;
+	}
+
+	NSVGrasterJob *job = nsvgCreateRasterJob(rasterizer, image, tx, ty, scale,
+		pixels, width, height, stride, flags);
+	if (job && !nsvgRasterJobIsBandable(job)) {
+		nsvgDeleteRasterJob(job);
+		return nullptr;
+	}
+	return job;
+}
+
+void rasterizeBand(NSVGrasterJob *job, int y0, int y1,
 	const ToveRasterizeSettings *quality) {
 
+	// every thread works on its own rasterizer, i.e. its own edge pool
+	// and scanline buffer.
 	NSVGrasterizer *rasterizer = getRasterizer(quality);
+	if (rasterizer) {
+		nsvgRasterizeBand(rasterizer, job, y0, y1);
+	}
+}
+
+void defringeBand(NSVGrasterJob *job, int y0, int y1) {
+	nsvgDefringeBand(job, y0, y1);
+}
 
-	nsvgRasterize(rasterizer, image, tx, ty, scale,
-			pixels, width, height, stride);
+void endRasterize(NSVGrasterJob *job) {
+	nsvgDeleteRasterJob(job);
 }
 
 Transform::Transform() {
@@ -18,6 +18,8 @@ BEGIN_TOVE_NAMESPACE
 
 #define NSVG_CLIP_PATHS 1
 
+struct NSVGrasterJob;
+
 namespace nsvg {
 
 NSVGimage *parseSVG(const char *svg, const char *units, float dpi);
@@ -99,12 +101,32 @@ struct CachedPaint {
 
 const ToveRasterizeSettings *getDefaultRasterizeSettings();
 
+// a blue noise threshold matrix for TOVE_DITHER_ORDERED, size * size values
+// in [-0.5, 0.5]. it is a precomputed table, see bluenoise_table.h, so
+// this is nullptr for any size but TOVE_BLUE_NOISE_SIZE (32).
+const float *getBlueNoise(int size);
+
 bool shapeStrokeBounds(float *bounds, const NSVGshape *shape,
 	float scale, const ToveRasterizeSettings *settings);
 
+// flags are NSVGrasterFlags.
 void rasterize(NSVGimage *image, float tx, float ty, float scale,
 	uint8_t *pixels, int width, int height, int stride,
+	const ToveRasterizeSettings *settings, int flags = 0);
+
+// banded rasterization. beginRasterize() flattens and sorts all edges up
+// front; after that, rasterizeBand() can run on any number of threads for
+// disjoint row ranges. once all bands are done, defringeBand() needs to run
+// over all rows (again in parallel, if wanted) before the pixels are final.
+// the result is the same as that of rasterize(). returns nullptr if the
+// image cannot be split into bands (i.e. if it uses dithered gradients).
+NSVGrasterJob *beginRasterize(NSVGimage *image, float tx, float ty, float scale,
+	uint8_t *pixels, int width, int height, int stride,
+	const ToveRasterizeSettings *settings, int flags = 0);
+void rasterizeBand(NSVGrasterJob *job, int y0, int y1,
 	const ToveRasterizeSettings *settings);
+void defringeBand(NSVGrasterJob *job, int y0, int y1);
+void endRasterize(NSVGrasterJob *job);
 
 class Transform {
 private:
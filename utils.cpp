@@ -2,8 +2,11 @@
 /*  utils.cpp                                                            */
 /*************************************************************************/
 
+#include "core/hashfuncs.h"
+#include "core/os/os.h"
 #include "core/string_builder.h"
 #include "scene/resources/surface_tool.h"
+#include "servers/visual_server.h"
 
 #include "tove2d/src/cpp/mesh/mesh.h"
 #include "tove2d/src/cpp/mesh/meshifier.h"
@@ -22,60 +25,616 @@ tove::PathRef new_transformed_path(const tove::PathRef &p_tove_path, const Trans
 	return tove_path;
 }
 
-Ref<ShaderMaterial> copy_mesh(
-		Ref<ArrayMesh> &p_mesh,
-		tove::MeshRef &p_tove_mesh,
-		const tove::GraphicsRef &p_graphics,
-		Ref<Texture> &r_texture,
-		bool p_spatial) {
+const float *get_srgb_to_linear_table() {
+	struct Table {
+		float linear[256];
+		Table() {
+			for (int i = 0; i < 256; i++) {
+				linear[i] = Color(i / 255.0, 0, 0).to_linear().r;
+			}
+		}
+	};
+	static const Table table;
+	return table.linear;
+}
 
-	const int n = p_tove_mesh->getVertexCount();
+static _FORCE_INLINE_ bool fits_half_float(real_t p_x, real_t p_y) {
+	return Math::abs(p_x) <= VG_HALF_FLOAT_MAX_EXTENT && Math::abs(p_y) <= VG_HALF_FLOAT_MAX_EXTENT;
+}
+
+static uint32_t drop_vertex_compression(uint32_t p_compress_flags) {
+	WARN_PRINT_ONCE("Vector graphics mesh too large for half float positions, uploading full floats.");
+	return p_compress_flags & ~Mesh::ARRAY_COMPRESS_VERTEX;
+}
+
+uint32_t fit_compress_flags(uint32_t p_compress_flags, const PoolVector3Array &p_vertices) {
+	if (!(p_compress_flags & Mesh::ARRAY_COMPRESS_VERTEX)) {
+		return p_compress_flags;
+	}
+	PoolVector3Array::Read r = p_vertices.read();
+	for (int i = 0; i < p_vertices.size(); i++) {
+		if (!fits_half_float(r[i].x, r[i].y)) {
+			return drop_vertex_compression(p_compress_flags);
+		}
+	}
+	return p_compress_flags;
+}
+
+#define VG_MESH_POSITION_TRANSFORM "_vg_position_transform"
+
+Transform2D encode_mesh_positions(PoolVector2Array &r_vertices, real_t p_margin) {
+	const int n = r_vertices.size();
 	if (n < 1) {
-		return Ref<ShaderMaterial>();
+		return Transform2D();
 	}
 
-	const bool isPaintMesh = std::dynamic_pointer_cast<tove::PaintMesh>(p_tove_mesh).get() != nullptr;
+	PoolVector2Array::Write w = r_vertices.write();
+	Rect2 bounds(w[0], Size2());
+	for (int i = 1; i < n; i++) {
+		bounds.expand_to(w[i]);
+	}
 
-	const int stride = isPaintMesh ? sizeof(float) * 3 : sizeof(float) * 2 + 4;
-	const int size = n * stride;
+	// one scale for both axes, so the transform stays a similarity.
+	const Vector2 center = bounds.position + bounds.size * 0.5;
+	const real_t size = MAX(bounds.size.x, bounds.size.y);
+	const real_t extent = MAX(size * (0.5 + p_margin), CMP_EPSILON);
+	for (int i = 0; i < n; i++) {
+		w[i] = (w[i] - center) / extent;
+	}
 
-	Vector<uint8_t> vvertices;
-	vvertices.resize(size);
-	p_tove_mesh->copyVertexData(vvertices.ptrw(), size);
+	return Transform2D(extent, 0, 0, extent, center.x, center.y);
+}
 
-	const int index_count = p_tove_mesh->getIndexCount();
-	Vector<ToveVertexIndex> vindices;
-	vindices.resize(index_count);
-	p_tove_mesh->copyIndexData(vindices.ptrw(), index_count);
+Transform2D get_mesh_position_transform(const Ref<ArrayMesh> &p_mesh) {
+	if (p_mesh.is_null() || !p_mesh->has_meta(VG_MESH_POSITION_TRANSFORM)) {
+		return Transform2D();
+	}
+	return p_mesh->get_meta(VG_MESH_POSITION_TRANSFORM);
+}
+
+void set_mesh_position_transform(Ref<ArrayMesh> &p_mesh, const Transform2D &p_transform) {
+	if (p_transform == Transform2D()) {
+		if (p_mesh->has_meta(VG_MESH_POSITION_TRANSFORM)) {
+			p_mesh->remove_meta(VG_MESH_POSITION_TRANSFORM);
+		}
+	} else {
+		p_mesh->set_meta(VG_MESH_POSITION_TRANSFORM, p_transform);
+	}
+}
+
+static Transform position_transform_3d(const Transform2D &p_transform) {
+	const Vector2 &x = p_transform.elements[0];
+	const Vector2 &y = p_transform.elements[1];
+	const Vector2 &o = p_transform.elements[2];
+	return Transform(Basis(x.x, y.x, 0, x.y, y.y, 0, 0, 0, 1), Vector3(o.x, o.y, 0));
+}
+
+AABB mesh_aabb_to_positions(const Ref<ArrayMesh> &p_mesh, const AABB &p_aabb) {
+	return position_transform_3d(get_mesh_position_transform(p_mesh)).xform(p_aabb);
+}
+
+AABB positions_aabb_to_mesh(const Ref<ArrayMesh> &p_mesh, const AABB &p_aabb) {
+	return position_transform_3d(get_mesh_position_transform(p_mesh)).affine_inverse().xform(p_aabb);
+}
+
+void draw_vg_mesh(CanvasItem *p_canvas_item, const Ref<ArrayMesh> &p_mesh, const Ref<Texture> &p_texture) {
+	const Transform2D transform = get_mesh_position_transform(p_mesh);
+	if (transform == Transform2D()) {
+		p_canvas_item->draw_mesh(p_mesh, p_texture, Ref<Texture>());
+		return;
+	}
+	// a transform command, unlike the transform argument of draw_mesh(),
+	// also goes into the bounding rect of the canvas item.
+	p_canvas_item->draw_set_transform_matrix(transform);
+	p_canvas_item->draw_mesh(p_mesh, p_texture, Ref<Texture>());
+	p_canvas_item->draw_set_transform_matrix(Transform2D());
+}
+
+static _FORCE_INLINE_ uint64_t hash_float(float p_value, uint64_t p_hash) {
+	uint32_t bits;
+	memcpy(&bits, &p_value, sizeof(bits));
+	return hash_djb2_one_64(bits, p_hash);
+}
+
+static uint64_t hash_paint(const tove::NSVGpaint &p_paint, uint64_t p_hash) {
+	p_hash = hash_djb2_one_64(p_paint.type, p_hash);
+
+	switch (p_paint.type) {
+		case tove::NSVG_PAINT_COLOR: {
+			p_hash = hash_djb2_one_64(p_paint.color, p_hash);
+		} break;
+		case tove::NSVG_PAINT_LINEAR_GRADIENT:
+		case tove::NSVG_PAINT_RADIAL_GRADIENT: {
+			const tove::NSVGgradient *gradient = p_paint.gradient;
+			for (int i = 0; i < 6; i++) {
+				p_hash = hash_float(gradient->xform[i], p_hash);
+			}
+			p_hash = hash_djb2_one_64(gradient->spread, p_hash);
+			p_hash = hash_float(gradient->fx, p_hash);
+			p_hash = hash_float(gradient->fy, p_hash);
+			p_hash = hash_djb2_one_64(gradient->nstops, p_hash);
+			for (int i = 0; i < gradient->nstops; i++) {
+				p_hash = hash_djb2_one_64(gradient->stops[i].color, p_hash);
+				p_hash = hash_float(gradient->stops[i].offset, p_hash);
+			}
+		} break;
+	}
+
+	return p_hash;
+}
+
+uint64_t hash_transform(const Transform2D &p_transform, uint64_t p_hash) {
+	for (int i = 0; i < 3; i++) {
+		p_hash = hash_float(p_transform.elements[i].x, p_hash);
+		p_hash = hash_float(p_transform.elements[i].y, p_hash);
+	}
+	return p_hash;
+}
+
+uint64_t tove_path_fingerprint(const tove::PathRef &p_tove_path, uint64_t p_hash) {
+	const tove::NSVGshape *shape = p_tove_path->getNSVG();
+
+	p_hash = hash_djb2_one_64(shape->flags, p_hash);
+	p_hash = hash_djb2_one_64(shape->fillRule, p_hash);
+	// whether fill and line get tesselated at all depends on the paint type.
+	p_hash = hash_djb2_one_64(shape->fill.type, p_hash);
+	p_hash = hash_djb2_one_64(shape->stroke.type, p_hash);
+
+	p_hash = hash_float(shape->strokeWidth, p_hash);
+	p_hash = hash_djb2_one_64(shape->strokeLineJoin, p_hash);
+	p_hash = hash_djb2_one_64(shape->strokeLineCap, p_hash);
+	p_hash = hash_float(shape->miterLimit, p_hash);
+	p_hash = hash_float(shape->strokeDashOffset, p_hash);
+	p_hash = hash_djb2_one_64(shape->strokeDashCount, p_hash);
+	for (int i = 0; i < shape->strokeDashCount; i++) {
+		p_hash = hash_float(shape->strokeDashArray[i], p_hash);
+	}
+
+	for (const tove::NSVGpath *path = shape->paths; path; path = path->next) {
+		p_hash = hash_djb2_one_64(path->closed, p_hash);
+		p_hash = hash_djb2_one_64(path->npts, p_hash);
+		const int n = path->npts * 2;
+		for (int i = 0; i < n; i++) {
+			p_hash = hash_float(path->pts[i], p_hash);
+		}
+	}
+
+	return p_hash;
+}
+
+uint64_t tove_paint_fingerprint(const tove::PathRef &p_tove_path, uint64_t p_hash) {
+	const tove::NSVGshape *shape = p_tove_path->getNSVG();
+
+	p_hash = hash_float(shape->opacity, p_hash);
+	p_hash = hash_paint(shape->fill, p_hash);
+	p_hash = hash_paint(shape->stroke, p_hash);
+
+	return p_hash;
+}
+
+static uint64_t hash_paint_alpha(const tove::NSVGpaint &p_paint, uint64_t p_hash) {
+	switch (p_paint.type) {
+		case tove::NSVG_PAINT_COLOR: {
+			p_hash = hash_djb2_one_64(p_paint.color >> 24, p_hash);
+		} break;
+		case tove::NSVG_PAINT_LINEAR_GRADIENT:
+		case tove::NSVG_PAINT_RADIAL_GRADIENT: {
+			// masks of gradients take the alpha of the first stop.
+			const tove::NSVGgradient *gradient = p_paint.gradient;
+			p_hash = hash_djb2_one_64(gradient->nstops > 0 ? gradient->stops[0].color >> 24 : 0, p_hash);
+		} break;
+	}
+
+	return p_hash;
+}
+
+uint64_t tove_paint_alpha_fingerprint(const tove::PathRef &p_tove_path, uint64_t p_hash) {
+	const tove::NSVGshape *shape = p_tove_path->getNSVG();
+
+	p_hash = hash_float(shape->opacity, p_hash);
+	p_hash = hash_paint_alpha(shape->fill, p_hash);
+	p_hash = hash_paint_alpha(shape->stroke, p_hash);
+
+	return p_hash;
+}
+
+// the flat meshes produced by tove are already indexed and share one
+// normal and tangent, so we write them straight into the mesh arrays.
+static void copy_arrays_direct(
+		Ref<ArrayMesh> &p_mesh,
+		const Vector<uint8_t> &p_vertices,
+		const int p_stride,
+		const int p_vertex_count,
+		const Vector<ToveVertexIndex> &p_indices,
+		const PoolVector2Array &p_uvs,
+		bool p_paint_mesh,
+		bool p_spatial,
+		uint32_t p_compress_flags) {
+
+	const int n = p_vertex_count;
+	const int index_count = p_indices.size();
+	if (index_count < 3) {
+		return;
+	}
+
+	Variant varr;
+	if (p_compress_flags & Mesh::ARRAY_FLAG_USE_2D_VERTICES) {
+		// a 2d vertex array is what makes VisualServer drop the z coordinate.
+		PoolVector2Array varr2;
+		ERR_FAIL_COND(varr2.resize(n) != OK);
+		{
+			PoolVector2Array::Write w = varr2.write();
+			const uint8_t *src = p_vertices.ptr();
+			for (int i = 0; i < n; i++) {
+				w[i] = tove_vertex_to_vector2((const float *)(src + i * p_stride));
+			}
+		}
+		if (!p_paint_mesh && is_bounds_relative(p_compress_flags)) {
+			set_mesh_position_transform(p_mesh, encode_mesh_positions(varr2));
+		}
+		varr = varr2;
+	} else {
+		PoolVector3Array varr3;
+		ERR_FAIL_COND(varr3.resize(n) != OK);
+		{
+			PoolVector3Array::Write w = varr3.write();
+			const uint8_t *src = p_vertices.ptr();
+			for (int i = 0; i < n; i++) {
+				w[i] = tove_vertex_to_vector3((const float *)(src + i * p_stride));
+			}
+		}
+		varr = varr3;
+	}
+
+	PoolIntArray iarr;
+	ERR_FAIL_COND(iarr.resize(index_count) != OK);
+	{
+		PoolIntArray::Write w = iarr.write();
+		const ToveVertexIndex *src = p_indices.ptr();
+		for (int i = 0; i < index_count; i++) {
+			w[i] = src[i];
+		}
+	}
+
+	Array arr;
+	ERR_FAIL_COND(arr.resize(Mesh::ARRAY_MAX) != OK);
+	arr[Mesh::ARRAY_VERTEX] = varr;
+	arr[Mesh::ARRAY_INDEX] = iarr;
+
+	if (!p_paint_mesh) {
+		PoolColorArray carr;
+		ERR_FAIL_COND(carr.resize(n) != OK);
+		{
+			PoolColorArray::Write w = carr.write();
+			const uint8_t *src = p_vertices.ptr() + 2 * sizeof(float);
+			for (int i = 0; i < n; i++) {
+				w[i] = tove_color_to_color(src + i * p_stride);
+			}
+		}
+		arr[Mesh::ARRAY_COLOR] = carr;
+	}
+
+	if (p_uvs.size() > 0) {
+		arr[Mesh::ARRAY_TEX_UV] = p_uvs;
+	}
+
+	if (p_spatial) {
+		PoolVector3Array normals;
+		ERR_FAIL_COND(normals.resize(n) != OK);
+		PoolRealArray tangents;
+		ERR_FAIL_COND(tangents.resize(n * 4) != OK);
+		{
+			PoolVector3Array::Write wn = normals.write();
+			PoolRealArray::Write wt = tangents.write();
+			for (int i = 0; i < n; i++) {
+				wn[i] = Vector3(0, 0, 1);
+				wt[i * 4 + 0] = 1.0;
+				wt[i * 4 + 1] = 0.0;
+				wt[i * 4 + 2] = 0.0;
+				wt[i * 4 + 3] = 1.0;
+			}
+		}
+		arr[Mesh::ARRAY_NORMAL] = normals;
+		arr[Mesh::ARRAY_TANGENT] = tangents;
+	}
+
+	p_mesh->add_surface_from_arrays(Mesh::PRIMITIVE_TRIANGLES, arr, Array(), p_compress_flags & ~Mesh::ARRAY_FLAG_USE_2D_VERTICES);
+}
+
+static void copy_arrays_surface_tool(
+		Ref<ArrayMesh> &p_mesh,
+		const Vector<uint8_t> &p_vertices,
+		const int p_stride,
+		const int p_vertex_count,
+		const Vector<ToveVertexIndex> &p_indices,
+		const PoolVector2Array &p_uvs,
+		bool p_paint_mesh,
+		uint32_t p_compress_flags) {
+
+	const int n = p_vertex_count;
+	const int index_count = p_indices.size();
 
 	Vector<int> iarr;
-	ERR_FAIL_COND_V(iarr.resize(index_count) != OK, Ref<ShaderMaterial>());
+	ERR_FAIL_COND(iarr.resize(index_count) != OK);
 	{
 		for (int i = 0; i < index_count; i++) {
-			iarr.write[i] = vindices[i];
+			iarr.write[i] = p_indices[i];
 		}
 	}
 
 	Vector<Vector3> varr;
-	ERR_FAIL_COND_V(varr.resize(n) != OK, Ref<ShaderMaterial>());
+	ERR_FAIL_COND(varr.resize(n) != OK);
 
 	{
 		for (int i = 0; i < n; i++) {
-			float *p = (float *)(vvertices.ptrw() + i * stride);
+			const float *p = (const float *)(p_vertices.ptr() + i * p_stride);
 			varr.write[i] = Vector3(p[0], p[1], 0) * Vector3(0.001, -0.001, 0.001);
 		}
 	}
 
 	Vector<Color> carr;
-	if (!isPaintMesh) {
-		ERR_FAIL_COND_V(carr.resize(n) != OK, Ref<ShaderMaterial>());
+	if (!p_paint_mesh) {
+		ERR_FAIL_COND(carr.resize(n) != OK);
 		for (int i = 0; i < n; i++) {
-			uint8_t *p = vvertices.ptrw() + i * stride + 2 * sizeof(float);
-			carr.write[i] = Color(p[0] / 255.0, p[1] / 255.0, p[2] / 255.0, p[3] / 255.0).to_linear();
+			const uint8_t *p = p_vertices.ptr() + i * p_stride + 2 * sizeof(float);
+			carr.write[i] = tove_color_to_color(p);
+		}
+	}
+
+	Array arr;
+	ERR_FAIL_COND(arr.resize(Mesh::ARRAY_MAX) != OK);
+	arr[Mesh::ARRAY_VERTEX] = varr;
+	arr[Mesh::ARRAY_INDEX] = iarr;
+	if (carr.size() > 0) {
+		arr[Mesh::ARRAY_COLOR] = carr;
+	}
+	if (p_uvs.size() > 0) {
+		arr[Mesh::ARRAY_TEX_UV] = p_uvs;
+	}
+
+	Ref<SurfaceTool> surface_tool;
+	surface_tool.instance();
+	surface_tool->create_from_triangle_arrays(arr);
+	surface_tool->index();
+	surface_tool->generate_normals();
+	surface_tool->generate_tangents();
+
+	// the surface tool adds normals and tangents, so positions stay 3d here.
+	p_mesh->add_surface_from_arrays(Mesh::PRIMITIVE_TRIANGLES, surface_tool->commit_to_arrays(), Array(), p_compress_flags & ~Mesh::ARRAY_FLAG_USE_2D_VERTICES);
+}
+
+// clang-format off
+static const char *gradient_shader_canvas_code = R"GLSL(
+shader_type canvas_item;
+
+uniform sampler2D paints;
+uniform float npaints;
+uniform float cstep;
+
+varying smooth mediump vec2 gradient_pos;
+varying flat mediump vec3 gradient_scale;
+varying flat mediump float paint;
+
+void vertex()
+{
+	int i = int(floor(UV.x * npaints));
+	vec4 c0 = texelFetch(paints, ivec2(i, 0), 0);
+	vec4 c1 = texelFetch(paints, ivec2(i, 1), 0);
+	vec4 c2 = texelFetch(paints, ivec2(i, 2), 0);
+	mat3 m = mat3(c0.xyz, c1.xyz, c2.xyz);
+
+	gradient_pos = (m * vec3(VERTEX.xy, 1)).xy;
+	gradient_scale = vec3(cstep, 1.0f - 2.0f * cstep, c0.w);
+
+	paint = UV.x;
+}
+
+void fragment()
+{
+	float y = mix(gradient_pos.y, length(gradient_pos), gradient_scale.z);
+	y = gradient_scale.x + gradient_scale.y * y;
+
+	vec2 texture_pos_exact = vec2(paint, y);
+	COLOR = texture(TEXTURE, texture_pos_exact);
+}
+)GLSL";
+
+static const char *gradient_shader_spatial_code = R"GLSL(
+shader_type spatial;
+render_mode cull_disabled;
+
+uniform sampler2D paints;
+uniform float npaints;
+uniform float cstep;
+uniform sampler2D tex : hint_albedo;
+
+varying smooth highp vec3 gradient_pos;
+varying flat highp vec3 gradient_scale;
+varying flat highp float paint;
+
+void vertex()
+{
+	int i = int(floor(UV.x * npaints));
+	vec4 c0 = texelFetch(paints, ivec2(i, 0), 0);
+	vec4 c1 = texelFetch(paints, ivec2(i, 1), 0);
+	vec4 c2 = texelFetch(paints, ivec2(i, 2), 0);
+	mat3 m = mat3(c0.xyz, c1.xyz, c2.xyz);
+
+	gradient_pos = m * VERTEX.xyz;
+	gradient_scale = vec3(cstep, 1.0f - 2.0f * cstep, c0.w);
+
+	paint = UV.x;
+}
+
+void fragment()
+{
+	float y = mix(gradient_pos.y, length(gradient_pos), gradient_scale.z);
+	y = gradient_scale.x + gradient_scale.y * y;
+
+	vec2 texture_pos_exact = vec2(paint, -y);
+	ALBEDO = textureLod(tex, texture_pos_exact, 0).rgb;
+	ALPHA = textureLod(tex, texture_pos_exact, 0).a;
+}
+)GLSL";
+
+// GLES2 has neither texelFetch nor float textures. there, every paint mesh
+// gets a shader of its own with the paint matrices baked into PAINTS, one
+// branch per paint.
+static const char *gradient_shader_canvas_gles2_code = R"GLSL(
+shader_type canvas_item;
+
+uniform float npaints;
+uniform float cstep;
+
+varying smooth mediump vec2 gradient_pos;
+varying flat mediump vec3 gradient_scale;
+varying flat mediump float paint;
+
+void vertex()
+{
+	int i = int(floor(UV.x * npaints));
+	float a = 0.0;
+	mat3 m = mat3(1.0);
+PAINTS
+	gradient_pos = (m * vec3(VERTEX.xy, 1)).xy;
+	gradient_scale = vec3(cstep, 1.0f - 2.0f * cstep, a);
+
+	paint = UV.x;
+}
+
+void fragment()
+{
+	float y = mix(gradient_pos.y, length(gradient_pos), gradient_scale.z);
+	y = gradient_scale.x + gradient_scale.y * y;
+
+	vec2 texture_pos_exact = vec2(paint, y);
+	COLOR = texture(TEXTURE, texture_pos_exact);
+}
+)GLSL";
+
+static const char *gradient_shader_spatial_gles2_code = R"GLSL(
+shader_type spatial;
+render_mode cull_disabled;
+
+uniform float npaints;
+uniform float cstep;
+uniform sampler2D tex : hint_albedo;
+
+varying smooth highp vec3 gradient_pos;
+varying flat highp vec3 gradient_scale;
+varying flat highp float paint;
+
+void vertex()
+{
+	int i = int(floor(UV.x * npaints));
+	float a = 0.0;
+	mat3 m = mat3(1.0);
+PAINTS
+	gradient_pos = m * VERTEX.xyz;
+	gradient_scale = vec3(cstep, 1.0f - 2.0f * cstep, a);
+
+	paint = UV.x;
+}
+
+void fragment()
+{
+	float y = mix(gradient_pos.y, length(gradient_pos), gradient_scale.z);
+	y = gradient_scale.x + gradient_scale.y * y;
+
+	vec2 texture_pos_exact = vec2(paint, -y);
+	ALBEDO = textureLod(tex, texture_pos_exact, 0).rgb;
+	ALPHA = textureLod(tex, texture_pos_exact, 0).a;
+}
+)GLSL";
+// clang-format on
+
+static Ref<Shader> gradient_shaders[2];
+
+Ref<Shader> get_gradient_shader(bool p_spatial) {
+	Ref<Shader> &shader = gradient_shaders[p_spatial ? 1 : 0];
+	if (shader.is_null()) {
+		shader.instance();
+		shader->set_code(p_spatial ? gradient_shader_spatial_code : gradient_shader_canvas_code);
+	}
+	return shader;
+}
+
+void free_gradient_shaders() {
+	gradient_shaders[0].unref();
+	gradient_shaders[1].unref();
+}
+
+static bool use_gles2_gradient_shaders() {
+	return OS::get_singleton()->get_current_video_driver() == OS::VIDEO_DRIVER_GLES2;
+}
+
+// p_paint_data is laid out like the paint texture of the shared shaders.
+static Ref<Shader> make_gles2_gradient_shader(bool p_spatial, const float *p_paint_data, int p_npaints, const Vector<uint8_t> &p_paint_seen) {
+	auto num = [](float p_value) {
+		const String s = String::num_real(p_value);
+		return s.is_numeric() ? s : String("0.0");
+	};
+
+	StringBuilder code;
+	for (int paint_i = 0; paint_i < p_npaints; paint_i++) {
+		if (!p_paint_seen[paint_i]) {
+			continue;
 		}
+		code += "\tif (i == ";
+		code += String::num_int64(paint_i);
+		code += ") {\n\t\ta = ";
+		code += num(p_paint_data[paint_i * 4 + 3]);
+		code += ";\n\t\tm = mat3(";
+		for (int j = 0; j < 3; j++) {
+			const float *texel = p_paint_data + (j * p_npaints + paint_i) * 4;
+			code += j > 0 ? "), vec3(" : "vec3(";
+			for (int k = 0; k < 3; k++) {
+				if (k > 0) {
+					code += ", ";
+				}
+				code += num(texel[k]);
+			}
+		}
+		code += "));\n\t}\n";
 	}
 
-	Vector<Vector2> uvs;
+	Ref<Shader> shader;
+	shader.instance();
+	shader->set_code(String(p_spatial ? gradient_shader_spatial_gles2_code : gradient_shader_canvas_gles2_code).replace("PAINTS", code.as_string()));
+	return shader;
+}
+
+Ref<ShaderMaterial> copy_mesh(
+		Ref<ArrayMesh> &p_mesh,
+		tove::MeshRef &p_tove_mesh,
+		const tove::GraphicsRef &p_graphics,
+		Ref<Texture> &r_texture,
+		bool p_spatial,
+		bool p_direct_upload,
+		uint32_t p_compress_flags) {
+
+	const uint64_t t0 = OS::get_singleton()->get_ticks_usec();
+
+	const int n = p_tove_mesh->getVertexCount();
+	if (n < 1) {
+		return Ref<ShaderMaterial>();
+	}
+
+	const bool isPaintMesh = std::dynamic_pointer_cast<tove::PaintMesh>(p_tove_mesh).get() != nullptr;
+
+	const int stride = isPaintMesh ? sizeof(float) * 3 : sizeof(float) * 2 + 4;
+	const int size = n * stride;
+
+	Vector<uint8_t> vvertices;
+	vvertices.resize(size);
+	p_tove_mesh->copyVertexData(vvertices.ptrw(), size);
+
+	const int index_count = p_tove_mesh->getIndexCount();
+	Vector<ToveVertexIndex> vindices;
+	vindices.resize(index_count);
+	p_tove_mesh->copyIndexData(vindices.ptrw(), index_count);
+
+	PoolVector2Array uvs;
 	Ref<Material> material;
 
 	if (isPaintMesh) {
@@ -120,10 +679,11 @@ Ref<ShaderMaterial> copy_mesh(
 
 		ERR_FAIL_COND_V(uvs.resize(n) != OK, Ref<ShaderMaterial>());
 		{
+			PoolVector2Array::Write w = uvs.write();
 			for (int i = 0; i < n; i++) {
 				const float *p = (float *)(vvertices.ptrw() + i * stride);
 				int paint_index = p[2];
-				uvs.write[i] = Vector2((paint_index + 0.5) / npaints, 0);
+				w[i] = Vector2((paint_index + 0.5) / npaints, 0);
 				paint_seen.write[paint_index] = 1;
 			}
 		}
@@ -146,171 +706,163 @@ Ref<ShaderMaterial> copy_mesh(
 		texture->create_from_image(image, ImageTexture::FLAG_FILTER);
 		r_texture = texture;
 
-		Ref<Shader> shader;
-		shader.instance();
-
-		StringBuilder code;
-		String s;
-		for (int32_t paint_i = 0; paint_i < alloc.numPaints; paint_i++) {
-			bool has_seen = paint_seen[paint_i];
-			if (!has_seen) {
-				continue;
-			}
-
-			code += "if(i==";
-			s = String::num_int64(paint_i);
-			code += s;
-			code += "){";
-
-			const float &v = arguments_data.write[paint_i];
-			code += "a=";
-			s = String::num_real(v);
-			if (!s.is_numeric()) {
-				s = "0.0";
-			}
-			code += s;
-			code += ";";
-
-			const int j0 = paint_i * 3 * matrix_rows;
-			code += "m=mat3(";
-
-			for (int j = 0; j < 3; j++) {
-				if (j > 0) {
-					code += "),";
-				}
-				code += "vec3(";
-				for (int k = 0; k < 3; k++) {
-					if (k > 0) {
-						code += ",";
-					}
-					float elem = matrix_data[j0 + j + k * 3];
-					if (!Math::is_nan(elem)) {
-						s = String::num_real(elem);
-					} else {
-						s = "0.0f";
-					}
-					if (!s.is_numeric()) {
-						s = "0.0";
+		// one column per paint: rows 0-2 hold the gradient matrix columns, the
+		// alpha of row 0 carries the radial/linear mix argument.
+		PoolByteArray paint_data;
+		ERR_FAIL_COND_V(paint_data.resize(npaints * 3 * 4 * sizeof(float)) != OK, Ref<ShaderMaterial>());
+		{
+			PoolByteArray::Write w = paint_data.write();
+			float *d = (float *)w.ptr();
+			for (int paint_i = 0; paint_i < npaints; paint_i++) {
+				const int j0 = paint_i * 3 * matrix_rows;
+				for (int j = 0; j < 3; j++) {
+					float *texel = d + (j * npaints + paint_i) * 4;
+					for (int k = 0; k < 3; k++) {
+						const float elem = matrix_data[j0 + j + k * 3];
+						texel[k] = Math::is_nan(elem) || Math::is_inf(elem) ? 0.0f : elem;
 					}
-					code += s;
+					texel[3] = 0.0f;
 				}
+				const float arg = arguments_data[paint_i];
+				d[paint_i * 4 + 3] = Math::is_nan(arg) || Math::is_inf(arg) ? 0.0f : arg;
 			}
-			code += "));}\n";
 		}
-		if (!p_spatial) {
-			// clang-format off
-			String shader_code = String(R"GLSL(
-shader_type canvas_item;
 
-varying smooth mediump vec2 gradient_pos;
-varying flat mediump vec3 gradient_scale;
-varying flat mediump float paint;
-
-void vertex()
-{
-    int i = int(floor(UV.x * NPAINTS));
-    float a;
-    mat3 m;
+		Ref<ShaderMaterial> shader_material;
+		shader_material.instance();
+		if (use_gles2_gradient_shaders()) {
+			PoolByteArray::Read r = paint_data.read();
+			shader_material->set_shader(make_gles2_gradient_shader(p_spatial, (const float *)r.ptr(), npaints, paint_seen));
+		} else {
+			Ref<Image> paint_image = memnew(Image(npaints, 3, false, Image::FORMAT_RGBAF, paint_data));
+			Ref<ImageTexture> paint_texture = Ref<ImageTexture>(memnew(ImageTexture));
+			paint_texture->create_from_image(paint_image, 0);
 
-)GLSL") +  code.as_string() + String(R"GLSL(
+			shader_material->set_shader(get_gradient_shader(p_spatial));
+			shader_material->set_shader_param("paints", paint_texture);
+		}
+		shader_material->set_shader_param("npaints", (real_t)npaints);
+		shader_material->set_shader_param("cstep", 0.5f / alloc.numColors);
+		if (p_spatial) {
+			shader_material->set_shader_param("tex", texture);
+		}
+		material = shader_material;
+	}
 
-	gradient_pos = (m * vec3(VERTEX.xy, 1)).xy;
-	gradient_scale = vec3(CSTEP, 1.0f - 2.0f * CSTEP, a);
+	set_mesh_position_transform(p_mesh, Transform2D());
+	// only direct 2d color meshes go relative to their bounds; the surface
+	// tool always makes 3d positions.
+	const bool bounds_relative = p_direct_upload && !isPaintMesh && is_bounds_relative(p_compress_flags);
+	if ((p_compress_flags & Mesh::ARRAY_COMPRESS_VERTEX) && !bounds_relative) {
+		for (int i = 0; i < n; i++) {
+			const Vector2 v = tove_vertex_to_vector2((const float *)(vvertices.ptr() + i * stride));
+			if (!fits_half_float(v.x, v.y)) {
+				p_compress_flags = drop_vertex_compression(p_compress_flags);
+				break;
+			}
+		}
+	}
 
-	paint = UV.x;
-}
+	if (p_direct_upload) {
+		copy_arrays_direct(p_mesh, vvertices, stride, n, vindices, uvs, isPaintMesh, p_spatial, p_compress_flags);
+	} else {
+		copy_arrays_surface_tool(p_mesh, vvertices, stride, n, vindices, uvs, isPaintMesh, p_compress_flags);
+	}
 
-void fragment()
-{
-	float y = mix(gradient_pos.y, length(gradient_pos), gradient_scale.z);
-	y = gradient_scale.x + gradient_scale.y * y;
+	print_verbose(vformat("[VG] Uploaded %d vertices, %d indices (%s) in %d usec.",
+			n, index_count, p_direct_upload ? "direct" : "surface tool",
+			(int)(OS::get_singleton()->get_ticks_usec() - t0)));
 
-	vec2 texture_pos_exact = vec2(paint, y);
-	COLOR = texture(TEXTURE, texture_pos_exact); 
+	return material;
 }
 
-)GLSL");
-			// clang-format on
-			String npaints_str = String::num_real(npaints);
-			String cstep_str = String::num_real(0.5f / alloc.numColors);
-
-			shader_code = shader_code.replace("NPAINTS", npaints_str.utf8().get_data());
-			shader_code = shader_code.replace("CSTEP", cstep_str.utf8().get_data());
-			shader->set_code(shader_code);
-
-			Ref<ShaderMaterial> shader_material;
-			shader_material.instance();
-			shader_material->set_shader(shader);
-			material = shader_material;
-		} else {
-			// clang-format off
-			String shader_code = String(R"GLSL(shader_type spatial;
-
-varying smooth highp vec3 gradient_pos;
-varying flat highp vec3 gradient_scale;
-varying flat highp float paint;
-uniform sampler2D tex : hint_albedo;
-render_mode cull_disabled;
-
-void vertex()
-{
-    int i = int(floor(UV.x * NPAINTS));
-    float a;
-    mat3 m;
-
-)GLSL") +  code.as_string() + String(R"GLSL(
-
-	gradient_pos = m * VERTEX.xyz;
-	gradient_scale = vec3(CSTEP, 1.0f - 2.0f * CSTEP, a);
+bool update_mesh_vertices(
+		Ref<ArrayMesh> &p_mesh,
+		int p_surface,
+		const PoolVector3Array &p_vertices,
+		const PoolColorArray &p_colors,
+		int p_from,
+		int p_count) {
+
+	ERR_FAIL_INDEX_V(p_surface, p_mesh->get_surface_count(), false);
+
+	const uint32_t format = p_mesh->surface_get_format(p_surface);
+	const uint32_t other = Mesh::ARRAY_FORMAT_NORMAL | Mesh::ARRAY_FORMAT_TANGENT |
+						   Mesh::ARRAY_FORMAT_TEX_UV | Mesh::ARRAY_FORMAT_TEX_UV2 |
+						   Mesh::ARRAY_FORMAT_BONES | Mesh::ARRAY_FORMAT_WEIGHTS;
+	if (format & other) {
+		return false;
+	}
 
-	paint = UV.x;
-}
+	const int vertex_len = p_mesh->surface_get_array_len(p_surface);
+	const int index_len = p_mesh->surface_get_array_index_len(p_surface);
+	ERR_FAIL_COND_V(p_from < 0 || p_from + p_count > vertex_len, false);
+	ERR_FAIL_COND_V(p_vertices.size() < vertex_len, false);
 
-void fragment()
-{
-	float y = mix(gradient_pos.y, length(gradient_pos), gradient_scale.z);
-	y = gradient_scale.x + gradient_scale.y * y;
+	const bool has_colors = format & Mesh::ARRAY_FORMAT_COLOR;
+	ERR_FAIL_COND_V(has_colors && p_colors.size() < vertex_len, false);
 
-	vec2 texture_pos_exact = vec2(paint, -y);
-	ALBEDO = textureLod(tex, texture_pos_exact, 0).rgb; 
-	ALPHA = textureLod(tex, texture_pos_exact, 0).a;
-}
+	VisualServer *vs = VisualServer::get_singleton();
+	const int stride = vs->mesh_surface_get_format_stride(format, vertex_len, index_len);
+	const int vertex_offset = vs->mesh_surface_get_format_offset(format, vertex_len, index_len, VS::ARRAY_VERTEX);
+	const int color_offset = vs->mesh_surface_get_format_offset(format, vertex_len, index_len, VS::ARRAY_COLOR);
+	const int coords = (format & Mesh::ARRAY_FLAG_USE_2D_VERTICES) ? 2 : 3;
 
-)GLSL");
-			// clang-format on
-			String npaints_str = String::num_real(npaints);
-			String cstep_str = String::num_real(0.5f / alloc.numColors);
+	// positions relative to the bounds the surface was made with.
+	const Transform2D to_mesh = get_mesh_position_transform(p_mesh).affine_inverse();
+	const bool relative = to_mesh != Transform2D();
 
-			shader_code = shader_code.replace("NPAINTS", npaints_str.utf8().get_data());
-			shader_code = shader_code.replace("CSTEP", cstep_str.utf8().get_data());
-			shader->set_code(shader_code);
+	PoolVector<uint8_t> data;
+	ERR_FAIL_COND_V(data.resize(p_count * stride) != OK, false);
+	{
+		PoolVector<uint8_t>::Write w = data.write();
+		PoolVector3Array::Read rv = p_vertices.read();
+		PoolColorArray::Read rc = p_colors.read();
+
+		for (int i = 0; i < p_count; i++) {
+			uint8_t *p = w.ptr() + i * stride;
+
+			Vector3 v = rv[p_from + i];
+			if (relative) {
+				const Vector2 m = to_mesh.xform(Vector2(v.x, v.y));
+				v.x = m.x;
+				v.y = m.y;
+			}
+			if (format & Mesh::ARRAY_COMPRESS_VERTEX) {
+				if (!fits_half_float(v.x, v.y)) {
+					// needs a new surface, with new bounds or full floats.
+					return false;
+				}
+				// 3d half float positions are padded to four components.
+				const uint16_t position[4] = {
+					Math::make_half_float(v.x),
+					Math::make_half_float(v.y),
+					Math::make_half_float(v.z),
+					Math::make_half_float(1.0f)
+				};
+				memcpy(p + vertex_offset, position, (coords == 2 ? 2 : 4) * sizeof(uint16_t));
+			} else {
+				const float position[3] = { v.x, v.y, v.z };
+				memcpy(p + vertex_offset, position, coords * sizeof(float));
+			}
 
-			Ref<ShaderMaterial> mat;
-			mat.instance();
-			mat->set_shader_param("tex", texture);
-			mat->set_shader(shader);
-			material = mat;
+			if (has_colors) {
+				// same conversion VisualServer applies when the surface is created.
+				const Color &c = rc[p_from + i];
+				if (format & Mesh::ARRAY_COMPRESS_COLOR) {
+					uint8_t color[4];
+					for (int j = 0; j < 4; j++) {
+						color[j] = CLAMP(int(c[j] * 255.0), 0, 255);
+					}
+					memcpy(p + color_offset, color, 4);
+				} else {
+					const float color[4] = { c.r, c.g, c.b, c.a };
+					memcpy(p + color_offset, color, 4 * sizeof(float));
+				}
+			}
 		}
 	}
 
-	Array arr;
-	ERR_FAIL_COND_V(arr.resize(Mesh::ARRAY_MAX) != OK, Ref<ShaderMaterial>());
-	arr[Mesh::ARRAY_VERTEX] = varr;
-	arr[Mesh::ARRAY_INDEX] = iarr;
-	if (carr.size() > 0) {
-		arr[Mesh::ARRAY_COLOR] = carr;
-	}
-	if (uvs.size() > 0) {
-		arr[Mesh::ARRAY_TEX_UV] = uvs;
-	}
-
-	Ref<SurfaceTool> surface_tool;
-	surface_tool.instance();
-	surface_tool->create_from_triangle_arrays(arr);
-	surface_tool->index();
-	surface_tool->generate_normals();
-	surface_tool->generate_tangents();
-
-	p_mesh->add_surface_from_arrays(Mesh::PRIMITIVE_TRIANGLES, surface_tool->commit_to_arrays());
-	return material;
+	p_mesh->surface_update_region(p_surface, p_from * stride, data);
+	return true;
 }
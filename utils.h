@@ -19,13 +19,103 @@ inline Rect2 tove_bounds_to_rect2(const float *bounds) {
 	return Rect2(bounds[0], bounds[1], bounds[2] - bounds[0], bounds[3] - bounds[1]);
 }
 
+// positions go up in thousandths of a path unit. ARRAY_COMPRESS_VERTEX
+// stores them as half floats, whose 11 bit significand keeps coordinates
+// of up to this magnitude within 2^-12 of their value.
+// - 2d color meshes store positions relative to their bounds, scaled into
+//   [-1, 1], so any size of art keeps 1/4096 of its half extent. the mesh
+//   carries the transform that undoes this, see encode_mesh_positions().
+// - paint meshes feed positions to the gradient shader before the draw
+//   transform applies, and spatial meshes have no draw transform. both go
+//   back to full floats past this extent, see fit_compress_flags().
+#define VG_HALF_FLOAT_MAX_EXTENT 1.0
+
+inline Vector3 tove_vertex_to_vector3(const float *p) {
+	return Vector3(p[0] * 0.001, p[1] * -0.001, 0);
+}
+
+inline Vector2 tove_vertex_to_vector2(const float *p) {
+	return Vector2(p[0] * 0.001, p[1] * -0.001);
+}
+
+// svg colors are srgb bytes, mesh colors are linear. the bytes cannot go
+// through as they are: add_surface_from_arrays() only takes float colors,
+// and VisualServer packs those back to bytes for ARRAY_COMPRESS_COLOR. so
+// rgb goes through a table of what Color::to_linear() gives for each byte.
+// the 8 bit linear result merges the darkest srgb levels, as it always has.
+const float *get_srgb_to_linear_table();
+
+inline Color tove_color_to_color(const uint8_t *p) {
+	const float *linear = get_srgb_to_linear_table();
+	return Color(linear[p[0]], linear[p[1]], linear[p[2]], p[3] / 255.0);
+}
+
+// p_compress_flags without ARRAY_COMPRESS_VERTEX if a coordinate of
+// p_vertices lies beyond VG_HALF_FLOAT_MAX_EXTENT. warns once when so.
+uint32_t fit_compress_flags(uint32_t p_compress_flags, const PoolVector3Array &p_vertices);
+
+// whether positions for p_compress_flags get stored relative to their bounds.
+inline bool is_bounds_relative(uint32_t p_compress_flags) {
+	const uint32_t flags = Mesh::ARRAY_COMPRESS_VERTEX | Mesh::ARRAY_FLAG_USE_2D_VERTICES;
+	return (p_compress_flags & flags) == flags;
+}
+
+// scales r_vertices into [-1, 1] around the center of their bounds and
+// returns the transform that maps them back. p_margin widens the bounds on
+// each side by that fraction of their larger size, to leave room for moves.
+Transform2D encode_mesh_positions(PoolVector2Array &r_vertices, real_t p_margin = 0);
+
+// maps mesh positions to path positions. identity unless the mesh was
+// uploaded with encode_mesh_positions(). meshes with such positions have
+// to be drawn with this transform, see draw_vg_mesh().
+Transform2D get_mesh_position_transform(const Ref<ArrayMesh> &p_mesh);
+void set_mesh_position_transform(Ref<ArrayMesh> &p_mesh, const Transform2D &p_transform);
+
+// an aabb in mesh positions, in path positions and back.
+AABB mesh_aabb_to_positions(const Ref<ArrayMesh> &p_mesh, const AABB &p_aabb);
+AABB positions_aabb_to_mesh(const Ref<ArrayMesh> &p_mesh, const AABB &p_aabb);
+
+void draw_vg_mesh(CanvasItem *p_canvas_item, const Ref<ArrayMesh> &p_mesh, const Ref<Texture> &p_texture);
+
 tove::PathRef new_transformed_path(const tove::PathRef &p_tove_path, const Transform2D &p_transform);
 
+uint64_t hash_transform(const Transform2D &p_transform, uint64_t p_hash = 5381);
+
+// hashes everything the tesselators look at: points, fill rule, paint types and stroke style.
+uint64_t tove_path_fingerprint(const tove::PathRef &p_tove_path, uint64_t p_hash = 5381);
+
+// hashes what only ends up in vertex colors or paint data: colors, gradients and opacity.
+uint64_t tove_paint_fingerprint(const tove::PathRef &p_tove_path, uint64_t p_hash = 5381);
+
+// hashes the part of the paint that alpha masks keep: opacity and the alpha of each paint.
+uint64_t tove_paint_alpha_fingerprint(const tove::PathRef &p_tove_path, uint64_t p_hash = 5381);
+
+// gradient shaders are compiled once per variant and shared by all paint
+// meshes; per-mesh paint data goes through material parameters. on GLES2,
+// copy_mesh() bakes the paint data into a shader per mesh instead.
+Ref<Shader> get_gradient_shader(bool p_spatial);
+void free_gradient_shaders();
+
 Ref<ShaderMaterial> copy_mesh(
 		Ref<ArrayMesh> &p_mesh,
 		tove::MeshRef &p_tove_mesh,
 		const tove::GraphicsRef &p_graphics,
 		Ref<Texture> &r_texture,
-		bool p_spatial = false);
+		bool p_spatial = false,
+		bool p_direct_upload = true,
+		uint32_t p_compress_flags = Mesh::ARRAY_COMPRESS_DEFAULT);
+
+// overwrites positions and colors of a vertex range in place, in whatever
+// position and color encoding the surface uses. fails on surfaces that
+// carry other attributes, and on half float surfaces when a position moves
+// beyond VG_HALF_FLOAT_MAX_EXTENT, or beyond the bounds of a surface with
+// bounds relative positions.
+bool update_mesh_vertices(
+		Ref<ArrayMesh> &p_mesh,
+		int p_surface,
+		const PoolVector3Array &p_vertices,
+		const PoolColorArray &p_colors,
+		int p_from,
+		int p_count);
 
 #endif // VG_UTILS_H
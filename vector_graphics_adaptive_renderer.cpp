@@ -5,18 +5,23 @@
 #include "vector_graphics_adaptive_renderer.h"
 #include "tove2d/src/cpp/mesh/meshifier.h"
 
-VGMeshRenderer::VGMeshRenderer() : quality(1) {
+VGMeshRenderer::VGMeshRenderer() : quality(1), triangulator(TRIANGULATOR_AUTO) {
 	create_tesselator();
 }
 
-void VGMeshRenderer::create_tesselator() {
-	tesselator = tove::tove_make_shared<tove::AdaptiveTesselator>(
+tove::TesselatorRef VGMeshRenderer::new_tesselator() const {
+	return tove::tove_make_shared<tove::AdaptiveTesselator>(
 		new tove::AdaptiveFlattener<tove::DefaultCurveFlattener>(
 			tove::DefaultCurveFlattener(2 * quality, 6)
-		)
+		),
+		(ToveTriangulator)triangulator
 	);
 }
 
+void VGMeshRenderer::create_tesselator() {
+	set_tesselator(new_tesselator());
+}
+
 float VGMeshRenderer::get_quality() {
 	return quality;
 }
@@ -27,9 +32,27 @@ void VGMeshRenderer::set_quality(float p_quality) {
 	emit_changed();
 }
 
+VGMeshRenderer::Triangulator VGMeshRenderer::get_triangulator() const {
+	return triangulator;
+}
+
+void VGMeshRenderer::set_triangulator(Triangulator p_triangulator) {
+	triangulator = p_triangulator;
+	create_tesselator();
+	emit_changed();
+}
+
 void VGMeshRenderer::_bind_methods() {
 	ClassDB::bind_method(D_METHOD("set_quality", "quality"), &VGMeshRenderer::set_quality);
 	ClassDB::bind_method(D_METHOD("get_quality"), &VGMeshRenderer::get_quality);
+	ClassDB::bind_method(D_METHOD("set_triangulator", "triangulator"), &VGMeshRenderer::set_triangulator);
+	ClassDB::bind_method(D_METHOD("get_triangulator"), &VGMeshRenderer::get_triangulator);
 
 	ADD_PROPERTY(PropertyInfo(Variant::REAL, "quality", PROPERTY_HINT_RANGE, "0,1,0.01"), "set_quality", "get_quality");
+	ADD_PROPERTY(PropertyInfo(Variant::INT, "triangulator", PROPERTY_HINT_ENUM, "Auto,Ear Clipping,Monotone,Optimal"), "set_triangulator", "get_triangulator");
+
+	BIND_ENUM_CONSTANT(TRIANGULATOR_AUTO);
+	BIND_ENUM_CONSTANT(TRIANGULATOR_EAR_CLIPPING);
+	BIND_ENUM_CONSTANT(TRIANGULATOR_MONOTONE);
+	BIND_ENUM_CONSTANT(TRIANGULATOR_OPTIMAL);
 }
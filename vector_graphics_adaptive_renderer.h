@@ -8,12 +8,24 @@
 #include "vector_graphics_mesh_renderer.h"
 
 class VGMeshRenderer : public VGAbstractMeshRenderer {
-	GDCLASS(VGMeshRenderer, VGRenderer);
+	GDCLASS(VGMeshRenderer, VGAbstractMeshRenderer);
 
+public:
+	// same order as ToveTriangulator.
+	enum Triangulator {
+		TRIANGULATOR_AUTO,
+		TRIANGULATOR_EAR_CLIPPING,
+		TRIANGULATOR_MONOTONE,
+		TRIANGULATOR_OPTIMAL,
+	};
+
+private:
     float quality;
+    Triangulator triangulator;
 
 protected:
     void create_tesselator();
+    virtual tove::TesselatorRef new_tesselator() const;
 
 	static void _bind_methods();
 
@@ -22,6 +34,11 @@ public:
 
     float get_quality();
     void set_quality(float p_quality);
+
+    Triangulator get_triangulator() const;
+    void set_triangulator(Triangulator p_triangulator);
 };
 
+VARIANT_ENUM_CAST(VGMeshRenderer::Triangulator);
+
 #endif // VG_ADAPTIVE_RENDERER_H
@@ -5,24 +5,71 @@
 #include "vector_graphics_mesh_renderer.h"
 #include "vector_graphics_path.h"
 #include "tove2d/src/cpp/mesh/meshifier.h"
+#include "core/hashfuncs.h"
+#include "core/os/mutex.h"
+#include "core/os/os.h"
+#include "core/os/thread_work_pool.h"
+
+#include <atomic>
+
+// scales are snapped to quarter octaves so that small zoom changes still hit the cache.
+static int get_scale_bucket(float p_scale) {
+	if (p_scale <= CMP_EPSILON) {
+		return 0;
+	}
+	return Math::round(4.0 * Math::log(p_scale) / Math_LN2);
+}
+
+static float get_bucket_scale(int p_bucket) {
+	return Math::pow(2.0, p_bucket / 4.0);
+}
+
+// below this many uncached paths, waking up worker threads costs more than it saves.
+#define VG_PARALLEL_TESSELATION_MIN_PATHS 16
+
+// one pool for all mesh renderers, started on first use. every lane pulls
+// jobs until none are left, always with the tesselators of that lane.
+static ThreadWorkPool *tesselation_pool = nullptr;
+static int tesselation_lanes = 0;
+static Mutex tesselation_pool_mutex;
+
+void finish_tesselation_pool() {
+	MutexLock lock(tesselation_pool_mutex);
+	if (tesselation_pool) {
+		tesselation_pool->finish();
+		memdelete(tesselation_pool);
+		tesselation_pool = nullptr;
+		tesselation_lanes = 0;
+	}
+}
 
 class Renderer {
-	int fill_index;
-	int line_index;
+	Vector<VGAbstractMeshRenderer::TesselationJob> jobs;
+	VGAbstractMeshRenderer::TesselationJob *work;
+	int work_count;
+	std::atomic<int> next_job;
 
-	tove::MeshRef tove_mesh;
-	tove::GraphicsRef root_graphics;
+	void _tesselate_lane(uint32_t p_lane, void *p_userdata) {
+		int i;
+		while ((i = next_job++) < work_count) {
+			VGAbstractMeshRenderer::TesselationJob &job = work[i];
+			// clipped paths need the root graphics, which is not thread safe.
+			if (job.cacheable) {
+				job.renderer->tesselate(job, p_lane);
+			}
+		}
+	}
 
 public:
-	Renderer(const tove::MeshRef &p_tove_mesh, const tove::GraphicsRef &p_root_graphics) {
+	Vector<VGMeshAssembly::Fragment> fragments;
 
-		fill_index = 0;
-		line_index = 0;
-		tove_mesh = p_tove_mesh;
-		root_graphics = p_root_graphics;
+	Renderer() :
+			work(nullptr),
+			work_count(0),
+			next_job(0) {
 	}
 
-	void traverse(Node *p_node, const Transform2D &p_transform) {
+	void traverse(Node *p_node, const Transform2D &p_transform, VGPath *p_root, bool p_paint_mesh) {
 
 		const int n = p_node->get_child_count();
 		for (int i = 0; i < n; i++) {
@@ -35,7 +82,7 @@ public:
 				t = p_transform;
 			}
 
-			traverse(child, t);
+			traverse(child, t, p_root, p_paint_mesh);
 		}
 
 		if (p_node->is_class_ptr(VGPath::get_class_ptr_static())) {
@@ -43,46 +90,630 @@ public:
 			Ref<VGRenderer> renderer = path->get_inherited_renderer();
 			if (renderer.is_valid() && renderer->is_class_ptr(VGAbstractMeshRenderer::get_class_ptr_static())) {
 				Ref<VGAbstractMeshRenderer> meshRenderer = Object::cast_to<VGAbstractMeshRenderer>(renderer.ptr());
-				if (meshRenderer.is_valid()) {
-					tove::TesselatorRef tesselator = meshRenderer->get_tesselator();
-					if (tesselator) {
-						const Size2 s = path->is_inside_tree() ? path->get_global_transform().get_scale() : path->get_transform().get_scale();
-						tesselator->beginTesselate(root_graphics.get(), MAX(s.width, s.height));
-
-						tesselator->pathToMesh(
-							UPDATE_MESH_EVERYTHING,
-							new_transformed_path(path->get_tove_path(), p_transform),
-							tove_mesh, tove_mesh,
-							fill_index, line_index);
-
-						tesselator->endTesselate();
+				if (meshRenderer.is_valid() && meshRenderer->get_tesselator()) {
+					VGMeshAssembly::Fragment fragment;
+					fragment.path = path->get_instance_id();
+
+					const int levels = meshRenderer->get_lod_levels();
+					if (levels > 0) {
+						const int current = path->get_lod_level();
+
+						// all levels are tesselated up front, so that switching
+						// levels later on is just a cache hit.
+						for (int level = 0; level < levels; level++) {
+							VGAbstractMeshRenderer::TesselationJob job;
+							const int bucket = meshRenderer->get_lod_scale_bucket(level);
+							if (meshRenderer->find_tesselation(path, p_transform, p_root, p_paint_mesh, bucket, job)) {
+								if (level == current) {
+									fragment.mesh = job.mesh;
+								}
+							} else if (level == current || job.cacheable) {
+								job.renderer = meshRenderer;
+								job.fragment = level == current ? fragments.size() : -1;
+								jobs.push_back(job);
+							}
+						}
+					} else {
+						VGAbstractMeshRenderer::TesselationJob job;
+						const int bucket = meshRenderer->get_path_scale_bucket(path);
+						if (meshRenderer->find_tesselation(path, p_transform, p_root, p_paint_mesh, bucket, job)) {
+							fragment.mesh = job.mesh;
+						} else {
+							job.renderer = meshRenderer;
+							job.fragment = fragments.size();
+							jobs.push_back(job);
+						}
 					}
+
+					fragments.push_back(fragment);
+				}
+			}
+		}
+	}
+
+	void tesselate(bool p_parallel) {
+		const int n = jobs.size();
+		if (n == 0) {
+			return;
+		}
+
+		work = jobs.ptrw();
+
+		if (p_parallel && n >= VG_PARALLEL_TESSELATION_MIN_PATHS) {
+			MutexLock lock(tesselation_pool_mutex);
+			if (!tesselation_pool) {
+				tesselation_lanes = OS::get_singleton()->get_processor_count();
+				tesselation_pool = memnew(ThreadWorkPool);
+				tesselation_pool->init(tesselation_lanes);
+			}
+
+			for (int i = 0; i < n; i++) {
+				if (work[i].cacheable) {
+					work[i].renderer->prepare_lane_tesselators(tesselation_lanes);
 				}
 			}
+
+			work_count = n;
+			next_job = 0;
+			tesselation_pool->do_work(tesselation_lanes, this, &Renderer::_tesselate_lane, nullptr);
+
+			for (int i = 0; i < n; i++) {
+				if (!work[i].cacheable) {
+					work[i].renderer->tesselate(work[i], -1);
+				}
+			}
+		} else {
+			for (int i = 0; i < n; i++) {
+				work[i].renderer->tesselate(work[i], -1);
+			}
 		}
+
+		// merging happens in traversal order, no matter which thread was faster.
+		for (int i = 0; i < n; i++) {
+			VGAbstractMeshRenderer::TesselationJob &job = work[i];
+			job.renderer->store_tesselation(job);
+			if (job.fragment >= 0) {
+				fragments.write[job.fragment].mesh = job.mesh;
+			}
+		}
+
+		work = nullptr;
+		jobs.clear();
 	}
 };
 
-Rect2 VGAbstractMeshRenderer::render_mesh(Ref<ArrayMesh> &p_mesh, Ref<Material> &r_material, Ref<Texture> &r_texture, VGPath *p_path, bool p_hq, bool p_spatial) {
-	clear_mesh(p_mesh);
+bool VGMeshAssembly::has_same_layout(const Segment &p_segment, const tove::MeshRef &p_mesh) {
+	if (p_mesh->getVertexCount() != p_segment.vertex_count) {
+		return false;
+	}
 
-	VGPath *root = p_path->get_root_path();
-	tove::GraphicsRef subtree_graphics = root->get_subtree_graphics();
+	const std::map<tove::SubmeshId, tove::Submesh *> &submeshes = p_mesh->getSubmeshes();
+	if ((int)submeshes.size() != p_segment.range_count) {
+		return false;
+	}
+
+	int i = 0;
+	for (auto entry : submeshes) {
+		const IndexRange &range = p_segment.ranges[i++];
+		if (entry.first != range.submesh || entry.second->getIndexCount() != range.count) {
+			return false;
+		}
+	}
+
+	return true;
+}
+
+void VGMeshAssembly::write_segment(const Segment &p_segment, bool &r_indices_changed) {
+	const tove::MeshRef &tove_mesh = p_segment.fragment.mesh;
+
+	const int n = p_segment.vertex_count;
+	if (n > 0) {
+		const int stride = sizeof(float) * 2 + 4;
+		Vector<uint8_t> buffer;
+		buffer.resize(n * stride);
+		tove_mesh->copyVertexData(buffer.ptrw(), n * stride);
+
+		PoolVector3Array::Write wv = vertices.write();
+		PoolColorArray::Write wc = colors.write();
+		const uint8_t *src = buffer.ptr();
+		for (int i = 0; i < n; i++) {
+			const uint8_t *p = src + i * stride;
+			wv[p_segment.vertex_offset + i] = tove_vertex_to_vector3((const float *)p);
+			wc[p_segment.vertex_offset + i] = tove_color_to_color(p + 2 * sizeof(float));
+		}
+	}
+
+	Vector<ToveVertexIndex> triangles;
+	PoolIntArray::Write wi = indices.write();
+	int i = 0;
+	for (auto entry : tove_mesh->getSubmeshes()) {
+		const IndexRange &range = p_segment.ranges[i++];
+		triangles.resize(range.count);
+		entry.second->copyIndexData(triangles.ptrw(), range.count);
+
+		int *dst = wi.ptr() + range.offset;
+		for (int j = 0; j < range.count; j++) {
+			const int index = p_segment.vertex_offset + triangles[j];
+			if (dst[j] != index) {
+				dst[j] = index;
+				r_indices_changed = true;
+			}
+		}
+	}
+}
+
+void VGMeshAssembly::build(const Vector<Fragment> &p_fragments) {
+	segments.resize(p_fragments.size());
+
+	// indices are grouped by submesh id first, just like tove orders them.
+	Map<tove::SubmeshId, int> group_offsets;
+	int vertex_count = 0;
+
+	for (int i = 0; i < p_fragments.size(); i++) {
+		Segment &segment = segments.write[i];
+		segment.fragment = p_fragments[i];
+		segment.vertex_offset = vertex_count;
+		segment.vertex_count = segment.fragment.mesh->getVertexCount();
+		segment.range_count = 0;
+		vertex_count += segment.vertex_count;
+
+		for (auto entry : segment.fragment.mesh->getSubmeshes()) {
+			ERR_BREAK(segment.range_count >= 2);
+			IndexRange &range = segment.ranges[segment.range_count++];
+			range.submesh = entry.first;
+			range.count = entry.second->getIndexCount();
+
+			Map<tove::SubmeshId, int>::Element *E = group_offsets.find(entry.first);
+			if (!E) {
+				E = group_offsets.insert(entry.first, 0);
+			}
+			range.offset = E->get();
+			E->get() += range.count;
+		}
+	}
+
+	int index_count = 0;
+	for (Map<tove::SubmeshId, int>::Element *E = group_offsets.front(); E; E = E->next()) {
+		const int size = E->get();
+		E->get() = index_count;
+		index_count += size;
+	}
+
+	vertices.resize(vertex_count);
+	colors.resize(vertex_count);
+	indices.resize(index_count);
+
+	bool indices_changed = false;
+	for (int i = 0; i < segments.size(); i++) {
+		Segment &segment = segments.write[i];
+		for (int j = 0; j < segment.range_count; j++) {
+			segment.ranges[j].offset += group_offsets[segment.ranges[j].submesh];
+		}
+		write_segment(segment, indices_changed);
+	}
+
+	mesh = RID();
+}
+
+bool VGMeshAssembly::splice(const Vector<Fragment> &p_fragments, int &r_from, int &r_count, bool &r_indices_changed) {
+	if (segments.size() != p_fragments.size()) {
+		return false;
+	}
 
-	tove::MeshRef tove_mesh;
+	for (int i = 0; i < segments.size(); i++) {
+		const Segment &segment = segments[i];
+		const Fragment &fragment = p_fragments[i];
+		if (segment.fragment.path != fragment.path) {
+			return false;
+		}
+		if (segment.fragment.mesh != fragment.mesh && !has_same_layout(segment, fragment.mesh)) {
+			return false;
+		}
+	}
 
-	if (p_hq && !subtree_graphics->areColorsSolid()) {
-		tove_mesh = tove::tove_make_shared<tove::PaintMesh>();
+	int from = vertices.size();
+	int to = 0;
+	r_indices_changed = false;
+
+	for (int i = 0; i < segments.size(); i++) {
+		Segment &segment = segments.write[i];
+		if (segment.fragment.mesh == p_fragments[i].mesh) {
+			continue;
+		}
+		segment.fragment.mesh = p_fragments[i].mesh;
+		write_segment(segment, r_indices_changed);
+		from = MIN(from, segment.vertex_offset);
+		to = MAX(to, segment.vertex_offset + segment.vertex_count);
+	}
+
+	r_from = from;
+	r_count = MAX(0, to - from);
+	return true;
+}
+
+bool VGMeshAssembly::update_vertices(Ref<ArrayMesh> &p_mesh, int p_from, int p_count) {
+	if (p_mesh->get_surface_count() != 1) {
+		return false;
+	}
+
+	// a region update leaves the mesh's aabb alone, so it has to stay valid.
+	PoolVector3Array::Read r = vertices.read();
+	for (int i = 0; i < p_count; i++) {
+		if (!aabb.has_point(r[p_from + i])) {
+			return false;
+		}
+	}
+
+	return update_mesh_vertices(p_mesh, 0, vertices, colors, p_from, p_count);
+}
+
+void VGMeshAssembly::commit(Ref<ArrayMesh> &p_mesh, uint32_t p_compress_flags) {
+	mesh = p_mesh->get_rid();
+	compress_flags = p_compress_flags;
+	aabb = AABB();
+	set_mesh_position_transform(p_mesh, Transform2D());
+
+	if (indices.size() < 3) {
+		return;
+	}
+
+	Array arr;
+	ERR_FAIL_COND(arr.resize(Mesh::ARRAY_MAX) != OK);
+	if (p_compress_flags & Mesh::ARRAY_FLAG_USE_2D_VERTICES) {
+		PoolVector2Array vertices_2d;
+		ERR_FAIL_COND(vertices_2d.resize(vertices.size()) != OK);
+		{
+			PoolVector2Array::Write w = vertices_2d.write();
+			PoolVector3Array::Read r = vertices.read();
+			for (int i = 0; i < vertices.size(); i++) {
+				w[i] = Vector2(r[i].x, r[i].y);
+			}
+		}
+		if (is_bounds_relative(p_compress_flags)) {
+			set_mesh_position_transform(p_mesh, encode_mesh_positions(vertices_2d));
+		}
+		arr[Mesh::ARRAY_VERTEX] = vertices_2d;
 	} else {
-		tove_mesh = tove::tove_make_shared<tove::ColorMesh>();
+		arr[Mesh::ARRAY_VERTEX] = vertices;
+	}
+	arr[Mesh::ARRAY_COLOR] = colors;
+	arr[Mesh::ARRAY_INDEX] = indices;
+	// compress_flags keeps the requested flags, so a fallback to full float
+	// positions does not count as a format change.
+	uint32_t flags = p_compress_flags;
+	if (!is_bounds_relative(flags)) {
+		flags = fit_compress_flags(flags, vertices);
 	}
+	p_mesh->add_surface_from_arrays(Mesh::PRIMITIVE_TRIANGLES, arr, Array(), flags & ~Mesh::ARRAY_FLAG_USE_2D_VERTICES);
 
-	Renderer r(tove_mesh, subtree_graphics);
-	r.traverse(p_path, Transform2D());
+	aabb = mesh_aabb_to_positions(p_mesh, p_mesh->surface_get_aabb(0));
+}
 
-	r_material = copy_mesh(p_mesh, tove_mesh, subtree_graphics, r_texture, p_spatial);
+VGMeshAssembly::VGMeshAssembly() :
+		compress_flags(Mesh::ARRAY_COMPRESS_DEFAULT) {
+}
+
+Rect2 VGAbstractMeshRenderer::render_mesh(Ref<ArrayMesh> &p_mesh, Ref<Material> &r_material, Ref<Texture> &r_texture, VGPath *p_path, bool p_hq, bool p_spatial) {
+	VGPath *root = p_path->get_root_path();
+
+	// the subtree graphics are only needed to pick and feed paint meshes.
+	tove::GraphicsRef subtree_graphics;
+	if (p_hq) {
+		subtree_graphics = root->get_subtree_graphics();
+	}
+
+	const bool paint_mesh = p_hq && !subtree_graphics->areColorsSolid();
+
+	Renderer r;
+	r.traverse(p_path, Transform2D(), root, paint_mesh);
+	r.tesselate(parallel);
+
+	if (!paint_mesh && !p_spatial && direct_upload) {
+		// plain color meshes are kept assembled on the path, so that only
+		// paths that changed since the last render get written and uploaded.
+		VGMeshAssembly &assembly = p_path->get_mesh_assembly();
+		const uint32_t compress_flags = get_compress_flags(p_spatial);
+		int from;
+		int count;
+		bool indices_changed;
+
+		if (p_mesh.is_valid() && assembly.get_mesh() == p_mesh->get_rid() &&
+				assembly.get_compress_flags() == compress_flags &&
+				assembly.splice(r.fragments, from, count, indices_changed)) {
+			if (count > 0 && (indices_changed || !assembly.update_vertices(p_mesh, from, count))) {
+				clear_mesh(p_mesh);
+				assembly.commit(p_mesh, compress_flags);
+				count_upload(p_mesh, compress_flags);
+			}
+		} else {
+			assembly.build(r.fragments);
+			clear_mesh(p_mesh);
+			assembly.commit(p_mesh, compress_flags);
+			count_upload(p_mesh, compress_flags);
+		}
+
+		r_material = Ref<Material>();
+	} else {
+		clear_mesh(p_mesh);
+
+		tove::MeshRef tove_mesh;
+		if (paint_mesh) {
+			tove_mesh = tove::tove_make_shared<tove::PaintMesh>();
+		} else {
+			tove_mesh = tove::tove_make_shared<tove::ColorMesh>();
+		}
+
+		for (int i = 0; i < r.fragments.size(); i++) {
+			tove_mesh->append(*r.fragments[i].mesh.get());
+		}
+
+		const uint32_t compress_flags = get_compress_flags(p_spatial);
+		r_material = copy_mesh(p_mesh, tove_mesh, subtree_graphics, r_texture, p_spatial, direct_upload, compress_flags);
+		count_upload(p_mesh, compress_flags);
+	}
 
 	return tove_bounds_to_rect2(p_path->get_tove_path()->getBounds());
 }
 
-VGAbstractMeshRenderer::VGAbstractMeshRenderer() { }
+int VGAbstractMeshRenderer::get_path_scale_bucket(VGPath *p_path) const {
+	const Size2 s = p_path->is_inside_tree() ? p_path->get_global_transform().get_scale() : p_path->get_transform().get_scale();
+	return get_scale_bucket(MAX(s.width, s.height));
+}
+
+bool VGAbstractMeshRenderer::find_tesselation(VGPath *p_path, const Transform2D &p_transform, VGPath *p_root, bool p_paint_mesh, int p_scale_bucket, TesselationJob &r_job) {
+	tove::PathRef tove_path = p_path->get_tove_path();
+
+	r_job.path = p_path;
+	r_job.root = p_root;
+	r_job.scale_bucket = p_scale_bucket;
+	r_job.paint_mesh = p_paint_mesh;
+	// clip paths live in the root graphics and are not part of the fingerprint.
+	r_job.cacheable = tove_path->getClipIndices().empty();
+	r_job.key = 0;
+	r_job.paint_key = 0;
+
+	if (r_job.cacheable) {
+		uint64_t key = p_path->get_tove_fingerprint();
+		key = hash_transform(p_transform, key);
+		key = hash_djb2_one_64(tove_path->getIndex(), key);
+		key = hash_djb2_one_64(p_paint_mesh ? 1 : 0, key);
+		key = hash_djb2_one_64(tesselator_serial, key);
+		key = hash_djb2_one_64(r_job.scale_bucket, key);
+		r_job.key = key;
+		r_job.paint_key = p_path->get_tove_paint_fingerprint();
+
+		uint64_t paint_key;
+		r_job.mesh = p_path->get_cached_tesselation(key, paint_key);
+		if (r_job.mesh) {
+			if (paint_key != r_job.paint_key) {
+				// same geometry, other colors: no need to tesselate again.
+				r_job.mesh = recolor(r_job.mesh, new_transformed_path(tove_path, p_transform), p_paint_mesh);
+				p_path->set_cached_tesselation(key, r_job.paint_key, r_job.mesh);
+				cache_recolors++;
+			} else {
+				cache_hits++;
+			}
+			return true;
+		}
+	}
+
+	// transformed here, so that tesselating never touches the node's own path.
+	r_job.tove_path = new_transformed_path(tove_path, p_transform);
+	return false;
+}
+
+tove::MeshRef VGAbstractMeshRenderer::recolor(const tove::MeshRef &p_mesh, const tove::PathRef &p_tove_path, bool p_paint_mesh) const {
+	// paint meshes only carry paint indices, colors live in the material.
+	if (p_paint_mesh) {
+		return p_mesh;
+	}
+
+	// fill vertices are emitted before line vertices, and the fill
+	// triangles reference every fill vertex that is visible.
+	int fill_count = 0;
+	const std::map<tove::SubmeshId, tove::Submesh *> &submeshes = p_mesh->getSubmeshes();
+	auto fill = submeshes.find(p_tove_path->getIndex() * 2);
+	if (fill != submeshes.end()) {
+		const int n = fill->second->getIndexCount();
+		Vector<ToveVertexIndex> indices;
+		indices.resize(n);
+		fill->second->copyIndexData(indices.ptrw(), n);
+		for (int i = 0; i < n; i++) {
+			fill_count = MAX(fill_count, indices[i] + 1);
+		}
+	}
+
+	// cached meshes may still be referenced by mesh assemblies, which tell
+	// changed fragments apart by identity, so colors go into a copy.
+	tove::MeshRef mesh = tove::tove_make_shared<tove::ColorMesh>();
+	mesh->append(*p_mesh.get());
+
+	const int vertex_count = mesh->getVertexCount();
+	mesh->setFillColor(p_tove_path, 0, fill_count);
+	mesh->setLineColor(p_tove_path, fill_count, vertex_count - fill_count);
+
+	return mesh;
+}
+
+void VGAbstractMeshRenderer::prepare_lane_tesselators(int p_lanes) {
+	if (lane_tesselator_serial != tesselator_serial) {
+		lane_tesselators.clear();
+		lane_tesselator_serial = tesselator_serial;
+	}
+	for (int i = lane_tesselators.size(); i < p_lanes; i++) {
+		lane_tesselators.push_back(new_tesselator());
+	}
+}
+
+void VGAbstractMeshRenderer::tesselate(TesselationJob &p_job, int p_lane) const {
+	tove::MeshRef mesh;
+	if (p_job.paint_mesh) {
+		mesh = tove::tove_make_shared<tove::PaintMesh>();
+	} else {
+		mesh = tove::tove_make_shared<tove::ColorMesh>();
+	}
+
+	// tesselators keep per-call state, so every lane has its own.
+	const tove::TesselatorRef &job_tesselator = p_lane >= 0 ? lane_tesselators[p_lane] : tesselator;
+	ERR_FAIL_COND(!job_tesselator);
+
+	// only clipped paths need to see the clip paths of the root graphics.
+	tove::GraphicsRef graphics = p_job.cacheable ? empty_graphics : p_job.root->get_subtree_graphics();
+
+	int fill_index = 0;
+	int line_index = 0;
+
+	job_tesselator->beginTesselate(graphics.get(), get_bucket_scale(p_job.scale_bucket));
+	job_tesselator->pathToMesh(
+			UPDATE_MESH_EVERYTHING,
+			p_job.tove_path,
+			mesh, mesh,
+			fill_index, line_index);
+	job_tesselator->endTesselate();
+
+	p_job.mesh = mesh;
+}
+
+void VGAbstractMeshRenderer::store_tesselation(const TesselationJob &p_job) {
+	cache_misses++;
+	if (p_job.cacheable && p_job.mesh) {
+		p_job.path->set_cached_tesselation(p_job.key, p_job.paint_key, p_job.mesh);
+	}
+}
+
+void VGAbstractMeshRenderer::prepare_meshes(const Vector<VGPath *> &p_paths, bool p_hq) {
+	Renderer r;
+	for (int i = 0; i < p_paths.size(); i++) {
+		VGPath *root = p_paths[i]->get_root_path();
+		const bool paint_mesh = p_hq && !root->get_subtree_graphics()->areColorsSolid();
+		r.traverse(p_paths[i], Transform2D(), root, paint_mesh);
+	}
+	r.tesselate(parallel);
+}
+
+void VGAbstractMeshRenderer::set_tesselator(const tove::TesselatorRef &p_tesselator) {
+	static uint64_t serial = 0;
+	tesselator = p_tesselator;
+	tesselator_serial = ++serial;
+}
+
+void VGAbstractMeshRenderer::count_upload(const Ref<ArrayMesh> &p_mesh, uint32_t p_compress_flags) {
+	if ((p_compress_flags & Mesh::ARRAY_COMPRESS_VERTEX) && p_mesh->get_surface_count() > 0 &&
+			!(p_mesh->surface_get_format(0) & Mesh::ARRAY_COMPRESS_VERTEX)) {
+		full_float_uploads++;
+	}
+}
+
+void VGAbstractMeshRenderer::reset_cache_counters() {
+	cache_hits = 0;
+	cache_misses = 0;
+	cache_recolors = 0;
+	full_float_uploads = 0;
+}
+
+void VGAbstractMeshRenderer::set_vertex_format(VertexFormat p_vertex_format) {
+	vertex_format = p_vertex_format;
+	emit_changed();
+}
+
+uint32_t VGAbstractMeshRenderer::get_compress_flags(bool p_spatial) const {
+	// colors always go up as 8 bit rgba, as part of the default flags.
+	uint32_t flags = Mesh::ARRAY_COMPRESS_DEFAULT;
+	if (vertex_format == VERTEX_FORMAT_2D_COMPRESSED) {
+		flags |= Mesh::ARRAY_COMPRESS_VERTEX;
+	}
+	// spatial materials expect a z coordinate.
+	if (vertex_format != VERTEX_FORMAT_3D && !p_spatial) {
+		flags |= Mesh::ARRAY_FLAG_USE_2D_VERTICES;
+	}
+	return flags;
+}
+
+int VGAbstractMeshRenderer::select_lod_level(float p_scale, int p_current) const {
+	if (lod_levels < 1) {
+		return -1;
+	}
+
+	// level i is tesselated for a scale of 2^(first + i) and is good for
+	// on-screen scales in the octave just below that.
+	const int first = -lod_levels / 2;
+	const float octave = p_scale > CMP_EPSILON ? Math::log(p_scale) / Math_LN2 : first - 1;
+
+	if (p_current >= 0 && p_current < lod_levels) {
+		const float top = first + p_current;
+		if (octave > top - 1 - lod_hysteresis && octave <= top + lod_hysteresis) {
+			return p_current;
+		}
+	}
+
+	return CLAMP((int)Math::ceil(octave) - first, 0, lod_levels - 1);
+}
+
+int VGAbstractMeshRenderer::get_lod_scale_bucket(int p_level) const {
+	// buckets are quarter octaves.
+	return 4 * (p_level - lod_levels / 2);
+}
+
+void VGAbstractMeshRenderer::set_lod_levels(int p_lod_levels) {
+	lod_levels = CLAMP(p_lod_levels, 0, VG_MAX_LOD_LEVELS);
+	emit_changed();
+}
+
+void VGAbstractMeshRenderer::set_lod_hysteresis(float p_lod_hysteresis) {
+	lod_hysteresis = MAX(0.0f, p_lod_hysteresis);
+}
+
+void VGAbstractMeshRenderer::set_parallel(bool p_parallel) {
+	parallel = p_parallel;
+}
+
+void VGAbstractMeshRenderer::set_direct_upload(bool p_direct_upload) {
+	direct_upload = p_direct_upload;
+	emit_changed();
+}
+
+void VGAbstractMeshRenderer::_bind_methods() {
+	ClassDB::bind_method(D_METHOD("set_direct_upload", "enabled"), &VGAbstractMeshRenderer::set_direct_upload);
+	ClassDB::bind_method(D_METHOD("get_direct_upload"), &VGAbstractMeshRenderer::get_direct_upload);
+	ClassDB::bind_method(D_METHOD("set_vertex_format", "format"), &VGAbstractMeshRenderer::set_vertex_format);
+	ClassDB::bind_method(D_METHOD("get_vertex_format"), &VGAbstractMeshRenderer::get_vertex_format);
+	ClassDB::bind_method(D_METHOD("set_parallel", "enabled"), &VGAbstractMeshRenderer::set_parallel);
+	ClassDB::bind_method(D_METHOD("get_parallel"), &VGAbstractMeshRenderer::get_parallel);
+
+	ClassDB::bind_method(D_METHOD("set_lod_levels", "levels"), &VGAbstractMeshRenderer::set_lod_levels);
+	ClassDB::bind_method(D_METHOD("get_lod_levels"), &VGAbstractMeshRenderer::get_lod_levels);
+	ClassDB::bind_method(D_METHOD("set_lod_hysteresis", "octaves"), &VGAbstractMeshRenderer::set_lod_hysteresis);
+	ClassDB::bind_method(D_METHOD("get_lod_hysteresis"), &VGAbstractMeshRenderer::get_lod_hysteresis);
+
+	ClassDB::bind_method(D_METHOD("get_cache_hits"), &VGAbstractMeshRenderer::get_cache_hits);
+	ClassDB::bind_method(D_METHOD("get_cache_misses"), &VGAbstractMeshRenderer::get_cache_misses);
+	ClassDB::bind_method(D_METHOD("get_cache_recolors"), &VGAbstractMeshRenderer::get_cache_recolors);
+	ClassDB::bind_method(D_METHOD("get_full_float_uploads"), &VGAbstractMeshRenderer::get_full_float_uploads);
+	ClassDB::bind_method(D_METHOD("reset_cache_counters"), &VGAbstractMeshRenderer::reset_cache_counters);
+
+	ADD_PROPERTY(PropertyInfo(Variant::BOOL, "direct_upload"), "set_direct_upload", "get_direct_upload");
+	ADD_PROPERTY(PropertyInfo(Variant::INT, "vertex_format", PROPERTY_HINT_ENUM, "3D,2D,2D Compressed"), "set_vertex_format", "get_vertex_format");
+	ADD_PROPERTY(PropertyInfo(Variant::BOOL, "parallel"), "set_parallel", "get_parallel");
+	ADD_GROUP("LOD", "lod_");
+	ADD_PROPERTY(PropertyInfo(Variant::INT, "lod_levels", PROPERTY_HINT_RANGE, "0,8,1"), "set_lod_levels", "get_lod_levels");
+	ADD_PROPERTY(PropertyInfo(Variant::REAL, "lod_hysteresis", PROPERTY_HINT_RANGE, "0,1,0.01"), "set_lod_hysteresis", "get_lod_hysteresis");
+
+	BIND_ENUM_CONSTANT(VERTEX_FORMAT_3D);
+	BIND_ENUM_CONSTANT(VERTEX_FORMAT_2D);
+	BIND_ENUM_CONSTANT(VERTEX_FORMAT_2D_COMPRESSED);
+}
+
+VGAbstractMeshRenderer::VGAbstractMeshRenderer() :
+		tesselator_serial(0),
+		lane_tesselator_serial(0),
+		empty_graphics(tove::tove_make_shared<tove::Graphics>()),
+		direct_upload(true),
+		parallel(true),
+		vertex_format(VERTEX_FORMAT_3D),
+		lod_levels(0),
+		lod_hysteresis(0.25),
+		cache_hits(0),
+		cache_misses(0),
+		cache_recolors(0),
+		full_float_uploads(0) {
+}
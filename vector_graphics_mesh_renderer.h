@@ -7,16 +7,161 @@
 
 #include "vector_graphics_renderer.h"
 #include "utils.h"
+#include "tove2d/src/cpp/mesh/mesh.h"
+
+// remembers which paths a subtree mesh was assembled from and where their
+// vertices and indices ended up, so that later renders only need to splice
+// in the paths that actually changed.
+class VGMeshAssembly {
+public:
+	struct Fragment {
+		ObjectID path;
+		tove::MeshRef mesh;
+	};
+
+private:
+	struct IndexRange {
+		tove::SubmeshId submesh;
+		int offset;
+		int count;
+	};
+
+	struct Segment {
+		Fragment fragment;
+		int vertex_offset;
+		int vertex_count;
+		// fill and line.
+		IndexRange ranges[2];
+		int range_count;
+	};
+
+	Vector<Segment> segments;
+	PoolVector3Array vertices;
+	PoolColorArray colors;
+	PoolIntArray indices;
+	AABB aabb;
+	RID mesh;
+	uint32_t compress_flags;
+
+	static bool has_same_layout(const Segment &p_segment, const tove::MeshRef &p_mesh);
+	void write_segment(const Segment &p_segment, bool &r_indices_changed);
+
+public:
+	RID get_mesh() const { return mesh; }
+	uint32_t get_compress_flags() const { return compress_flags; }
+
+	void build(const Vector<Fragment> &p_fragments);
+	bool splice(const Vector<Fragment> &p_fragments, int &r_from, int &r_count, bool &r_indices_changed);
+	bool update_vertices(Ref<ArrayMesh> &p_mesh, int p_from, int p_count);
+	void commit(Ref<ArrayMesh> &p_mesh, uint32_t p_compress_flags = Mesh::ARRAY_COMPRESS_DEFAULT);
+
+	VGMeshAssembly();
+};
+
+// upper bound for lod_levels; paths keep this many tesselations around.
+#define VG_MAX_LOD_LEVELS 8
 
 class VGAbstractMeshRenderer : public VGRenderer {
+	GDCLASS(VGAbstractMeshRenderer, VGRenderer);
+
+public:
+	enum VertexFormat {
+		VERTEX_FORMAT_3D,
+		VERTEX_FORMAT_2D,
+		VERTEX_FORMAT_2D_COMPRESSED,
+	};
+
 protected:
 	tove::TesselatorRef tesselator;
+	uint64_t tesselator_serial;
+	// one tesselator per lane of the tesselation pool, made once and kept
+	// until tesselator_serial changes.
+	Vector<tove::TesselatorRef> lane_tesselators;
+	uint64_t lane_tesselator_serial;
+	tove::GraphicsRef empty_graphics;
+	bool direct_upload;
+	bool parallel;
+	VertexFormat vertex_format;
+
+	// 0 disables the lod chain, otherwise the number of octave spaced
+	// tesselation levels kept per path, centered around a scale of 1.
+	int lod_levels;
+	float lod_hysteresis;
+
+	uint64_t cache_hits;
+	uint64_t cache_misses;
+	uint64_t cache_recolors;
+	uint64_t full_float_uploads;
+
+	tove::MeshRef recolor(const tove::MeshRef &p_mesh, const tove::PathRef &p_tove_path, bool p_paint_mesh) const;
+
+	void set_tesselator(const tove::TesselatorRef &p_tesselator);
+	// counts p_mesh if compression was asked for but it got full floats.
+	void count_upload(const Ref<ArrayMesh> &p_mesh, uint32_t p_compress_flags);
+	virtual tove::TesselatorRef new_tesselator() const { return tove::TesselatorRef(); }
 
 	static void _bind_methods();
 
 public:
 	const tove::TesselatorRef &get_tesselator() const { return tesselator; }
 
+	bool get_direct_upload() const { return direct_upload; }
+	void set_direct_upload(bool p_direct_upload);
+
+	bool get_parallel() const { return parallel; }
+	void set_parallel(bool p_parallel);
+
+	VertexFormat get_vertex_format() const { return vertex_format; }
+	void set_vertex_format(VertexFormat p_vertex_format);
+
+	// add_surface_from_arrays() flags for the configured vertex format.
+	uint32_t get_compress_flags(bool p_spatial) const;
+
+	int get_lod_levels() const { return lod_levels; }
+	void set_lod_levels(int p_lod_levels);
+
+	float get_lod_hysteresis() const { return lod_hysteresis; }
+	void set_lod_hysteresis(float p_lod_hysteresis);
+
+	// picks the level for the given on-screen scale. p_current is kept as long
+	// as the scale stays within its octave, widened by lod_hysteresis octaves.
+	int select_lod_level(float p_scale, int p_current) const;
+	int get_lod_scale_bucket(int p_level) const;
+
+	struct TesselationJob {
+		Ref<VGAbstractMeshRenderer> renderer;
+		VGPath *path;
+		VGPath *root;
+		tove::PathRef tove_path;
+		int scale_bucket;
+		bool paint_mesh;
+		bool cacheable;
+		uint64_t key;
+		uint64_t paint_key;
+		int fragment;
+		tove::MeshRef mesh;
+	};
+
+	int get_path_scale_bucket(VGPath *p_path) const;
+	bool find_tesselation(VGPath *p_path, const Transform2D &p_transform, VGPath *p_root, bool p_paint_mesh, int p_scale_bucket, TesselationJob &r_job);
+	void prepare_lane_tesselators(int p_lanes);
+	// p_lane picks a tesselator of the pool, -1 the renderer's own.
+	void tesselate(TesselationJob &p_job, int p_lane) const;
+	void store_tesselation(const TesselationJob &p_job);
+
+	// tesselates the given paths up front, on all cores if parallel is set.
+	// render_mesh() on these paths will then find them in the path caches.
+	void prepare_meshes(const Vector<VGPath *> &p_paths, bool p_hq);
+
+	int get_cache_hits() const { return cache_hits; }
+	int get_cache_misses() const { return cache_misses; }
+	// cache hits that only needed new vertex colors.
+	int get_cache_recolors() const { return cache_recolors; }
+	// uploads of a compressed vertex format that had to use full float
+	// positions, see fit_compress_flags(). reset with the cache counters.
+	int get_full_float_uploads() const { return full_float_uploads; }
+	void reset_cache_counters();
+
 	virtual Rect2 render_mesh(Ref<ArrayMesh> &p_mesh, Ref<Material> &r_material, Ref<Texture> &r_texture, VGPath *p_path, bool p_hq, bool p_spatial = false);
 	virtual Ref<ImageTexture> render_texture(VGPath *p_path, bool p_hq) { return Ref<ImageTexture>(); }
 
@@ -25,4 +170,9 @@ public:
 	VGAbstractMeshRenderer();
 };
 
+VARIANT_ENUM_CAST(VGAbstractMeshRenderer::VertexFormat);
+
+// stops the threads that tesselate paths in parallel.
+void finish_tesselation_pool();
+
 #endif // VG_MESH_RENDERER_H
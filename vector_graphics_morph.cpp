@@ -0,0 +1,203 @@
+/*************************************************************************/
+/*  vg_morph.cpp                                                         */
+/*************************************************************************/
+
+#include "vector_graphics_morph.h"
+#include "vector_graphics_path.h"
+#include "core/os/os.h"
+
+void VGMorph::update_graphics() {
+	keyframes_dirty = false;
+	keyframe_graphics.clear();
+	graphics = tove::GraphicsRef();
+	state.reset();
+
+	if (!is_inside_tree()) {
+		return;
+	}
+
+	for (int i = 0; i < keyframes.size(); i++) {
+		VGPath *path = Object::cast_to<VGPath>(get_node_or_null(keyframes[i]));
+		if (!path) {
+			// skipping it would shift the frame of every later keyframe.
+			WARN_PRINT("VGMorph keyframe " + itos(i) + " is not a VGPath.");
+			keyframe_graphics.clear();
+			return;
+		}
+		// subtree graphics are replaced, never modified, on changes.
+		keyframe_graphics.push_back(path->get_subtree_graphics());
+	}
+
+	const int n = keyframe_graphics.size();
+	if (n == 0) {
+		return;
+	}
+
+	const uint64_t topology = VGRigidMeshRenderer::get_topology_fingerprint(keyframe_graphics[0]);
+	for (int i = 1; i < n; i++) {
+		if (VGRigidMeshRenderer::get_topology_fingerprint(keyframe_graphics[i]) != topology) {
+			WARN_PRINT("VGMorph keyframe " + itos(i) + " does not match the paths and point counts of the first keyframe.");
+		}
+	}
+
+	// our own paths, so that animating never touches the keyframes.
+	const tove::GraphicsRef &first = keyframe_graphics[0];
+	graphics = tove::tove_make_shared<tove::Graphics>();
+	for (int i = 0; i < first->getNumPaths(); i++) {
+		graphics->addPath(first->getPath(i)->clone());
+	}
+
+	if (renderer.is_valid()) {
+		renderer->pin_keyframes(state, keyframe_graphics);
+	}
+
+	dirty = true;
+}
+
+void VGMorph::update_mesh() {
+	if (keyframes_dirty) {
+		update_graphics();
+	}
+
+	if (!dirty) {
+		return;
+	}
+	dirty = false;
+
+	const int n = keyframe_graphics.size();
+	if (n == 0 || renderer.is_null()) {
+		mesh = Ref<ArrayMesh>();
+		return;
+	}
+
+	const uint64_t t0 = OS::get_singleton()->get_ticks_usec();
+
+	const float f = CLAMP(frame, 0.0f, float(n - 1));
+	const int k = MIN(int(f), MAX(n - 2, 0));
+	graphics->animate(keyframe_graphics[k], keyframe_graphics[MIN(k + 1, n - 1)], f - k);
+
+	mesh = renderer->render_graphics(state, graphics);
+
+	last_frame_usec = OS::get_singleton()->get_ticks_usec() - t0;
+	total_frame_usec += last_frame_usec;
+	frame_count++;
+}
+
+void VGMorph::_renderer_changed() {
+	// a new tesselator starts out with empty triangle caches.
+	keyframes_dirty = true;
+	update();
+}
+
+void VGMorph::_notification(int p_what) {
+
+	switch (p_what) {
+		case NOTIFICATION_ENTER_TREE: {
+			// keyframe node paths only resolve inside the tree.
+			keyframes_dirty = true;
+		} break;
+		case NOTIFICATION_DRAW: {
+			update_mesh();
+			if (mesh.is_valid()) {
+				draw_vg_mesh(this, mesh, Ref<Texture>());
+			}
+		} break;
+	}
+}
+
+Array VGMorph::get_keyframes() const {
+	return keyframes;
+}
+
+void VGMorph::set_keyframes(const Array &p_keyframes) {
+	keyframes = p_keyframes;
+	keyframes_dirty = true;
+	update();
+}
+
+float VGMorph::get_frame() const {
+	return frame;
+}
+
+void VGMorph::set_frame(float p_frame) {
+	if (frame == p_frame) {
+		return;
+	}
+	frame = p_frame;
+	dirty = true;
+	update();
+}
+
+Ref<VGRigidMeshRenderer> VGMorph::get_renderer() const {
+	return renderer;
+}
+
+void VGMorph::set_renderer(const Ref<VGRigidMeshRenderer> &p_renderer) {
+
+	if (renderer.is_valid()) {
+		renderer->disconnect("changed", this, "_renderer_changed");
+	}
+	renderer = p_renderer;
+	if (renderer.is_valid()) {
+		renderer->connect("changed", this, "_renderer_changed");
+	}
+
+	_renderer_changed();
+}
+
+void VGMorph::update_keyframes() {
+	keyframes_dirty = true;
+	update();
+}
+
+int VGMorph::get_keyframe_count() const {
+	return keyframe_graphics.size();
+}
+
+float VGMorph::get_average_frame_usec() const {
+	return frame_count > 0 ? total_frame_usec / float(frame_count) : 0.0f;
+}
+
+void VGMorph::reset_frame_stats() {
+	last_frame_usec = 0;
+	total_frame_usec = 0;
+	frame_count = 0;
+}
+
+void VGMorph::_bind_methods() {
+
+	ClassDB::bind_method(D_METHOD("set_keyframes", "keyframes"), &VGMorph::set_keyframes);
+	ClassDB::bind_method(D_METHOD("get_keyframes"), &VGMorph::get_keyframes);
+
+	ClassDB::bind_method(D_METHOD("set_frame", "frame"), &VGMorph::set_frame);
+	ClassDB::bind_method(D_METHOD("get_frame"), &VGMorph::get_frame);
+
+	ClassDB::bind_method(D_METHOD("set_renderer", "renderer"), &VGMorph::set_renderer);
+	ClassDB::bind_method(D_METHOD("get_renderer"), &VGMorph::get_renderer);
+
+	ADD_PROPERTY(PropertyInfo(Variant::ARRAY, "keyframes", PROPERTY_HINT_TYPE_STRING, itos(Variant::NODE_PATH) + ":"), "set_keyframes", "get_keyframes");
+	ADD_PROPERTY(PropertyInfo(Variant::REAL, "frame", PROPERTY_HINT_RANGE, "0,16,0.01,or_greater"), "set_frame", "get_frame");
+	ADD_PROPERTY(PropertyInfo(Variant::OBJECT, "renderer", PROPERTY_HINT_RESOURCE_TYPE, "VGRigidMeshRenderer"), "set_renderer", "get_renderer");
+
+	ClassDB::bind_method(D_METHOD("update_keyframes"), &VGMorph::update_keyframes);
+	ClassDB::bind_method(D_METHOD("get_keyframe_count"), &VGMorph::get_keyframe_count);
+
+	ClassDB::bind_method(D_METHOD("get_last_frame_usec"), &VGMorph::get_last_frame_usec);
+	ClassDB::bind_method(D_METHOD("get_average_frame_usec"), &VGMorph::get_average_frame_usec);
+	ClassDB::bind_method(D_METHOD("reset_frame_stats"), &VGMorph::reset_frame_stats);
+
+	ClassDB::bind_method(D_METHOD("_renderer_changed"), &VGMorph::_renderer_changed);
+}
+
+VGMorph::VGMorph() :
+		frame(0),
+		keyframes_dirty(true),
+		dirty(true),
+		last_frame_usec(0),
+		total_frame_usec(0),
+		frame_count(0) {
+
+	Ref<VGRigidMeshRenderer> renderer;
+	renderer.instance();
+	set_renderer(renderer);
+}
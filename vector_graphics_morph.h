@@ -0,0 +1,66 @@
+/*************************************************************************/
+/*  vg_morph.h                                                           */
+/*************************************************************************/
+
+#ifndef VG_MORPH_H
+#define VG_MORPH_H
+
+#include "scene/2d/node_2d.h"
+#include "vector_graphics_rigid_renderer.h"
+
+// draws a shape interpolated between the subtrees of a list of VGPath
+// keyframes. keyframes need matching paths, subpaths and point counts.
+// their triangulations get pinned in the triangle caches up front, so
+// that playback only moves vertices.
+class VGMorph : public Node2D {
+	GDCLASS(VGMorph, Node2D);
+
+	Array keyframes;
+	float frame;
+	Ref<VGRigidMeshRenderer> renderer;
+
+	Vector<tove::GraphicsRef> keyframe_graphics;
+	// allocated once per set of keyframes, then animated in place.
+	tove::GraphicsRef graphics;
+	VGRigidMeshState state;
+	Ref<ArrayMesh> mesh;
+
+	bool keyframes_dirty;
+	bool dirty;
+
+	uint64_t last_frame_usec;
+	uint64_t total_frame_usec;
+	uint64_t frame_count;
+
+	void update_graphics();
+	void update_mesh();
+
+protected:
+	void _renderer_changed();
+
+	void _notification(int p_what);
+	static void _bind_methods();
+
+public:
+	Array get_keyframes() const;
+	void set_keyframes(const Array &p_keyframes);
+
+	float get_frame() const;
+	void set_frame(float p_frame);
+
+	Ref<VGRigidMeshRenderer> get_renderer() const;
+	void set_renderer(const Ref<VGRigidMeshRenderer> &p_renderer);
+
+	// takes new snapshots of the keyframe paths, after they were edited.
+	void update_keyframes();
+	int get_keyframe_count() const;
+
+	// cost of interpolating, tesselating and uploading, in microseconds.
+	int get_last_frame_usec() const { return last_frame_usec; }
+	float get_average_frame_usec() const;
+	void reset_frame_stats();
+
+	VGMorph();
+};
+
+#endif // VG_MORPH_H
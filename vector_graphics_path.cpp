@@ -271,6 +271,7 @@ void VGPath::update_mesh_representation() {
 	}
 	dirty = false;
 
+	Ref<Material> material;
 	if (!is_empty()) {
 		Ref<VGRenderer> renderer = get_inherited_renderer();
 		if (renderer.is_valid()) {
@@ -278,8 +279,112 @@ void VGPath::update_mesh_representation() {
 			Ref<Texture> ignored_texture; // ignored
 			const Rect2 area = renderer->render_mesh(mesh, ignored_material, ignored_texture, this, false, false);
 			texture = renderer->render_texture(this, false);
+			material = renderer->get_canvas_material(this);
 		}
 	}
+
+	renderer_material = material;
+
+	update_lod_processing();
+}
+
+void VGPath::update_canvas_material() {
+	// a material set on the node itself always wins. clearing it makes
+	// CanvasItem write an empty material to the canvas item, so this runs
+	// on every draw instead of only when renderer_material changes.
+	if (get_material().is_null()) {
+		VS::get_singleton()->canvas_item_set_material(get_canvas_item(), renderer_material.is_valid() ? renderer_material->get_rid() : RID());
+	}
+}
+
+bool VGPath::uses_lod() {
+	Ref<VGAbstractMeshRenderer> renderer = get_inherited_renderer();
+	return renderer.is_valid() && renderer->get_lod_levels() > 0;
+}
+
+bool VGPath::subtree_uses_lod(Node *p_node) {
+	if (p_node->is_class_ptr(get_class_ptr_static()) && Object::cast_to<VGPath>(p_node)->uses_lod()) {
+		return true;
+	}
+	const int n = p_node->get_child_count();
+	for (int i = 0; i < n; i++) {
+		if (subtree_uses_lod(p_node->get_child(i))) {
+			return true;
+		}
+	}
+	return false;
+}
+
+void VGPath::update_lod_processing() {
+	const bool lod = uses_lod();
+	if (!lod) {
+		lod_level = -1;
+	}
+	Ref<VGRenderer> renderer = get_inherited_renderer();
+	const bool viewport = renderer.is_valid() && renderer->is_viewport_dependent(this);
+
+	// camera zoom does not send transform notifications, so lod has to poll.
+	// the root does that once a frame for all of its subtree.
+	VGPath *root = get_root_path();
+	if (root == this) {
+		set_process((viewport || subtree_uses_lod(this)) && is_inside_tree());
+	} else {
+		if (lod && is_inside_tree()) {
+			root->set_process(true);
+		}
+		set_process(viewport && is_inside_tree());
+	}
+}
+
+bool VGPath::update_lod_level() {
+	Ref<VGAbstractMeshRenderer> renderer = get_inherited_renderer();
+	if (renderer.is_null()) {
+		return false;
+	}
+
+	// the canvas transform carries viewport and camera zoom.
+	const Size2 s = is_inside_tree() ? get_global_transform_with_canvas().get_scale() : get_transform().get_scale();
+	const int level = renderer->select_lod_level(MAX(ABS(s.width), ABS(s.height)), lod_level);
+	if (level == lod_level) {
+		return false;
+	}
+	lod_level = level;
+	return true;
+}
+
+void VGPath::lod_level_changed() {
+	// switching levels only picks other cached tesselations, no need to
+	// throw away graphics or fingerprints.
+	Node *node = this;
+	while (node) {
+		if (node->is_class_ptr(get_class_ptr_static())) {
+			VGPath *path = Object::cast_to<VGPath>(node);
+			path->dirty = true;
+			path->update();
+		}
+		node = node->get_parent();
+	}
+}
+
+void VGPath::update_subtree_lod_levels(Node *p_node) {
+	const int n = p_node->get_child_count();
+	for (int i = 0; i < n; i++) {
+		update_subtree_lod_levels(p_node->get_child(i));
+	}
+
+	if (p_node->is_class_ptr(get_class_ptr_static())) {
+		VGPath *path = Object::cast_to<VGPath>(p_node);
+		if (path->update_lod_level()) {
+			path->lod_level_changed();
+		}
+	}
+}
+
+int VGPath::get_lod_level() {
+	if (lod_level < 0) {
+		update_lod_level();
+	}
+	return lod_level;
 }
 
 void VGPath::update_tove_fill_color() {
@@ -316,9 +421,18 @@ void VGPath::_bubble_change() {
 void VGPath::_transform_changed(Node *p_node) {
 	if (p_node->is_class_ptr(get_class_ptr_static())) {
 		VGPath *path = Object::cast_to<VGPath>(p_node);
+		if (path->update_lod_level()) {
+			path->lod_level_changed();
+		}
 		Ref<VGRenderer> renderer = path->get_inherited_renderer();
-		if (renderer.is_valid() && renderer->is_dirty_on_transform_change()) {
-			path->set_dirty();
+		if (renderer.is_valid()) {
+			if (renderer->is_dirty_on_transform_change()) {
+				path->set_dirty();
+			} else if (renderer->is_dirty_on_scale_change(path)) {
+				// same graphics, only another resolution.
+				path->dirty = true;
+				path->update();
+			}
 		}
 	}
 
@@ -334,8 +448,12 @@ void VGPath::_notification(int p_what) {
 	switch (p_what) {
 		case NOTIFICATION_DRAW: {
 			update_mesh_representation();
+			update_canvas_material();
 			if (!is_empty()) {
-				draw_mesh(mesh, texture, Ref<Texture>());
+				Ref<VGRenderer> renderer = get_inherited_renderer();
+				if (renderer.is_null() || !renderer->draw_path(this)) {
+					draw_vg_mesh(this, mesh, texture);
+				}
 			}
 		} break;
 		case NOTIFICATION_PARENTED: {
@@ -349,6 +467,23 @@ void VGPath::_notification(int p_what) {
 			set_dirty();
 			_bubble_change();
 		} break;
+		case NOTIFICATION_PROCESS: {
+			if (get_root_path() == this) {
+				// moving the camera keeps every level, so only the basis
+				// of the root is compared. paths below the root get their
+				// own transform changes in _transform_changed().
+				Transform2D basis = get_global_transform_with_canvas();
+				basis.elements[2] = Vector2();
+				if (basis != lod_canvas_basis) {
+					lod_canvas_basis = basis;
+					update_subtree_lod_levels(this);
+				}
+			}
+			Ref<VGRenderer> renderer = get_inherited_renderer();
+			if (renderer.is_valid() && renderer->update_viewport(this)) {
+				update();
+			}
+		} break;
 		case NOTIFICATION_TRANSFORM_CHANGED: {
 			if (is_inside_tree()) {
 				_bubble_change();
@@ -515,6 +650,10 @@ void VGPath::set_renderer(const Ref<VGRenderer> &p_renderer) {
 	if (renderer.is_valid()) {
 		renderer->connect("changed", this, "_renderer_changed");
 	}
+	// the old renderer may have drawn into the rigid buffers.
+	rigid_mesh_state.reset();
+	sprite_state.reset();
+	sdf_state.reset();
 
 	set_inherited_dirty(this);
 	set_dirty();
@@ -679,10 +818,16 @@ void VGPath::set_dirty(bool p_children) {
 	}
 
 	dirty = true;
+	tove_fingerprint_valid = false;
 	_change_notify("path_shape");
 	update();
 }
 
+void VGPath::set_sprite_texture(const Ref<Texture> &p_texture) {
+	texture = p_texture;
+	update();
+}
+
 bool VGPath::is_empty() const {
 	const int n = tove_path->getNumSubpaths();
 	for (int i = 0; i < n; i++) {
@@ -713,6 +858,60 @@ tove::GraphicsRef VGPath::get_subtree_graphics() const {
 	return subtree_graphics;
 }
 
+void VGPath::update_tove_fingerprints() const {
+	if (!tove_fingerprint_valid) {
+		tove_fingerprint = tove_path_fingerprint(tove_path);
+		tove_paint_fingerprint = ::tove_paint_fingerprint(tove_path);
+		tove_fingerprint_valid = true;
+	}
+}
+
+uint64_t VGPath::get_tove_fingerprint() const {
+	update_tove_fingerprints();
+	return tove_fingerprint;
+}
+
+uint64_t VGPath::get_tove_paint_fingerprint() const {
+	update_tove_fingerprints();
+	return tove_paint_fingerprint;
+}
+
+tove::MeshRef VGPath::get_cached_tesselation(uint64_t p_key, uint64_t &r_paint_key) {
+	for (int i = 0; i < TESSELATION_CACHE_SIZE; i++) {
+		TesselationCacheEntry &entry = tesselation_cache[i];
+		if (entry.mesh && entry.key == p_key) {
+			if (i > 0) {
+				SWAP(entry, tesselation_cache[0]);
+			}
+			r_paint_key = tesselation_cache[0].paint_key;
+			return tesselation_cache[0].mesh;
+		}
+	}
+	return tove::MeshRef();
+}
+
+void VGPath::set_cached_tesselation(uint64_t p_key, uint64_t p_paint_key, const tove::MeshRef &p_mesh) {
+	for (int i = 0; i < TESSELATION_CACHE_SIZE; i++) {
+		TesselationCacheEntry &entry = tesselation_cache[i];
+		if (entry.mesh && entry.key == p_key) {
+			// recolored, replace in place.
+			if (i > 0) {
+				SWAP(entry, tesselation_cache[0]);
+			}
+			tesselation_cache[0].paint_key = p_paint_key;
+			tesselation_cache[0].mesh = p_mesh;
+			return;
+		}
+	}
+
+	for (int i = TESSELATION_CACHE_SIZE - 1; i > 0; i--) {
+		tesselation_cache[i] = tesselation_cache[i - 1];
+	}
+	tesselation_cache[0].key = p_key;
+	tesselation_cache[0].paint_key = p_paint_key;
+	tesselation_cache[0].mesh = p_mesh;
+}
+
 Node2D *VGPath::create_mesh_node() {
 
 	Ref<VGRenderer> renderer = get_inherited_renderer();
@@ -749,7 +948,7 @@ Node2D *VGPath::create_mesh_node() {
 				mesh_inst->set_texture(texture);
 			}
 
-			mesh_inst->set_transform(get_transform());
+			mesh_inst->set_transform(get_transform() * get_mesh_position_transform(mesh));
 			mesh_inst->set_name(get_name());
 			return mesh_inst;
 		}
@@ -770,7 +969,11 @@ void VGPath::set_tove_path(tove::PathRef p_path) {
 	set_dirty();
 }*/
 
-VGPath::VGPath() {
+VGPath::VGPath() :
+		tove_fingerprint(0),
+		tove_paint_fingerprint(0),
+		tove_fingerprint_valid(false),
+		lod_level(-1) {
 	tove_path = tove::tove_make_shared<tove::Path>();
 	set_notify_transform(true);
 
@@ -792,7 +995,11 @@ VGPath::VGPath() {
 	set_dirty();
 }
 
-VGPath::VGPath(tove::PathRef p_path) {
+VGPath::VGPath(tove::PathRef p_path) :
+		tove_fingerprint(0),
+		tove_paint_fingerprint(0),
+		tove_fingerprint_valid(false),
+		lod_level(-1) {
 	set_notify_transform(true);
 	set_tove_path(p_path);
 }
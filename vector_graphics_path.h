@@ -9,6 +9,10 @@
 #include "scene/2d/mesh_instance_2d.h"
 #include "vector_graphics_paint.h"
 #include "vector_graphics_renderer.h"
+#include "vector_graphics_mesh_renderer.h"
+#include "vector_graphics_rigid_renderer.h"
+#include "vector_graphics_texture_renderer.h"
+#include "vector_graphics_sdf_renderer.h"
 
 class VGPath : public Node2D {
 	GDCLASS(VGPath, Node2D);
@@ -17,10 +21,37 @@ class VGPath : public Node2D {
 	tove::PathRef tove_path;
 	Ref<ArrayMesh> mesh;
 	Ref<Texture> texture;
+	Ref<Material> renderer_material;
 
 	mutable tove::GraphicsRef subtree_graphics;
 	bool dirty;
 
+	struct TesselationCacheEntry {
+		uint64_t key;
+		uint64_t paint_key;
+		tove::MeshRef mesh;
+	};
+
+	// the last few tesselations of this path, most recent first. lod
+	// renderers keep one entry per level.
+	enum { TESSELATION_CACHE_SIZE = VG_MAX_LOD_LEVELS + 1 };
+	TesselationCacheEntry tesselation_cache[TESSELATION_CACHE_SIZE];
+
+	mutable uint64_t tove_fingerprint;
+	mutable uint64_t tove_paint_fingerprint;
+	mutable bool tove_fingerprint_valid;
+
+	void update_tove_fingerprints() const;
+
+	VGMeshAssembly mesh_assembly;
+	VGRigidMeshState rigid_mesh_state;
+	VGSpriteState sprite_state;
+	VGSDFState sdf_state;
+
+	int lod_level;
+	// the canvas basis the root last picked lod levels for, without origin.
+	Transform2D lod_canvas_basis;
+
 	Ref<VGPaint> fill_color;
 	Ref<VGPaint> line_color;
 	Ref<VGRenderer> renderer;
@@ -29,12 +60,20 @@ class VGPath : public Node2D {
 	static void compose_graphics(const tove::GraphicsRef &p_tove_graphics,
 	const Transform2D &p_transform, const Node *p_node);
 	static void _transform_changed(Node *p_node);
+	static bool subtree_uses_lod(Node *p_node);
+	static void update_subtree_lod_levels(Node *p_node);
 
 	bool inherits_renderer() const;
 
 	tove::GraphicsRef create_tove_graphics() const;
 	void add_tove_path(const tove::GraphicsRef &p_tove_graphics) const;
 	void update_mesh_representation();
+	// applies renderer_material, unless the node has a material of its own.
+	void update_canvas_material();
+	bool uses_lod();
+	void update_lod_processing();
+	bool update_lod_level();
+	void lod_level_changed();
 
 	void update_tove_fill_color();
 	void update_tove_line_color();
@@ -87,7 +126,21 @@ public:
 	tove::PathRef get_tove_path() const;
     tove::GraphicsRef get_subtree_graphics() const;
 
+	uint64_t get_tove_fingerprint() const;
+	uint64_t get_tove_paint_fingerprint() const;
+	VGMeshAssembly &get_mesh_assembly() { return mesh_assembly; }
+	VGRigidMeshState &get_rigid_mesh_state() { return rigid_mesh_state; }
+	VGSpriteState &get_sprite_state() { return sprite_state; }
+	VGSDFState &get_sdf_state() { return sdf_state; }
+	int get_lod_level();
+
+	// looks up a tesselation by geometry key; r_paint_key tells which colors it carries.
+	tove::MeshRef get_cached_tesselation(uint64_t p_key, uint64_t &r_paint_key);
+	void set_cached_tesselation(uint64_t p_key, uint64_t p_paint_key, const tove::MeshRef &p_mesh);
+
 	void set_dirty(bool p_children = false);
+	// shows a texture that was rasterized in the background, without re-rendering.
+	void set_sprite_texture(const Ref<Texture> &p_texture);
 	void set_tove_path(tove::PathRef p_path);
 	void recenter();
 
@@ -21,8 +21,21 @@ public:
 
 	virtual Rect2 render_mesh(Ref<ArrayMesh> &p_mesh, Ref<Material> &r_material, Ref<Texture> &r_texture, VGPath *p_path, bool p_hq, bool p_spatial) { return Rect2(); }
 	virtual Ref<ImageTexture> render_texture(VGPath *p_path, bool p_hq) { return Ref<ImageTexture>(); }
+	// paths draw with this material, unless they have a material of their own.
+	virtual Ref<Material> get_canvas_material(VGPath *p_path) { return Ref<Material>(); }
+	// renderers that draw paths in pieces of their own return true, the
+	// path then skips drawing its mesh.
+	virtual bool draw_path(VGPath *p_path) { return false; }
+
+	// camera moves send no notifications, so paths that depend on what is
+	// in view call update_viewport() every frame. true means draw again.
+	virtual bool is_viewport_dependent(VGPath *p_path) { return false; }
+	virtual bool update_viewport(VGPath *p_path) { return false; }
 
 	virtual bool is_dirty_on_transform_change() const = 0;
+	// asked on transform changes that did not make the path dirty already.
+	// true means the path needs to render again, for its new global scale.
+	virtual bool is_dirty_on_scale_change(VGPath *p_path) { return false; }
 };
 
 #endif // VG_RENDERER_H
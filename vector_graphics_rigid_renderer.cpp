@@ -0,0 +1,325 @@
+/*************************************************************************/
+/*  vg_rigid_renderer.cpp                                                */
+/*************************************************************************/
+
+#include "vector_graphics_rigid_renderer.h"
+#include "vector_graphics_path.h"
+#include "tove2d/src/cpp/mesh/meshifier.h"
+#include "core/hashfuncs.h"
+
+void VGRigidMeshState::reset() {
+	tove_mesh = tove::MeshRef();
+	generation++;
+}
+
+VGRigidMeshState::VGRigidMeshState() :
+		topology_key(0),
+		geometry_key(0),
+		paint_key(0),
+		generation(1),
+		front(1) {
+	buffer_generation[0] = 0;
+	buffer_generation[1] = 0;
+}
+
+VGRigidMeshRenderer::VGRigidMeshRenderer() :
+		subdivisions(3),
+		holes(HOLES_CW),
+		aabb_margin(0.25),
+		vertex_updates(0),
+		surface_rebuilds(0) {
+	create_tesselator();
+}
+
+tove::TesselatorRef VGRigidMeshRenderer::new_tesselator() const {
+	return tove::tove_make_shared<tove::RigidTesselator>(
+		subdivisions, (ToveHoles)holes);
+}
+
+void VGRigidMeshRenderer::create_tesselator() {
+	set_tesselator(new_tesselator());
+}
+
+uint64_t VGRigidMeshRenderer::get_topology_fingerprint(const tove::GraphicsRef &p_graphics, uint64_t p_hash) {
+	// everything the rigid flattener derives its vertex counts from.
+	const int n = p_graphics->getNumPaths();
+	p_hash = hash_djb2_one_64(n, p_hash);
+
+	for (int i = 0; i < n; i++) {
+		const tove::PathRef path = p_graphics->getPath(i);
+		const tove::NSVGshape *shape = path->getNSVG();
+
+		p_hash = hash_djb2_one_64(shape->flags, p_hash);
+		p_hash = hash_djb2_one_64(shape->fill.type, p_hash);
+		p_hash = hash_djb2_one_64(path->hasStroke() ? 1 : 0, p_hash);
+		p_hash = hash_djb2_one_64(path->getLineJoin() == TOVE_LINEJOIN_MITER && path->getMiterLimit() > 0.0f ? 1 : 0, p_hash);
+
+		for (const tove::NSVGpath *subpath = shape->paths; subpath; subpath = subpath->next) {
+			p_hash = hash_djb2_one_64(subpath->npts, p_hash);
+		}
+	}
+
+	return p_hash;
+}
+
+bool VGRigidMeshRenderer::update_state(VGRigidMeshState &p_state, const tove::GraphicsRef &p_graphics, uint32_t p_compress_flags) {
+	uint64_t topology = hash_djb2_one_64(tesselator_serial);
+	topology = hash_djb2_one_64(p_compress_flags, topology);
+	topology = get_topology_fingerprint(p_graphics, topology);
+
+	uint64_t geometry = 5381;
+	uint64_t paint = 5381;
+	const int n = p_graphics->getNumPaths();
+	for (int i = 0; i < n; i++) {
+		const tove::PathRef path = p_graphics->getPath(i);
+		geometry = tove_path_fingerprint(path, geometry);
+		paint = tove_paint_fingerprint(path, paint);
+	}
+
+	ToveMeshUpdateFlags update = 0;
+	if (!p_state.tove_mesh || topology != p_state.topology_key) {
+		p_state.reset();
+		p_state.tove_mesh = tove::tove_make_shared<tove::ColorMesh>();
+		update = UPDATE_MESH_EVERYTHING;
+	} else {
+		if (geometry != p_state.geometry_key) {
+			// the triangle cache gets to decide whether the old triangles still fit.
+			update |= UPDATE_MESH_VERTICES | UPDATE_MESH_AUTO_TRIANGLES;
+		}
+		if (paint != p_state.paint_key) {
+			update |= UPDATE_MESH_COLORS;
+		}
+	}
+
+	p_state.topology_key = topology;
+	p_state.geometry_key = geometry;
+	p_state.paint_key = paint;
+
+	if (update == 0) {
+		return false;
+	}
+
+	const tove::MeshRef &tove_mesh = p_state.tove_mesh;
+	const ToveMeshUpdateFlags updated = tesselator->graphicsToMesh(
+			p_graphics.get(), update, tove_mesh, tove_mesh);
+
+	const int vertex_count = tove_mesh->getVertexCount();
+	if (vertex_count != p_state.vertices.size()) {
+		p_state.vertices.resize(vertex_count);
+		p_state.colors.resize(vertex_count);
+		p_state.generation++;
+	}
+
+	if (vertex_count > 0) {
+		const int stride = sizeof(float) * 2 + 4;
+		Vector<uint8_t> &buffer = p_state.staging_vertices;
+		buffer.resize(vertex_count * stride);
+		tove_mesh->copyVertexData(buffer.ptrw(), vertex_count * stride);
+
+		PoolVector3Array::Write wv = p_state.vertices.write();
+		PoolColorArray::Write wc = p_state.colors.write();
+		const uint8_t *src = buffer.ptr();
+		for (int i = 0; i < vertex_count; i++) {
+			const uint8_t *p = src + i * stride;
+			wv[i] = tove_vertex_to_vector3((const float *)p);
+			wc[i] = tove_color_to_color(p + 2 * sizeof(float));
+		}
+	}
+
+	if (updated & UPDATE_MESH_TRIANGLES) {
+		const int index_count = tove_mesh->getIndexCount();
+		Vector<ToveVertexIndex> &triangles = p_state.staging_indices;
+		triangles.resize(index_count);
+		tove_mesh->copyIndexData(triangles.ptrw(), index_count);
+
+		p_state.indices.resize(index_count);
+		PoolIntArray::Write wi = p_state.indices.write();
+		for (int i = 0; i < index_count; i++) {
+			wi[i] = triangles[i];
+		}
+		p_state.generation++;
+	}
+
+	return true;
+}
+
+void VGRigidMeshRenderer::upload(VGRigidMeshState &p_state, uint32_t p_compress_flags) {
+	// the front buffer may still be in flight, so this frame goes to the other one.
+	const int back = 1 - p_state.front;
+	Ref<ArrayMesh> &mesh = p_state.buffers[back];
+	if (mesh.is_null()) {
+		mesh.instance();
+	}
+
+	const int n = p_state.vertices.size();
+	bool rebuild = p_state.buffer_generation[back] != p_state.generation ||
+				   mesh->get_surface_count() != 1 ||
+				   mesh->surface_get_array_len(0) != n;
+
+	if (!rebuild) {
+		// region updates leave the aabb alone, vertices outside it would get culled.
+		const AABB &aabb = p_state.buffer_aabb[back];
+		PoolVector3Array::Read r = p_state.vertices.read();
+		for (int i = 0; i < n; i++) {
+			if (!aabb.has_point(r[i])) {
+				rebuild = true;
+				break;
+			}
+		}
+	}
+
+	if (!rebuild && update_mesh_vertices(mesh, 0, p_state.vertices, p_state.colors, 0, n)) {
+		vertex_updates++;
+	} else {
+		clear_mesh(mesh);
+		set_mesh_position_transform(mesh, Transform2D());
+		p_state.buffer_generation[back] = p_state.generation;
+		p_state.buffer_aabb[back] = AABB();
+		surface_rebuilds++;
+
+		if (p_state.indices.size() >= 3) {
+			Array arr;
+			ERR_FAIL_COND(arr.resize(Mesh::ARRAY_MAX) != OK);
+			if (p_compress_flags & Mesh::ARRAY_FLAG_USE_2D_VERTICES) {
+				PoolVector2Array vertices_2d;
+				ERR_FAIL_COND(vertices_2d.resize(n) != OK);
+				{
+					PoolVector2Array::Write w = vertices_2d.write();
+					PoolVector3Array::Read r = p_state.vertices.read();
+					for (int i = 0; i < n; i++) {
+						w[i] = Vector2(r[i].x, r[i].y);
+					}
+				}
+				if (is_bounds_relative(p_compress_flags)) {
+					// the same margin as the aabb, so moves within it fit.
+					set_mesh_position_transform(mesh, encode_mesh_positions(vertices_2d, aabb_margin));
+				}
+				arr[Mesh::ARRAY_VERTEX] = vertices_2d;
+			} else {
+				arr[Mesh::ARRAY_VERTEX] = p_state.vertices;
+			}
+			arr[Mesh::ARRAY_COLOR] = p_state.colors;
+			arr[Mesh::ARRAY_INDEX] = p_state.indices;
+			uint32_t flags = p_compress_flags;
+			if (!is_bounds_relative(flags)) {
+				flags = fit_compress_flags(flags, p_state.vertices);
+			}
+			mesh->add_surface_from_arrays(Mesh::PRIMITIVE_TRIANGLES, arr, Array(), flags & ~Mesh::ARRAY_FLAG_USE_2D_VERTICES);
+
+			// padded, so that moderate motion still fits without a new surface.
+			AABB aabb = mesh_aabb_to_positions(mesh, mesh->surface_get_aabb(0));
+			aabb.grow_by(aabb_margin * MAX(aabb.size.x, aabb.size.y));
+			mesh->set_custom_aabb(positions_aabb_to_mesh(mesh, aabb));
+			p_state.buffer_aabb[back] = aabb;
+			count_upload(mesh, p_compress_flags);
+		}
+	}
+
+	p_state.front = back;
+}
+
+void VGRigidMeshRenderer::pin_keyframes(VGRigidMeshState &p_state, const Vector<tove::GraphicsRef> &p_keyframes) {
+	ERR_FAIL_COND(!tesselator);
+
+	const uint32_t compress_flags = get_compress_flags(false);
+	for (int i = 0; i < p_keyframes.size(); i++) {
+		update_state(p_state, p_keyframes[i], compress_flags);
+		// pinned triangulations are never evicted from the cache.
+		p_state.tove_mesh->cache(true);
+	}
+}
+
+Ref<ArrayMesh> VGRigidMeshRenderer::render_graphics(VGRigidMeshState &p_state, const tove::GraphicsRef &p_graphics) {
+	ERR_FAIL_COND_V(!tesselator, Ref<ArrayMesh>());
+
+	const uint32_t compress_flags = get_compress_flags(false);
+	if (update_state(p_state, p_graphics, compress_flags) || p_state.buffers[p_state.front].is_null()) {
+		upload(p_state, compress_flags);
+	}
+
+	return p_state.buffers[p_state.front];
+}
+
+Rect2 VGRigidMeshRenderer::render_mesh(Ref<ArrayMesh> &p_mesh, Ref<Material> &r_material, Ref<Texture> &r_texture, VGPath *p_path, bool p_hq, bool p_spatial) {
+	ERR_FAIL_COND_V(!tesselator, Rect2());
+
+	tove::GraphicsRef graphics = p_path->get_subtree_graphics();
+
+	if (p_hq || p_spatial) {
+		// exported meshes are snapshots and must not share the animated buffers.
+		clear_mesh(p_mesh);
+
+		tove::MeshRef tove_mesh = tove::tove_make_shared<tove::ColorMesh>();
+		tesselator->graphicsToMesh(graphics.get(), UPDATE_MESH_EVERYTHING, tove_mesh, tove_mesh);
+
+		const uint32_t compress_flags = get_compress_flags(p_spatial);
+		r_material = copy_mesh(p_mesh, tove_mesh, tove::GraphicsRef(), r_texture, p_spatial, direct_upload, compress_flags);
+		count_upload(p_mesh, compress_flags);
+	} else {
+		VGRigidMeshState &state = p_path->get_rigid_mesh_state();
+
+		// another renderer might have drawn into our front buffer meanwhile.
+		if (p_mesh != state.buffers[state.front]) {
+			state.reset();
+		}
+
+		p_mesh = render_graphics(state, graphics);
+		r_material = Ref<Material>();
+	}
+
+	return tove_bounds_to_rect2(p_path->get_tove_path()->getBounds());
+}
+
+int VGRigidMeshRenderer::get_subdivisions() const {
+	return subdivisions;
+}
+
+void VGRigidMeshRenderer::set_subdivisions(int p_subdivisions) {
+	subdivisions = CLAMP(p_subdivisions, 0, 8);
+	create_tesselator();
+	emit_changed();
+}
+
+VGRigidMeshRenderer::Holes VGRigidMeshRenderer::get_holes() const {
+	return holes;
+}
+
+void VGRigidMeshRenderer::set_holes(Holes p_holes) {
+	holes = p_holes;
+	create_tesselator();
+	emit_changed();
+}
+
+float VGRigidMeshRenderer::get_aabb_margin() const {
+	return aabb_margin;
+}
+
+void VGRigidMeshRenderer::set_aabb_margin(float p_aabb_margin) {
+	aabb_margin = MAX(0.0f, p_aabb_margin);
+}
+
+void VGRigidMeshRenderer::reset_update_counters() {
+	vertex_updates = 0;
+	surface_rebuilds = 0;
+}
+
+void VGRigidMeshRenderer::_bind_methods() {
+	ClassDB::bind_method(D_METHOD("set_subdivisions", "subdivisions"), &VGRigidMeshRenderer::set_subdivisions);
+	ClassDB::bind_method(D_METHOD("get_subdivisions"), &VGRigidMeshRenderer::get_subdivisions);
+	ClassDB::bind_method(D_METHOD("set_holes", "holes"), &VGRigidMeshRenderer::set_holes);
+	ClassDB::bind_method(D_METHOD("get_holes"), &VGRigidMeshRenderer::get_holes);
+	ClassDB::bind_method(D_METHOD("set_aabb_margin", "margin"), &VGRigidMeshRenderer::set_aabb_margin);
+	ClassDB::bind_method(D_METHOD("get_aabb_margin"), &VGRigidMeshRenderer::get_aabb_margin);
+
+	ClassDB::bind_method(D_METHOD("get_vertex_updates"), &VGRigidMeshRenderer::get_vertex_updates);
+	ClassDB::bind_method(D_METHOD("get_surface_rebuilds"), &VGRigidMeshRenderer::get_surface_rebuilds);
+	ClassDB::bind_method(D_METHOD("reset_update_counters"), &VGRigidMeshRenderer::reset_update_counters);
+
+	ADD_PROPERTY(PropertyInfo(Variant::INT, "subdivisions", PROPERTY_HINT_RANGE, "0,8,1"), "set_subdivisions", "get_subdivisions");
+	ADD_PROPERTY(PropertyInfo(Variant::INT, "holes", PROPERTY_HINT_ENUM, "None,CW,CCW"), "set_holes", "get_holes");
+	ADD_PROPERTY(PropertyInfo(Variant::REAL, "aabb_margin", PROPERTY_HINT_RANGE, "0,2,0.01"), "set_aabb_margin", "get_aabb_margin");
+
+	BIND_ENUM_CONSTANT(HOLES_NONE);
+	BIND_ENUM_CONSTANT(HOLES_CW);
+	BIND_ENUM_CONSTANT(HOLES_CCW);
+}
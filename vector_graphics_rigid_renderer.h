@@ -0,0 +1,100 @@
+/*************************************************************************/
+/*  vg_rigid_renderer.h                                                  */
+/*************************************************************************/
+
+#ifndef VG_RIGID_RENDERER_H
+#define VG_RIGID_RENDERER_H
+
+#include "vector_graphics_mesh_renderer.h"
+
+// what VGRigidMeshRenderer keeps on a path between frames: one tove mesh
+// that gets updated in place, and two surfaces that take turns, so that a
+// frame never writes into the vertex buffer the last frame is drawn from.
+struct VGRigidMeshState {
+	tove::MeshRef tove_mesh;
+	uint64_t topology_key;
+	uint64_t geometry_key;
+	uint64_t paint_key;
+
+	PoolVector3Array vertices;
+	PoolColorArray colors;
+	PoolIntArray indices;
+	// raw tove data, kept around so that frames do not allocate.
+	Vector<uint8_t> staging_vertices;
+	Vector<ToveVertexIndex> staging_indices;
+	// bumped whenever vertex count or indices change. buffers that were
+	// built for an older generation need a new surface.
+	uint64_t generation;
+
+	Ref<ArrayMesh> buffers[2];
+	uint64_t buffer_generation[2];
+	AABB buffer_aabb[2];
+	int front;
+
+	void reset();
+
+	VGRigidMeshState();
+};
+
+class VGRigidMeshRenderer : public VGAbstractMeshRenderer {
+	GDCLASS(VGRigidMeshRenderer, VGAbstractMeshRenderer);
+
+public:
+	// same order as ToveHoles.
+	enum Holes {
+		HOLES_NONE,
+		HOLES_CW,
+		HOLES_CCW,
+	};
+
+private:
+	int subdivisions;
+	Holes holes;
+	float aabb_margin;
+
+	uint64_t vertex_updates;
+	uint64_t surface_rebuilds;
+
+	bool update_state(VGRigidMeshState &p_state, const tove::GraphicsRef &p_graphics, uint32_t p_compress_flags);
+	void upload(VGRigidMeshState &p_state, uint32_t p_compress_flags);
+
+protected:
+	void create_tesselator();
+	virtual tove::TesselatorRef new_tesselator() const;
+
+	static void _bind_methods();
+
+public:
+	int get_subdivisions() const;
+	void set_subdivisions(int p_subdivisions);
+
+	Holes get_holes() const;
+	void set_holes(Holes p_holes);
+
+	float get_aabb_margin() const;
+	void set_aabb_margin(float p_aabb_margin);
+
+	// frames that only rewrote vertices of an existing surface.
+	int get_vertex_updates() const { return vertex_updates; }
+	// frames that had to create a new surface.
+	int get_surface_rebuilds() const { return surface_rebuilds; }
+	void reset_update_counters();
+
+	// hashes everything the rigid flattener derives vertex counts from. graphics
+	// with the same topology fingerprint can be interpolated into each other.
+	static uint64_t get_topology_fingerprint(const tove::GraphicsRef &p_graphics, uint64_t p_hash = 5381);
+
+	// tesselates the keyframes one after another and pins their triangulations
+	// in the triangle caches, so that shapes in between can reuse them.
+	void pin_keyframes(VGRigidMeshState &p_state, const Vector<tove::GraphicsRef> &p_keyframes);
+	// brings the state up to date with p_graphics and returns the surface to draw.
+	Ref<ArrayMesh> render_graphics(VGRigidMeshState &p_state, const tove::GraphicsRef &p_graphics);
+
+	virtual Rect2 render_mesh(Ref<ArrayMesh> &p_mesh, Ref<Material> &r_material, Ref<Texture> &r_texture, VGPath *p_path, bool p_hq, bool p_spatial = false);
+
+	VGRigidMeshRenderer();
+};
+
+VARIANT_ENUM_CAST(VGRigidMeshRenderer::Holes);
+
+#endif // VG_RIGID_RENDERER_H
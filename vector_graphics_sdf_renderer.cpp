@@ -0,0 +1,825 @@
+/*************************************************************************/
+/*  vg_sdf_renderer.cpp                                                  */
+/*************************************************************************/
+
+#include "vector_graphics_sdf_renderer.h"
+#include "vector_graphics_path.h"
+#include "core/hashfuncs.h"
+#include "core/os/os.h"
+#include "core/os/thread_work_pool.h"
+
+#include <float.h>
+
+// curves get flattened to within this many texels.
+#define VG_SDF_FLATNESS 0.05
+// rows per work item. bands pay for walking all edges of their layer.
+#define VG_SDF_BAND_ROWS 32
+// larger atlases fail instead of asking the gpu for something it can't do.
+#define VG_SDF_MAX_ATLAS_SIZE 16384
+
+// clang-format off
+static const char *sdf_shader_code = R"GLSL(
+shader_type canvas_item;
+
+uniform float distance_range = 4.0;
+
+float median3(vec3 v) {
+	return max(min(v.r, v.g), min(max(v.r, v.g), v.b));
+}
+
+void fragment()
+{
+	vec3 msd = texture(TEXTURE, UV).rgb;
+	// texels of distance per screen pixel, never less than one texel
+	// per pixel, so that minified edges do not alias.
+	vec2 unit_range = vec2(2.0 * distance_range) * TEXTURE_PIXEL_SIZE;
+	vec2 screen_size = vec2(1.0) / fwidth(UV);
+	float screen_range = max(0.5 * dot(unit_range, screen_size), 1.0);
+	float alpha = clamp(screen_range * (median3(msd) - 0.5) + 0.5, 0.0, 1.0);
+	COLOR = vec4(COLOR.rgb, COLOR.a * alpha);
+}
+)GLSL";
+// clang-format on
+
+static Ref<Shader> sdf_shader;
+
+Ref<Shader> get_sdf_shader() {
+	if (sdf_shader.is_null()) {
+		sdf_shader.instance();
+		sdf_shader->set_code(sdf_shader_code);
+	}
+	return sdf_shader;
+}
+
+void free_sdf_shader() {
+	sdf_shader.unref();
+}
+
+enum {
+	SDF_RED = 1,
+	SDF_GREEN = 2,
+	SDF_BLUE = 4,
+	SDF_WHITE = SDF_RED | SDF_GREEN | SDF_BLUE,
+};
+
+struct SDFSegment {
+	Vector2 a;
+	Vector2 b;
+	// channels of the edge this segment belongs to.
+	uint8_t channels;
+	// segments at corners measure past their end to the extended line, which
+	// is what keeps corners sharp in the median of the three channels.
+	bool extend_start;
+	bool extend_end;
+	// 1 if the side with a positive cross product is inside, else -1.
+	float orientation;
+};
+
+struct SDFLayer {
+	Vector<SDFSegment> segments;
+	bool stroke;
+	// in texels, for strokes.
+	float half_width;
+	bool even_odd;
+
+	// placement in the atlas, in texels.
+	int x;
+	int y;
+	int width;
+	int height;
+
+	Rect2 rect;
+	Color color;
+};
+
+struct SDFCrossing {
+	float x;
+	int winding;
+
+	bool operator<(const SDFCrossing &p_other) const {
+		return x < p_other.x;
+	}
+};
+
+static inline float cross2(const Vector2 &p_a, const Vector2 &p_b) {
+	return p_a.x * p_b.y - p_a.y * p_b.x;
+}
+
+// flattens a subpath into a polyline, with segment counts after Wang's formula.
+static void flatten_subpath(const tove::SubpathRef &p_subpath, float p_tolerance, Vector<Vector2> &r_points) {
+	r_points.clear();
+
+	const int n = p_subpath->getNumPoints();
+	if (n < 1) {
+		return;
+	}
+	const float *pts = p_subpath->getPoints();
+	r_points.push_back(Vector2(pts[0], pts[1]));
+
+	for (int i = 0; i + 3 < n; i += 3) {
+		const Vector2 p0 = Vector2(pts[2 * i + 0], pts[2 * i + 1]);
+		const Vector2 p1 = Vector2(pts[2 * i + 2], pts[2 * i + 3]);
+		const Vector2 p2 = Vector2(pts[2 * i + 4], pts[2 * i + 5]);
+		const Vector2 p3 = Vector2(pts[2 * i + 6], pts[2 * i + 7]);
+
+		const float m = MAX((p0 - p1 * 2 + p2).length(), (p1 - p2 * 2 + p3).length());
+		const int steps = CLAMP(int(Math::ceil(Math::sqrt(0.75f * m / p_tolerance))), 1, 256);
+
+		for (int j = 1; j <= steps; j++) {
+			const float t = j / float(steps);
+			const float u = 1 - t;
+			r_points.push_back(p0 * (u * u * u) + p1 * (3 * u * u * t) + p2 * (3 * u * t * t) + p3 * (t * t * t));
+		}
+	}
+
+	// drop zero length segments, they have no direction.
+	int k = 1;
+	for (int i = 1; i < r_points.size(); i++) {
+		if (r_points[i].distance_squared_to(r_points[k - 1]) > p_tolerance * p_tolerance * 1e-4f) {
+			r_points.write[k++] = r_points[i];
+		}
+	}
+	r_points.resize(k);
+}
+
+static int get_winding(const Vector<SDFSegment> &p_segments, const Vector2 &p_point) {
+	int winding = 0;
+	for (int i = 0; i < p_segments.size(); i++) {
+		const Vector2 &a = p_segments[i].a;
+		const Vector2 &b = p_segments[i].b;
+		if ((a.y <= p_point.y) != (b.y <= p_point.y)) {
+			const float x = a.x + (p_point.y - a.y) * (b.x - a.x) / (b.y - a.y);
+			if (x > p_point.x) {
+				winding += b.y > a.y ? 1 : -1;
+			}
+		}
+	}
+	return winding;
+}
+
+static inline bool is_inside(int p_winding, bool p_even_odd) {
+	return p_even_odd ? (p_winding & 1) != 0 : p_winding != 0;
+}
+
+// adds one contour of a fill, with msdfgen's simple edge coloring: corners
+// split the contour into edges, and neighbouring edges share exactly one
+// channel. contours with fewer than two corners stay white, that is, they
+// get a plain distance field.
+static void add_fill_contour(const Vector<Vector2> &p_points, Vector<SDFSegment> &r_segments, Vector<int> &r_contours) {
+	int n = p_points.size();
+	// closed subpaths end where they started, fills are closed anyway.
+	if (n > 1 && p_points[n - 1].is_equal_approx(p_points[0])) {
+		n--;
+	}
+	if (n < 3) {
+		return;
+	}
+
+	// a tangent change of more than about 8 degrees, like msdfgen.
+	const float corner_sin = Math::sin(3.0);
+	Vector<bool> corners;
+	corners.resize(n);
+	int num_corners = 0;
+	for (int i = 0; i < n; i++) {
+		const Vector2 u = (p_points[i] - p_points[(i + n - 1) % n]).normalized();
+		const Vector2 v = (p_points[(i + 1) % n] - p_points[i]).normalized();
+		corners.write[i] = u.dot(v) <= 0 || ABS(cross2(u, v)) > corner_sin;
+		num_corners += corners[i] ? 1 : 0;
+	}
+
+	r_contours.push_back(r_segments.size());
+	if (num_corners < 2) {
+		for (int i = 0; i < n; i++) {
+			SDFSegment s;
+			s.a = p_points[i];
+			s.b = p_points[(i + 1) % n];
+			s.channels = SDF_WHITE;
+			s.extend_start = false;
+			s.extend_end = false;
+			s.orientation = 1;
+			r_segments.push_back(s);
+		}
+	} else {
+		static const uint8_t colors[3] = {
+			SDF_GREEN | SDF_BLUE,
+			SDF_RED | SDF_BLUE,
+			SDF_RED | SDF_GREEN,
+		};
+
+		int start = 0;
+		while (!corners[start]) {
+			start++;
+		}
+
+		int edge = -1;
+		for (int k = 0; k < n; k++) {
+			const int i = (start + k) % n;
+			const bool corner_start = corners[i];
+			const bool corner_end = corners[(i + 1) % n];
+			if (corner_start) {
+				edge++;
+			}
+
+			// with one edge too many for the cycle, the last one would get the
+			// color of the first.
+			uint8_t channels = colors[edge % 3];
+			if (edge == num_corners - 1 && num_corners % 3 == 1) {
+				channels = colors[1];
+			}
+
+			SDFSegment s;
+			s.a = p_points[i];
+			s.b = p_points[(i + 1) % n];
+			s.channels = channels;
+			s.extend_start = corner_start;
+			s.extend_end = corner_end;
+			s.orientation = 1;
+			r_segments.push_back(s);
+		}
+	}
+}
+
+// contours may run either way, so this tests which side of the longest
+// segment of each contour is inside, once all contours are in.
+static void orient_fill_contours(Vector<SDFSegment> &r_segments, const Vector<int> &p_contours, bool p_even_odd) {
+	for (int c = 0; c < p_contours.size(); c++) {
+		const int contour = p_contours[c];
+		const int end = c + 1 < p_contours.size() ? p_contours[c + 1] : r_segments.size();
+
+		int longest = contour;
+		for (int i = contour; i < end; i++) {
+			if (r_segments[i].a.distance_squared_to(r_segments[i].b) > r_segments[longest].a.distance_squared_to(r_segments[longest].b)) {
+				longest = i;
+			}
+		}
+
+		const Vector2 a = r_segments[longest].a;
+		const Vector2 d = r_segments[longest].b - a;
+		const float length = d.length();
+		const Vector2 left = Vector2(-d.y, d.x) / length;
+		const Vector2 probe = a + d * 0.5 + left * MIN(0.01f, length * 0.1f);
+		const float orientation = is_inside(get_winding(r_segments, probe), p_even_odd) ? 1 : -1;
+
+		for (int i = contour; i < end; i++) {
+			r_segments.write[i].orientation = orientation;
+		}
+	}
+}
+
+static void add_stroke_contour(const Vector<Vector2> &p_points, bool p_closed, Vector<SDFSegment> &r_segments) {
+	const int n = p_points.size();
+	const int m = p_closed && n > 2 ? n : n - 1;
+	for (int i = 0; i < m; i++) {
+		SDFSegment s;
+		s.a = p_points[i];
+		s.b = p_points[(i + 1) % n];
+		s.channels = SDF_WHITE;
+		s.extend_start = false;
+		s.extend_end = false;
+		s.orientation = 1;
+		r_segments.push_back(s);
+	}
+	if (n == 1) {
+		// a dot, still drawn with round caps.
+		SDFSegment s;
+		s.a = p_points[0];
+		s.b = p_points[0];
+		s.channels = SDF_WHITE;
+		s.extend_start = false;
+		s.extend_end = false;
+		s.orientation = 1;
+		r_segments.push_back(s);
+	}
+}
+
+// tove's stops are srgb, layer colors end up as linear vertex colors like
+// tove_color_to_color() gives. stops are averaged after converting them.
+static Color get_average_color(const tove::PaintRef &p_paint, float p_opacity) {
+	const int n = p_paint->getNumColorStops();
+	Color sum = Color(0, 0, 0, 0);
+	for (int i = 0; i < n; i++) {
+		ToveRGBA rgba;
+		p_paint->getColorStop(i, rgba, p_opacity);
+		sum += Color(rgba.r, rgba.g, rgba.b, rgba.a).to_linear();
+	}
+	return n > 0 ? sum / n : sum;
+}
+
+class SDFGenerator {
+	struct Band {
+		int layer;
+		int y0;
+		int y1;
+	};
+
+	const Vector<SDFLayer> &layers;
+	Vector<Band> bands;
+	float range;
+	uint8_t *atlas;
+	int atlas_width;
+
+	void _generate_band(uint32_t p_index, void *p_userdata) {
+		const Band &band = bands[p_index];
+		const SDFLayer &layer = layers[band.layer];
+		const int w = layer.width;
+		const int rows = band.y1 - band.y0;
+
+		// per texel, the distance to the closest segment and to the closest
+		// segment of each channel, and signed distances for those.
+		Vector<float> distances;
+		Vector<float> signed_distances;
+		distances.resize(w * rows * 4);
+		signed_distances.resize(w * rows * 3);
+		float *dist = distances.ptrw();
+		float *sdist = signed_distances.ptrw();
+		for (int i = 0; i < w * rows * 4; i++) {
+			dist[i] = FLT_MAX;
+		}
+
+		const float reach = layer.half_width + range + 1;
+		const int n = layer.segments.size();
+
+		for (int i = 0; i < n; i++) {
+			const SDFSegment &s = layer.segments[i];
+			const int y0 = MAX(band.y0, int(Math::floor(MIN(s.a.y, s.b.y) - reach)));
+			const int y1 = MIN(band.y1, int(Math::ceil(MAX(s.a.y, s.b.y) + reach)));
+			const int x0 = MAX(0, int(Math::floor(MIN(s.a.x, s.b.x) - reach)));
+			const int x1 = MIN(w, int(Math::ceil(MAX(s.a.x, s.b.x) + reach)));
+
+			const Vector2 d = s.b - s.a;
+			const float dd = d.length_squared();
+			const float length = Math::sqrt(dd);
+
+			for (int y = y0; y < y1; y++) {
+				float *row = &dist[((y - band.y0) * w) * 4];
+				float *srow = &sdist[((y - band.y0) * w) * 3];
+
+				for (int x = x0; x < x1; x++) {
+					const Vector2 ap = Vector2(x + 0.5f, y + 0.5f) - s.a;
+					const float t = dd > 0 ? ap.dot(d) / dd : 0;
+					const float distance = (ap - d * CLAMP(t, 0.0f, 1.0f)).length();
+
+					float *p = &row[x * 4];
+					if (distance < p[0]) {
+						p[0] = distance;
+					}
+					if (layer.stroke) {
+						continue;
+					}
+
+					for (int c = 0; c < 3; c++) {
+						if (!(s.channels & (1 << c)) || distance >= p[1 + c]) {
+							continue;
+						}
+						p[1 + c] = distance;
+
+						const float perpendicular = length > 0 ? cross2(d, ap) / length : 0;
+						float sd;
+						if ((t >= 0 && t <= 1) || (t < 0 && s.extend_start) || (t > 1 && s.extend_end)) {
+							sd = perpendicular;
+						} else {
+							sd = perpendicular >= 0 ? distance : -distance;
+						}
+						srow[x * 3 + c] = sd * s.orientation;
+					}
+				}
+			}
+		}
+
+		Vector<SDFCrossing> crossings;
+		const float scale = 255.0f / (2 * range);
+
+		for (int y = band.y0; y < band.y1; y++) {
+			const float *row = &dist[((y - band.y0) * w) * 4];
+			const float *srow = &sdist[((y - band.y0) * w) * 3];
+			uint8_t *out = &atlas[((layer.y + y) * atlas_width + layer.x) * 3];
+
+			if (layer.stroke) {
+				for (int x = 0; x < w; x++) {
+					const float sd = CLAMP(layer.half_width - row[x * 4], -range, range);
+					const uint8_t v = uint8_t(Math::round(127.5f + sd * scale));
+					out[x * 3 + 0] = v;
+					out[x * 3 + 1] = v;
+					out[x * 3 + 2] = v;
+				}
+				continue;
+			}
+
+			const float yc = y + 0.5f;
+			crossings.clear();
+			for (int i = 0; i < n; i++) {
+				const Vector2 &a = layer.segments[i].a;
+				const Vector2 &b = layer.segments[i].b;
+				if ((a.y <= yc) != (b.y <= yc)) {
+					SDFCrossing crossing;
+					crossing.x = a.x + (yc - a.y) * (b.x - a.x) / (b.y - a.y);
+					crossing.winding = b.y > a.y ? 1 : -1;
+					crossings.push_back(crossing);
+				}
+			}
+			crossings.sort();
+
+			// crossings left of a texel add up to the winding of the texel, seen
+			// from the left instead of the right.
+			int k = 0;
+			int winding = 0;
+			for (int x = 0; x < w; x++) {
+				while (k < crossings.size() && crossings[k].x < x + 0.5f) {
+					winding += crossings[k++].winding;
+				}
+				const bool inside = is_inside(winding, layer.even_odd);
+
+				const float *p = &row[x * 4];
+				const float true_sd = inside ? MIN(p[0], range) : -MIN(p[0], range);
+
+				float sd[3];
+				for (int c = 0; c < 3; c++) {
+					sd[c] = p[1 + c] < FLT_MAX ? srow[x * 3 + c] : true_sd;
+				}
+
+				// channels that disagree with the fill about the texel fall back
+				// to the plain distance, instead of leaving speckles.
+				const float median = MAX(MIN(sd[0], sd[1]), MIN(MAX(sd[0], sd[1]), sd[2]));
+				if ((median > 0) != inside) {
+					sd[0] = sd[1] = sd[2] = true_sd;
+				}
+
+				for (int c = 0; c < 3; c++) {
+					out[x * 3 + c] = uint8_t(Math::round(127.5f + CLAMP(sd[c], -range, range) * scale));
+				}
+			}
+		}
+	}
+
+public:
+	SDFGenerator(const Vector<SDFLayer> &p_layers, float p_range, uint8_t *p_atlas, int p_atlas_width) :
+			layers(p_layers),
+			range(p_range),
+			atlas(p_atlas),
+			atlas_width(p_atlas_width) {
+
+		for (int i = 0; i < layers.size(); i++) {
+			for (int y = 0; y < layers[i].height; y += VG_SDF_BAND_ROWS) {
+				Band band;
+				band.layer = i;
+				band.y0 = y;
+				band.y1 = MIN(y + VG_SDF_BAND_ROWS, layers[i].height);
+				bands.push_back(band);
+			}
+		}
+	}
+
+	// without a pool, all bands run on the calling thread.
+	void run(ThreadWorkPool *p_pool) {
+		if (!p_pool || bands.size() <= 1) {
+			for (int i = 0; i < bands.size(); i++) {
+				_generate_band(i, nullptr);
+			}
+			return;
+		}
+
+		p_pool->do_work(bands.size(), this, &SDFGenerator::_generate_band, nullptr);
+	}
+};
+
+void VGSDFState::reset() {
+	content_key = 0;
+	layers.clear();
+	texture = Ref<ImageTexture>();
+}
+
+VGSDFState::VGSDFState() :
+		content_key(0) {
+}
+
+VGSDFRenderer::VGSDFRenderer() :
+		resolution(1),
+		distance_range(4),
+		thread_count(0),
+		generation_pool_threads(0),
+		last_generation_usec(0),
+		last_texture_bytes(0) {
+
+	material.instance();
+	material->set_shader(get_sdf_shader());
+	update_material();
+}
+
+VGSDFRenderer::~VGSDFRenderer() {
+	if (generation_pool_threads > 0) {
+		generation_pool.finish();
+	}
+}
+
+float VGSDFRenderer::get_resolution() const {
+	return resolution;
+}
+
+void VGSDFRenderer::set_resolution(float p_resolution) {
+	resolution = CLAMP(p_resolution, 0.01f, 64.0f);
+	emit_changed();
+}
+
+float VGSDFRenderer::get_distance_range() const {
+	return distance_range;
+}
+
+void VGSDFRenderer::set_distance_range(float p_distance_range) {
+	distance_range = CLAMP(p_distance_range, 1.0f, 32.0f);
+	update_material();
+	emit_changed();
+}
+
+int VGSDFRenderer::get_thread_count() const {
+	return thread_count;
+}
+
+void VGSDFRenderer::set_thread_count(int p_thread_count) {
+	thread_count = MAX(p_thread_count, 0);
+}
+
+void VGSDFRenderer::update_material() {
+	material->set_shader_param("distance_range", distance_range);
+}
+
+uint64_t VGSDFRenderer::get_content_key(const tove::GraphicsRef &p_graphics) const {
+	uint32_t bits[2];
+	memcpy(&bits[0], &resolution, sizeof(bits[0]));
+	memcpy(&bits[1], &distance_range, sizeof(bits[1]));
+	uint64_t key = hash_djb2_one_64(bits[0]);
+	key = hash_djb2_one_64(bits[1], key);
+
+	const int n = p_graphics->getNumPaths();
+	for (int i = 0; i < n; i++) {
+		const tove::PathRef &path = p_graphics->getPath(i);
+		key = tove_path_fingerprint(path, key);
+		key = tove_paint_fingerprint(path, key);
+	}
+
+	// 0 marks states that have not been generated yet.
+	return key != 0 ? key : 1;
+}
+
+void VGSDFRenderer::generate(VGSDFState &p_state, const tove::GraphicsRef &p_graphics) {
+	const uint64_t t0 = OS::get_singleton()->get_ticks_usec();
+
+	p_state.layers.clear();
+	p_state.texture = Ref<ImageTexture>();
+	last_texture_bytes = 0;
+
+	const float tolerance = VG_SDF_FLATNESS / resolution;
+	Vector<SDFLayer> layers;
+	Vector<Vector2> points;
+
+	for (int i = 0; i < p_graphics->getNumPaths(); i++) {
+		const tove::PathRef &path = p_graphics->getPath(i);
+
+		for (int pass = 0; pass < 2; pass++) {
+			const bool stroke = pass == 1;
+			if (stroke ? !(path->hasStroke() && path->getLineColor()) : !(path->hasFill() && path->getFillColor())) {
+				continue;
+			}
+
+			SDFLayer layer;
+			layer.stroke = stroke;
+			layer.half_width = stroke ? path->getLineWidth() * 0.5f * resolution : 0;
+			layer.even_odd = path->getFillRule() == TOVE_FILLRULE_EVEN_ODD;
+			layer.color = get_average_color(stroke ? path->getLineColor() : path->getFillColor(), path->getOpacity());
+
+			// flattened in path units first, the texel grid depends on the bounds.
+			Vector<int> contours;
+			Rect2 bounds;
+			bool has_bounds = false;
+			for (int j = 0; j < path->getNumSubpaths(); j++) {
+				const tove::SubpathRef subpath = path->getSubpath(j);
+				flatten_subpath(subpath, tolerance, points);
+				if (stroke) {
+					add_stroke_contour(points, subpath->isClosed(), layer.segments);
+				} else {
+					add_fill_contour(points, layer.segments, contours);
+				}
+				for (int k = 0; k < points.size(); k++) {
+					if (has_bounds) {
+						bounds.expand_to(points[k]);
+					} else {
+						bounds = Rect2(points[k], Size2());
+						has_bounds = true;
+					}
+				}
+			}
+			if (layer.segments.empty()) {
+				continue;
+			}
+
+			const int pad = Math::ceil(distance_range + layer.half_width) + 1;
+			const int ox = Math::floor(bounds.position.x * resolution) - pad;
+			const int oy = Math::floor(bounds.position.y * resolution) - pad;
+			layer.width = Math::ceil((bounds.position.x + bounds.size.x) * resolution) + pad - ox;
+			layer.height = Math::ceil((bounds.position.y + bounds.size.y) * resolution) + pad - oy;
+			layer.rect = Rect2(ox / resolution, oy / resolution, layer.width / resolution, layer.height / resolution);
+
+			const Vector2 origin = Vector2(ox, oy);
+			for (int k = 0; k < layer.segments.size(); k++) {
+				SDFSegment &s = layer.segments.write[k];
+				s.a = s.a * resolution - origin;
+				s.b = s.b * resolution - origin;
+			}
+			if (!stroke) {
+				orient_fill_contours(layer.segments, contours, layer.even_odd);
+			}
+
+			layers.push_back(layer);
+		}
+	}
+
+	if (layers.empty()) {
+		last_generation_usec = OS::get_singleton()->get_ticks_usec() - t0;
+		return;
+	}
+
+	// shelf packing, tallest layers first, with a texel of space between
+	// layers so that filtering never mixes neighbours.
+	Vector<int> order;
+	int total_area = 0;
+	int widest = 0;
+	for (int i = 0; i < layers.size(); i++) {
+		order.push_back(i);
+		total_area += (layers[i].width + 1) * (layers[i].height + 1);
+		widest = MAX(widest, layers[i].width + 1);
+	}
+	for (int i = 1; i < order.size(); i++) {
+		for (int j = i; j > 0 && layers[order[j - 1]].height < layers[order[j]].height; j--) {
+			SWAP(order.write[j - 1], order.write[j]);
+		}
+	}
+
+	const int atlas_width = MAX(widest, int(Math::ceil(Math::sqrt(float(total_area)))));
+	int atlas_height = 0;
+	{
+		int x = 0;
+		int shelf = 0;
+		for (int i = 0; i < order.size(); i++) {
+			SDFLayer &layer = layers.write[order[i]];
+			if (x + layer.width + 1 > atlas_width) {
+				atlas_height += shelf;
+				x = 0;
+				shelf = 0;
+			}
+			layer.x = x;
+			layer.y = atlas_height;
+			x += layer.width + 1;
+			shelf = MAX(shelf, layer.height + 1);
+		}
+		atlas_height += shelf;
+	}
+
+	ERR_FAIL_COND(atlas_width > VG_SDF_MAX_ATLAS_SIZE || atlas_height > VG_SDF_MAX_ATLAS_SIZE);
+
+	PoolVector<uint8_t> pixels;
+	ERR_FAIL_COND(pixels.resize(atlas_width * atlas_height * 3) != OK);
+	{
+		PoolVector<uint8_t>::Write w = pixels.write();
+		// the space between layers reads as far outside.
+		memset(&w[0], 0, atlas_width * atlas_height * 3);
+
+		const int threads = thread_count > 0 ? thread_count : OS::get_singleton()->get_processor_count();
+		if (threads > 1 && generation_pool_threads != threads) {
+			if (generation_pool_threads > 0) {
+				generation_pool.finish();
+			}
+			generation_pool.init(threads);
+			generation_pool_threads = threads;
+		}
+
+		SDFGenerator generator(layers, distance_range, &w[0], atlas_width);
+		generator.run(threads > 1 ? &generation_pool : nullptr);
+	}
+
+	Ref<Image> image;
+	image.instance();
+	image->create(atlas_width, atlas_height, false, Image::FORMAT_RGB8, pixels);
+
+	p_state.texture.instance();
+	p_state.texture->create_from_image(image, ImageTexture::FLAG_FILTER);
+
+	for (int i = 0; i < layers.size(); i++) {
+		const SDFLayer &layer = layers[i];
+		VGSDFState::Layer l;
+		l.rect = layer.rect;
+		l.uv = Rect2(
+				layer.x / float(atlas_width), layer.y / float(atlas_height),
+				layer.width / float(atlas_width), layer.height / float(atlas_height));
+		l.color = layer.color;
+		p_state.layers.push_back(l);
+	}
+
+	last_texture_bytes = atlas_width * atlas_height * 3;
+	last_generation_usec = OS::get_singleton()->get_ticks_usec() - t0;
+}
+
+void VGSDFRenderer::_bind_methods() {
+	ClassDB::bind_method(D_METHOD("set_resolution", "resolution"), &VGSDFRenderer::set_resolution);
+	ClassDB::bind_method(D_METHOD("get_resolution"), &VGSDFRenderer::get_resolution);
+
+	ClassDB::bind_method(D_METHOD("set_distance_range", "range"), &VGSDFRenderer::set_distance_range);
+	ClassDB::bind_method(D_METHOD("get_distance_range"), &VGSDFRenderer::get_distance_range);
+
+	ClassDB::bind_method(D_METHOD("set_thread_count", "thread_count"), &VGSDFRenderer::set_thread_count);
+	ClassDB::bind_method(D_METHOD("get_thread_count"), &VGSDFRenderer::get_thread_count);
+
+	ClassDB::bind_method(D_METHOD("get_last_generation_usec"), &VGSDFRenderer::get_last_generation_usec);
+	ClassDB::bind_method(D_METHOD("get_last_texture_size_kb"), &VGSDFRenderer::get_last_texture_size_kb);
+
+	ADD_PROPERTY(PropertyInfo(Variant::REAL, "resolution", PROPERTY_HINT_RANGE, "0.01,64,0.01"), "set_resolution", "get_resolution");
+	ADD_PROPERTY(PropertyInfo(Variant::REAL, "distance_range", PROPERTY_HINT_RANGE, "1,32,0.5"), "set_distance_range", "get_distance_range");
+	ADD_PROPERTY(PropertyInfo(Variant::INT, "thread_count", PROPERTY_HINT_RANGE, "0,64,1"), "set_thread_count", "get_thread_count");
+}
+
+Rect2 VGSDFRenderer::render_mesh(Ref<ArrayMesh> &p_mesh, Ref<Material> &r_material, Ref<Texture> &r_texture, VGPath *p_path, bool p_hq, bool p_spatial) {
+	VGSDFState &state = p_path->get_sdf_state();
+	tove::GraphicsRef graphics = p_path->get_subtree_graphics();
+
+	// transforms only move the quads, so this only changes with the shapes.
+	const uint64_t key = get_content_key(graphics);
+	if (key != state.content_key) {
+		generate(state, graphics);
+		state.content_key = key;
+	}
+
+	clear_mesh(p_mesh);
+	r_material = material;
+	r_texture = state.texture;
+
+	const int n = state.layers.size();
+	if (n == 0) {
+		return tove_bounds_to_rect2(p_path->get_tove_path()->getBounds());
+	}
+
+	PoolVector3Array vertices;
+	PoolColorArray colors;
+	PoolVector2Array uvs;
+	PoolIntArray indices;
+
+	ERR_FAIL_COND_V(vertices.resize(n * 4) != OK, Rect2());
+	ERR_FAIL_COND_V(colors.resize(n * 4) != OK, Rect2());
+	ERR_FAIL_COND_V(uvs.resize(n * 4) != OK, Rect2());
+	ERR_FAIL_COND_V(indices.resize(n * 6) != OK, Rect2());
+
+	{
+		PoolVector3Array::Write wv = vertices.write();
+		PoolColorArray::Write wc = colors.write();
+		PoolVector2Array::Write wu = uvs.write();
+		PoolIntArray::Write wi = indices.write();
+
+		static const int quad_indices[6] = {
+			0, 1, 2,
+			0, 2, 3
+		};
+
+		// in path order, so that later fills and strokes draw on top.
+		for (int i = 0; i < n; i++) {
+			const VGSDFState::Layer &layer = state.layers[i];
+			const Vector2 p0 = layer.rect.position;
+			const Vector2 p1 = layer.rect.position + layer.rect.size;
+			const Vector2 u0 = layer.uv.position;
+			const Vector2 u1 = layer.uv.position + layer.uv.size;
+
+			wv[i * 4 + 0] = Vector3(p0.x, p0.y, 0);
+			wv[i * 4 + 1] = Vector3(p0.x, p1.y, 0);
+			wv[i * 4 + 2] = Vector3(p1.x, p1.y, 0);
+			wv[i * 4 + 3] = Vector3(p1.x, p0.y, 0);
+
+			wu[i * 4 + 0] = Vector2(u0.x, u0.y);
+			wu[i * 4 + 1] = Vector2(u0.x, u1.y);
+			wu[i * 4 + 2] = Vector2(u1.x, u1.y);
+			wu[i * 4 + 3] = Vector2(u1.x, u0.y);
+
+			for (int j = 0; j < 4; j++) {
+				wc[i * 4 + j] = layer.color;
+			}
+			for (int j = 0; j < 6; j++) {
+				wi[i * 6 + j] = i * 4 + quad_indices[j];
+			}
+		}
+	}
+
+	Array arr;
+	ERR_FAIL_COND_V(arr.resize(Mesh::ARRAY_MAX), Rect2());
+	arr[VS::ARRAY_VERTEX] = vertices;
+	arr[VS::ARRAY_COLOR] = colors;
+	arr[VS::ARRAY_TEX_UV] = uvs;
+	arr[VS::ARRAY_INDEX] = indices;
+
+	p_mesh->add_surface_from_arrays(Mesh::PRIMITIVE_TRIANGLES, arr);
+
+	return tove_bounds_to_rect2(p_path->get_tove_path()->getBounds());
+}
+
+Ref<ImageTexture> VGSDFRenderer::render_texture(VGPath *p_path, bool p_hq) {
+	// generated along with the quads in render_mesh.
+	return p_path->get_sdf_state().texture;
+}
+
+Ref<Material> VGSDFRenderer::get_canvas_material(VGPath *p_path) {
+	return material;
+}
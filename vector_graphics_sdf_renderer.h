@@ -0,0 +1,88 @@
+/*************************************************************************/
+/*  vg_sdf_renderer.h                                                    */
+/*************************************************************************/
+
+#ifndef VG_SDF_RENDERER_H
+#define VG_SDF_RENDERER_H
+
+#include "vector_graphics_renderer.h"
+#include "utils.h"
+#include "core/os/thread_work_pool.h"
+
+// what VGSDFRenderer keeps on a path: one atlas with a distance field per
+// fill and per stroke, and where each of them goes.
+struct VGSDFState {
+	struct Layer {
+		Rect2 rect;
+		Rect2 uv;
+		Color color;
+	};
+
+	uint64_t content_key;
+	Vector<Layer> layers;
+	Ref<ImageTexture> texture;
+
+	void reset();
+
+	VGSDFState();
+};
+
+// draws paths from multi-channel signed distance fields, which stay sharp
+// when zoomed in, so that scale changes never regenerate anything. every
+// fill and every stroke gets a layer of its own, drawn in its average
+// paint color; gradients lose their color ramp. strokes always look like
+// round joins and caps.
+class VGSDFRenderer : public VGRenderer {
+	GDCLASS(VGSDFRenderer, VGRenderer);
+
+	// texels per unit of the path's coordinate system.
+	float resolution;
+	// distances up to this many texels are stored, farther ones are clamped.
+	float distance_range;
+	// 0 picks one thread per core.
+	int thread_count;
+	// the threads generating in bands, started on first use and kept until
+	// the thread count changes.
+	ThreadWorkPool generation_pool;
+	int generation_pool_threads;
+
+	Ref<ShaderMaterial> material;
+
+	uint64_t last_generation_usec;
+	uint64_t last_texture_bytes;
+
+	uint64_t get_content_key(const tove::GraphicsRef &p_graphics) const;
+	void generate(VGSDFState &p_state, const tove::GraphicsRef &p_graphics);
+	void update_material();
+
+protected:
+	static void _bind_methods();
+
+public:
+	VGSDFRenderer();
+	~VGSDFRenderer();
+
+	float get_resolution() const;
+	void set_resolution(float p_resolution);
+
+	float get_distance_range() const;
+	void set_distance_range(float p_distance_range);
+
+	int get_thread_count() const;
+	void set_thread_count(int p_thread_count);
+
+	// cost of the last distance field, to compare with rasterizing or tesselating.
+	int get_last_generation_usec() const { return last_generation_usec; }
+	int get_last_texture_size_kb() const { return last_texture_bytes / 1024; }
+
+	virtual Rect2 render_mesh(Ref<ArrayMesh> &p_mesh, Ref<Material> &r_material, Ref<Texture> &r_texture, VGPath *p_path, bool p_hq, bool p_spatial);
+	virtual Ref<ImageTexture> render_texture(VGPath *p_path, bool p_hq);
+	virtual Ref<Material> get_canvas_material(VGPath *p_path);
+
+	virtual bool is_dirty_on_transform_change() const { return false; }
+};
+
+Ref<Shader> get_sdf_shader();
+void free_sdf_shader();
+
+#endif // VG_SDF_RENDERER_H
@@ -4,42 +4,376 @@
 
 #include "vector_graphics_texture_renderer.h"
 #include "vector_graphics_path.h"
+#include "core/hashfuncs.h"
+#include "core/object.h"
+#include "core/os/os.h"
 
-static Ref<Image> tove_graphics_rasterize(
+// below this many rows, waking up worker threads costs more than it saves.
+#define VG_BANDED_RASTER_MIN_ROWS 128
+// never split into bands thinner than this, each band pays for walking the
+// edges above it.
+#define VG_BANDED_RASTER_MIN_BAND 16
+// blue noise tile of the final tier. tove only ships a precomputed 32x32
+// table, see nsvg::getBlueNoise().
+#define VG_SPRITE_BLUE_NOISE_SIZE 32
+
+// clang-format off
+static const char *sprite_mask_shader_code = R"GLSL(
+shader_type canvas_item;
+
+void fragment()
+{
+	// the mask holds alpha only, the color comes from the vertices.
+	COLOR = vec4(COLOR.rgb, COLOR.a * texture(TEXTURE, UV).r);
+}
+)GLSL";
+
+static const char *sprite_premultiplied_mask_shader_code = R"GLSL(
+shader_type canvas_item;
+render_mode blend_premul_alpha;
+
+void fragment()
+{
+	// as above, premultiplied like the other sprites.
+	float a = COLOR.a * texture(TEXTURE, UV).r;
+	COLOR = vec4(COLOR.rgb * a, a);
+}
+)GLSL";
+// clang-format on
+
+static Ref<Shader> sprite_mask_shaders[2];
+static Ref<CanvasItemMaterial> sprite_premultiplied_material;
+
+Ref<Shader> get_sprite_mask_shader(bool p_premultiplied) {
+	Ref<Shader> &shader = sprite_mask_shaders[p_premultiplied ? 1 : 0];
+	if (shader.is_null()) {
+		shader.instance();
+		shader->set_code(p_premultiplied ? sprite_premultiplied_mask_shader_code : sprite_mask_shader_code);
+	}
+	return shader;
+}
+
+Ref<CanvasItemMaterial> get_sprite_premultiplied_material() {
+	if (sprite_premultiplied_material.is_null()) {
+		sprite_premultiplied_material.instance();
+		sprite_premultiplied_material->set_blend_mode(CanvasItemMaterial::BLEND_MODE_PREMULT_ALPHA);
+	}
+	return sprite_premultiplied_material;
+}
+
+void free_sprite_materials() {
+	sprite_mask_shaders[0].unref();
+	sprite_mask_shaders[1].unref();
+	sprite_premultiplied_material.unref();
+}
+
+class BandedRasterizer {
+	tove::NSVGrasterJob *job;
+	const ToveRasterizeSettings *settings;
+	int height;
+	int band_height;
+	bool defringe;
+
+	void _rasterize_band(uint32_t p_index, void *p_userdata) {
+		const int y0 = p_index * band_height;
+		tove::nsvg::rasterizeBand(job, y0, MIN(y0 + band_height, height), settings);
+	}
+
+	void _defringe_band(uint32_t p_index, void *p_userdata) {
+		const int y0 = p_index * band_height;
+		tove::nsvg::defringeBand(job, y0, MIN(y0 + band_height, height));
+	}
+
+public:
+	BandedRasterizer(tove::NSVGrasterJob *p_job, const ToveRasterizeSettings *p_settings, int p_height, int p_flags) :
+			job(p_job),
+			settings(p_settings),
+			height(p_height),
+			band_height(p_height),
+			defringe(!(p_flags & (tove::NSVG_RASTER_PREMULTIPLIED | tove::NSVG_RASTER_ALPHA))) {
+	}
+
+	void run(ThreadWorkPool *p_pool, int p_thread_count) {
+		// a few bands per thread, so that threads that got cheap bands can pick up more.
+		band_height = MAX(VG_BANDED_RASTER_MIN_BAND, (height + p_thread_count * 4 - 1) / (p_thread_count * 4));
+		const int n = (height + band_height - 1) / band_height;
+
+		p_pool->do_work(n, this, &BandedRasterizer::_rasterize_band, nullptr);
+		if (defringe) {
+			// defringing reads the rows of neighbouring bands, so it has to wait for all of them.
+			p_pool->do_work(n, this, &BandedRasterizer::_defringe_band, nullptr);
+		}
+	}
+};
+
+static void tove_graphics_rasterize_into(
 	const tove::GraphicsRef &p_tove_graphics,
+	uint8_t *p_pixels,
 	int p_width, int p_height,
 	float p_tx, float p_ty,
 	float p_scale,
-	bool p_hq) {
+	VGSpriteRenderer::QualityTier p_quality_tier,
+	ToveRasterizeEngine p_engine,
+	ThreadWorkPool *p_pool,
+	int p_thread_count,
+	int p_flags) {
 
-	ERR_FAIL_COND_V(p_width <= 0, Ref<Image>());
-	ERR_FAIL_COND_V(p_height <= 0, Ref<Image>());
+	const ToveRasterizeSettings *defaultSettings = tove::nsvg::getDefaultRasterizeSettings();
+	if (!defaultSettings) {
+		return;
+	}
+
+	ToveRasterizeSettings settings = *defaultSettings;
+	settings.engine = p_engine;
+	// tolerances are in pixels. the subsample counts divide 255.
+	switch (p_quality_tier) {
+		case VGSpriteRenderer::QUALITY_TIER_PREVIEW: {
+			settings.subsamples = 3;
+			settings.tessTolerance = 0.5f;
+			settings.distTolerance = 0.05f;
+		} break;
+		case VGSpriteRenderer::QUALITY_TIER_NORMAL: {
+		} break;
+		case VGSpriteRenderer::QUALITY_TIER_FINAL: {
+			settings.subsamples = 15;
+			settings.tessTolerance = 0.1f;
+			settings.distTolerance = 0.005f;
+			// ordered, unlike diffusion, still lets gradients go in bands.
+			const float *noise = tove::nsvg::getBlueNoise(VG_SPRITE_BLUE_NOISE_SIZE);
+			if (noise) {
+				settings.quality.dither = ToveDither{ TOVE_DITHER_ORDERED, noise,
+					VG_SPRITE_BLUE_NOISE_SIZE, VG_SPRITE_BLUE_NOISE_SIZE, 1.0f };
+			}
+		} break;
+	}
 
 	const int w = p_width;
 	const int h = p_height;
+	const int stride = (p_flags & tove::NSVG_RASTER_ALPHA) ? w : w * 4;
 
-	PoolVector<uint8_t> dst_image;
-	ERR_FAIL_COND_V(dst_image.resize(w * h * 4) != OK, Ref<Image>());
+	tove::NSVGrasterJob *job = nullptr;
+	if (p_pool) {
+		job = tove::nsvg::beginRasterize(p_tove_graphics->getImage(),
+			p_tx, p_ty, p_scale, p_pixels, w, h, stride, &settings, p_flags);
+	}
 
-	const ToveRasterizeSettings *defaultSettings = tove::nsvg::getDefaultRasterizeSettings();
-	if (defaultSettings) {
-		ToveRasterizeSettings settings = *defaultSettings;
-		if (p_hq) {
-			// TODO: settings.quality
+	if (job) {
+		// same pixels as the single threaded path below.
+		BandedRasterizer rasterizer(job, &settings, h, p_flags);
+		rasterizer.run(p_pool, p_thread_count);
+		tove::nsvg::endRasterize(job);
+	} else {
+		tove::nsvg::rasterize(p_tove_graphics->getImage(),
+			p_tx, p_ty, p_scale, p_pixels, w, h, stride, &settings, p_flags);
+	}
+}
+
+// beyond this many paths, clearing one rect around all of them is cheaper.
+#define VG_SPRITE_MAX_USED_RECTS 32
+
+// beyond this share of the sprite's pixels, redrawing only the rect around
+// changed paths saves too little to be worth the extra copies.
+#define VG_SPRITE_MAX_DIRTY_AREA 0.5
+
+// pixels rasterized around each tile, so that filtering at seams matches.
+#define VG_SPRITE_TILE_GUTTER 1
+// rows or columns of tiles rasterized ahead of the view in the pan direction.
+#define VG_SPRITE_TILE_PREFETCH 1
+// missing tiles get drawn from tiles of up to this many octaves coarser.
+#define VG_SPRITE_TILE_FALLBACK_OCTAVES 3
+
+// pixels around each atlas region that repeat its edge, so that filtering
+// sees the same as at the clamped edge of a texture of its own.
+#define VG_SPRITE_ATLAS_GUTTER 1
+
+// the pixels a path can touch, with room for anti-aliasing and defringing.
+static Rect2i get_path_rect(const Rect2 &p_bounds, float p_resolution, float p_tx, float p_ty) {
+	const int x0 = Math::floor(p_bounds.position.x * p_resolution + p_tx) - 2;
+	const int y0 = Math::floor(p_bounds.position.y * p_resolution + p_ty) - 2;
+	const int x1 = Math::ceil((p_bounds.position.x + p_bounds.size.x) * p_resolution + p_tx) + 2;
+	const int y1 = Math::ceil((p_bounds.position.y + p_bounds.size.y) * p_resolution + p_ty) + 2;
+	return Rect2i(x0, y0, x1 - x0, y1 - y0);
+}
+
+static void get_used_rects(const tove::GraphicsRef &p_graphics, float p_resolution, float p_tx, float p_ty, int p_width, int p_height, Vector<Rect2i> &r_rects) {
+	r_rects.clear();
+
+	const int n = p_graphics->getNumPaths();
+	const Rect2i image = Rect2i(0, 0, p_width, p_height);
+	Rect2i all;
+
+	for (int i = 0; i < n; i++) {
+		const Rect2 bounds = tove_bounds_to_rect2(p_graphics->getPath(i)->getExactBounds());
+		const Rect2i rect = get_path_rect(bounds, p_resolution, p_tx, p_ty).clip(image);
+		if (rect.has_no_area()) {
+			continue;
 		}
-		PoolVector<uint8_t>::Write dw = dst_image.write();
-		p_tove_graphics->rasterize(&dw[0], p_width, p_height, w * 4, p_tx, p_ty, p_scale, &settings);
+		all = r_rects.empty() ? rect : all.merge(rect);
+		r_rects.push_back(rect);
+	}
+
+	if (r_rects.size() > VG_SPRITE_MAX_USED_RECTS) {
+		r_rects.clear();
+		r_rects.push_back(all);
+	}
+}
+
+// alpha masks have one byte per pixel, everything else RGBA.
+static int get_pixel_size(bool p_mask) {
+	return p_mask ? 1 : 4;
+}
+
+static void clear_rects(uint8_t *p_pixels, int p_width, int p_pixel_size, const Vector<Rect2i> &p_rects) {
+	for (int i = 0; i < p_rects.size(); i++) {
+		const Rect2i &rect = p_rects[i];
+		for (int y = rect.position.y; y < rect.position.y + rect.size.y; y++) {
+			memset(&p_pixels[(y * p_width + rect.position.x) * p_pixel_size], 0, rect.size.x * p_pixel_size);
+		}
+	}
+}
+
+// fingerprint and exact bounds of every path. clip paths are not part of
+// the fingerprints, so clipped graphics get no keys at all. masks do not
+// depend on the color.
+static bool get_path_keys(const tove::GraphicsRef &p_graphics, bool p_mask, Vector<uint64_t> &r_keys, Vector<Rect2> &r_bounds) {
+	const int n = p_graphics->getNumPaths();
+	r_keys.resize(n);
+	r_bounds.resize(n);
+
+	for (int i = 0; i < n; i++) {
+		const tove::PathRef &path = p_graphics->getPath(i);
+		if (!path->getClipIndices().empty()) {
+			r_keys.clear();
+			r_bounds.clear();
+			return false;
+		}
+		const uint64_t key = tove_path_fingerprint(path);
+		r_keys.write[i] = p_mask ? tove_paint_alpha_fingerprint(path, key) : tove_paint_fingerprint(path, key);
+		r_bounds.write[i] = tove_bounds_to_rect2(path->getExactBounds());
+	}
+	return true;
+}
+
+// a private copy for the worker, which never sees the paths of the scene.
+static tove::GraphicsRef copy_graphics(const tove::GraphicsRef &p_graphics) {
+	tove::GraphicsRef graphics = tove::tove_make_shared<tove::Graphics>();
+	for (int i = 0; i < p_graphics->getNumPaths(); i++) {
+		graphics->addPath(p_graphics->getPath(i)->clone());
 	}
+	return graphics;
+}
 
+// paths draw regions of atlas pages that can change under them.
+static void update_path(ObjectID p_path) {
+	VGPath *path = Object::cast_to<VGPath>(ObjectDB::get_instance(p_path));
+	if (path) {
+		path->update();
+	}
+}
 
+// the image shares the pixel buffer. it is dropped right after the
+// upload, so that the next write() does not need to copy.
+static void upload_pixels(const PoolVector<uint8_t> &p_pixels, int p_width, int p_height, bool p_mask, Ref<ImageTexture> &r_texture) {
+	const Image::Format format = p_mask ? Image::FORMAT_L8 : Image::FORMAT_RGBA8;
 	Ref<Image> image;
 	image.instance();
-	image->create(w, h, false, Image::FORMAT_RGBA8, dst_image);
+	image->create(p_width, p_height, false, format, p_pixels);
+
+	if (r_texture.is_valid() && r_texture->get_width() == p_width && r_texture->get_height() == p_height && r_texture->get_format() == format) {
+		r_texture->set_data(image);
+	} else {
+		r_texture.instance();
+		r_texture->create_from_image(image, ImageTexture::FLAG_FILTER);
+	}
+}
+
+void VGSpriteState::reset() {
+	pixels = PoolVector<uint8_t>();
+	width = 0;
+	height = 0;
+	used.clear();
+	texture = Ref<ImageTexture>();
+	texture_key = 0;
+	mask = false;
+	has_scale_bucket = false;
+	// jobs still running for the old renderer are dropped.
+	job_serial++;
+	job_key = 0;
+	job_pending = false;
+	frame_key = 0;
+	path_keys.clear();
+	path_bounds.clear();
+	uploaded = 0;
+	tiled = false;
+	tile_bounds = Rect2();
+	tile_content_key = 0;
+	tile_graphics = tove::GraphicsRef();
+	visible_tiles = Rect2i();
+	view_center = Point2();
+}
 
-	return image;
+VGSpriteState::VGSpriteState() :
+		width(0),
+		height(0),
+		texture_key(0),
+		mask(false),
+		scale_bucket(0),
+		has_scale_bucket(false),
+		job_serial(0),
+		job_key(0),
+		job_pending(false),
+		frame_key(0),
+		uploaded(0),
+		tiled(false),
+		tile_content_key(0) {
 }
 
-VGSpriteRenderer::VGSpriteRenderer() : quality(1) {
+VGSpriteRenderer::VGSpriteRenderer() :
+		quality(1),
+		quality_tier(QUALITY_TIER_NORMAL),
+		thread_count(0),
+		raster_pool_threads(0),
+		premultiplied_alpha(false),
+		analytic_coverage(false),
+		alpha_masks(false),
+		scale_steps(2),
+		scale_hysteresis(0.25),
+		cache_budget_kb(16384),
+		cache_bytes(0),
+		cache_hits(0),
+		cache_misses(0),
+		tile_size(0),
+		tile_budget_kb(65536),
+		tile_bytes(0),
+		atlas_size(0),
+		atlas_budget_kb(16384),
+		asynchronous(false),
+		running_tile(0),
+		worker_exit(false),
+		jobs_queued(0),
+		jobs_completed(0),
+		jobs_dropped(0),
+		full_updates(0),
+		partial_updates(0) {
+
+	for (int i = 0; i < 2; i++) {
+		mask_materials[i].instance();
+		mask_materials[i]->set_shader(get_sprite_mask_shader(i == 1));
+	}
+}
+
+VGSpriteRenderer::~VGSpriteRenderer() {
+	if (worker.is_started()) {
+		{
+			MutexLock lock(job_mutex);
+			worker_exit = true;
+		}
+		job_semaphore.post();
+		worker.wait_to_finish();
+	}
+	if (raster_pool_threads > 0) {
+		raster_pool.finish();
+	}
 }
 
 float VGSpriteRenderer::get_quality() {
@@ -51,11 +385,905 @@ void VGSpriteRenderer::set_quality(float p_quality) {
 	emit_changed();
 }
 
+VGSpriteRenderer::QualityTier VGSpriteRenderer::get_quality_tier() const {
+	return quality_tier;
+}
+
+void VGSpriteRenderer::set_quality_tier(QualityTier p_quality_tier) {
+	quality_tier = p_quality_tier;
+	emit_changed();
+}
+
+int VGSpriteRenderer::get_thread_count() const {
+	return thread_count;
+}
+
+void VGSpriteRenderer::set_thread_count(int p_thread_count) {
+	thread_count = MAX(p_thread_count, 0);
+	emit_changed();
+}
+
+bool VGSpriteRenderer::get_premultiplied_alpha() const {
+	return premultiplied_alpha;
+}
+
+void VGSpriteRenderer::set_premultiplied_alpha(bool p_premultiplied_alpha) {
+	premultiplied_alpha = p_premultiplied_alpha;
+	emit_changed();
+}
+
+bool VGSpriteRenderer::get_analytic_coverage() const {
+	return analytic_coverage;
+}
+
+void VGSpriteRenderer::set_analytic_coverage(bool p_analytic_coverage) {
+	analytic_coverage = p_analytic_coverage;
+	// cached textures have the other engine's edges.
+	clear_cache();
+	clear_tiles();
+	clear_atlas();
+	emit_changed();
+}
+
+bool VGSpriteRenderer::get_alpha_masks() const {
+	return alpha_masks;
+}
+
+void VGSpriteRenderer::set_alpha_masks(bool p_alpha_masks) {
+	alpha_masks = p_alpha_masks;
+	emit_changed();
+}
+
+bool VGSpriteRenderer::get_mask_tint(VGPath *p_path, const tove::GraphicsRef &p_graphics, Color &r_tint) const {
+	if (!alpha_masks || p_path->get_material().is_valid()) {
+		return false;
+	}
+	if (!p_graphics->areColorsSolid()) {
+		return false;
+	}
+
+	// the alpha of each paint ends up in the mask, only rgb has to match.
+	uint32_t rgb = 0;
+	bool found = false;
+	const int n = p_graphics->getNumPaths();
+	for (int i = 0; i < n; i++) {
+		const tove::NSVGshape *shape = p_graphics->getPath(i)->getNSVG();
+		const tove::NSVGpaint *paints[2] = { &shape->fill, &shape->stroke };
+		for (int j = 0; j < 2; j++) {
+			if (paints[j]->type != tove::NSVG_PAINT_COLOR) {
+				continue;
+			}
+			const uint32_t color = paints[j]->color & 0xffffff;
+			if (found && color != rgb) {
+				return false;
+			}
+			rgb = color;
+			found = true;
+		}
+	}
+
+	if (!found) {
+		return false;
+	}
+
+	r_tint = Color((rgb & 0xff) / 255.0f, ((rgb >> 8) & 0xff) / 255.0f, ((rgb >> 16) & 0xff) / 255.0f);
+	return true;
+}
+
+int VGSpriteRenderer::get_raster_flags(bool p_mask) const {
+	if (p_mask) {
+		return tove::NSVG_RASTER_ALPHA;
+	}
+	return premultiplied_alpha ? tove::NSVG_RASTER_PREMULTIPLIED : 0;
+}
+
+ToveRasterizeEngine VGSpriteRenderer::get_raster_engine() const {
+	return analytic_coverage ? TOVE_RASTERIZE_ANALYTIC : TOVE_RASTERIZE_SUBSAMPLED;
+}
+
+int VGSpriteRenderer::get_scale_steps() const {
+	return scale_steps;
+}
+
+void VGSpriteRenderer::set_scale_steps(int p_scale_steps) {
+	scale_steps = CLAMP(p_scale_steps, 1, 16);
+	// bucket numbers mean other scales now.
+	clear_cache();
+	clear_tiles();
+	clear_atlas();
+	emit_changed();
+}
+
+float VGSpriteRenderer::get_scale_hysteresis() const {
+	return scale_hysteresis;
+}
+
+void VGSpriteRenderer::set_scale_hysteresis(float p_scale_hysteresis) {
+	scale_hysteresis = CLAMP(p_scale_hysteresis, 0.0f, 1.0f);
+}
+
+int VGSpriteRenderer::get_cache_budget_kb() const {
+	return cache_budget_kb;
+}
+
+void VGSpriteRenderer::set_cache_budget_kb(int p_cache_budget_kb) {
+	cache_budget_kb = MAX(p_cache_budget_kb, 0);
+	trim_cache();
+}
+
+void VGSpriteRenderer::reset_cache_counters() {
+	cache_hits = 0;
+	cache_misses = 0;
+}
+
+void VGSpriteRenderer::clear_cache() {
+	cache.clear();
+	cache_index.clear();
+	cache_bytes = 0;
+}
+
+bool VGSpriteRenderer::get_asynchronous() const {
+	return asynchronous;
+}
+
+void VGSpriteRenderer::set_asynchronous(bool p_asynchronous) {
+	asynchronous = p_asynchronous;
+}
+
+void VGSpriteRenderer::reset_job_counters() {
+	jobs_queued = 0;
+	jobs_completed = 0;
+	jobs_dropped = 0;
+}
+
+void VGSpriteRenderer::reset_update_counters() {
+	full_updates = 0;
+	partial_updates = 0;
+}
+
+int VGSpriteRenderer::get_tile_size() const {
+	return tile_size;
+}
+
+void VGSpriteRenderer::set_tile_size(int p_tile_size) {
+	tile_size = p_tile_size > 0 ? CLAMP(p_tile_size, 16, 4096) : 0;
+	// the tile grid is another one now.
+	clear_tiles();
+	emit_changed();
+}
+
+int VGSpriteRenderer::get_tile_budget_kb() const {
+	return tile_budget_kb;
+}
+
+void VGSpriteRenderer::set_tile_budget_kb(int p_tile_budget_kb) {
+	tile_budget_kb = MAX(p_tile_budget_kb, 0);
+	trim_tiles();
+}
+
+void VGSpriteRenderer::clear_tiles() {
+	tiles.clear();
+	tile_index.clear();
+	tile_bytes = 0;
+}
+
+uint64_t VGSpriteRenderer::get_tile_key(ObjectID p_path, int p_bucket, const Point2i &p_tile, uint64_t p_content_key) {
+	uint64_t key = hash_djb2_one_64(uint64_t(p_path));
+	key = hash_djb2_one_64(uint64_t(uint32_t(p_bucket)), key);
+	key = hash_djb2_one_64(uint64_t(uint32_t(p_tile.x)), key);
+	key = hash_djb2_one_64(uint64_t(uint32_t(p_tile.y)), key);
+	return hash_djb2_one_64(p_content_key, key);
+}
+
+Rect2i VGSpriteRenderer::get_tile_rect(const VGSpriteState &p_state, int p_bucket, const Point2i &p_tile) const {
+	const float resolution = get_scale_bucket_resolution(p_bucket);
+	const int w = Math::ceil(p_state.tile_bounds.size.x * resolution);
+	const int h = Math::ceil(p_state.tile_bounds.size.y * resolution);
+	return Rect2i(p_tile.x * tile_size, p_tile.y * tile_size, tile_size, tile_size).clip(Rect2i(0, 0, w, h));
+}
+
+Rect2 VGSpriteRenderer::get_tile_local_rect(const VGSpriteState &p_state, int p_bucket, const Rect2 &p_rect) const {
+	const float resolution = get_scale_bucket_resolution(p_bucket);
+	return Rect2(p_state.tile_bounds.position + p_rect.position / resolution, p_rect.size / resolution);
+}
+
+VGSpriteRenderer::TileEntry *VGSpriteRenderer::find_tile(ObjectID p_path, int p_bucket, const Point2i &p_tile, uint64_t p_content_key) {
+	List<TileEntry>::Element **E = tile_index.getptr(get_tile_key(p_path, p_bucket, p_tile, p_content_key));
+	if (!E) {
+		return nullptr;
+	}
+	const TileEntry &e = (*E)->get();
+	if (e.path != p_path || e.scale_bucket != p_bucket || e.tile != p_tile || e.content_key != p_content_key) {
+		return nullptr;
+	}
+	tiles.move_to_front(*E);
+	return &(*E)->get();
+}
+
+void VGSpriteRenderer::add_tile(const RasterJob &p_job) {
+	const uint64_t key = get_tile_key(p_job.path, p_job.scale_bucket, p_job.tile, p_job.content_key);
+	List<TileEntry>::Element **E = tile_index.getptr(key);
+	if (E) {
+		tile_bytes -= (*E)->get().bytes;
+		tiles.erase(*E);
+	}
+
+	TileEntry entry;
+	entry.path = p_job.path;
+	entry.scale_bucket = p_job.scale_bucket;
+	entry.tile = p_job.tile;
+	entry.content_key = p_job.content_key;
+	upload_pixels(p_job.pixels, p_job.width, p_job.height, false, entry.texture);
+	entry.bytes = p_job.width * p_job.height * 4;
+
+	tile_index.set(key, tiles.push_front(entry));
+	tile_bytes += entry.bytes;
+	trim_tiles();
+}
+
+void VGSpriteRenderer::trim_tiles() {
+	const uint64_t budget = uint64_t(tile_budget_kb) * 1024;
+	while (tiles.size() > 1 && tile_bytes > budget) {
+		const TileEntry &e = tiles.back()->get();
+		tile_index.erase(get_tile_key(e.path, e.scale_bucket, e.tile, e.content_key));
+		tile_bytes -= e.bytes;
+		tiles.pop_back();
+	}
+}
+
+bool VGSpriteRenderer::queue_tiles(VGPath *p_path, VGSpriteState &p_state, bool p_force) {
+	// the canvas transform carries viewport and camera zoom.
+	const Transform2D xform = p_path->get_global_transform_with_canvas();
+	const Size2 s = xform.get_scale();
+	const int bucket = select_scale_bucket(p_state, MAX(ABS(s.width), ABS(s.height)));
+	const float resolution = get_scale_bucket_resolution(bucket);
+	const Rect2 view = xform.affine_inverse().xform(p_path->get_viewport_rect());
+
+	const Rect2 &bounds = p_state.tile_bounds;
+	const Rect2i grid = Rect2i(0, 0,
+			(int(Math::ceil(bounds.size.x * resolution)) + tile_size - 1) / tile_size,
+			(int(Math::ceil(bounds.size.y * resolution)) + tile_size - 1) / tile_size);
+
+	Rect2i visible;
+	const Rect2 local = view.clip(bounds);
+	if (!local.has_no_area()) {
+		const float f = resolution / tile_size;
+		const int x0 = Math::floor((local.position.x - bounds.position.x) * f);
+		const int y0 = Math::floor((local.position.y - bounds.position.y) * f);
+		const int x1 = Math::ceil((local.position.x + local.size.x - bounds.position.x) * f);
+		const int y1 = Math::ceil((local.position.y + local.size.y - bounds.position.y) * f);
+		visible = Rect2i(x0, y0, x1 - x0, y1 - y0).clip(grid);
+	}
+
+	if (!p_force && bucket == p_state.scale_bucket && visible == p_state.visible_tiles) {
+		return false;
+	}
+
+	const Point2 center = view.position + view.size * 0.5;
+	const Vector2 pan = bucket == p_state.scale_bucket ? center - p_state.view_center : Vector2();
+	p_state.scale_bucket = bucket;
+	p_state.has_scale_bucket = true;
+	p_state.visible_tiles = visible;
+	p_state.view_center = center;
+
+	Vector<Point2i> missing;
+	for (int y = visible.position.y; y < visible.position.y + visible.size.y; y++) {
+		for (int x = visible.position.x; x < visible.position.x + visible.size.x; x++) {
+			if (!find_tile(p_path->get_instance_id(), bucket, Point2i(x, y), p_state.tile_content_key)) {
+				missing.push_back(Point2i(x, y));
+			}
+		}
+	}
+
+	// after the tiles in view, the ones the view is moving towards.
+	Rect2i ahead = visible;
+	if (!visible.has_no_area()) {
+		if (pan.x > 0) {
+			ahead.size.x += VG_SPRITE_TILE_PREFETCH;
+		} else if (pan.x < 0) {
+			ahead.position.x -= VG_SPRITE_TILE_PREFETCH;
+			ahead.size.x += VG_SPRITE_TILE_PREFETCH;
+		}
+		if (pan.y > 0) {
+			ahead.size.y += VG_SPRITE_TILE_PREFETCH;
+		} else if (pan.y < 0) {
+			ahead.position.y -= VG_SPRITE_TILE_PREFETCH;
+			ahead.size.y += VG_SPRITE_TILE_PREFETCH;
+		}
+		ahead = ahead.clip(grid);
+	}
+	for (int y = ahead.position.y; y < ahead.position.y + ahead.size.y; y++) {
+		for (int x = ahead.position.x; x < ahead.position.x + ahead.size.x; x++) {
+			const Point2i tile(x, y);
+			if (!visible.has_point(tile) && !find_tile(p_path->get_instance_id(), bucket, tile, p_state.tile_content_key)) {
+				missing.push_back(tile);
+			}
+		}
+	}
+
+	MutexLock lock(job_mutex);
+	if (!worker.is_started()) {
+		worker_exit = false;
+		worker.start(&VGSpriteRenderer::_worker_func, this);
+	}
+
+	// tiles that are still waiting were asked for by an older view.
+	List<RasterJob>::Element *E = pending_jobs.front();
+	while (E) {
+		List<RasterJob>::Element *next = E->next();
+		if (E->get().is_tile && E->get().path == p_path->get_instance_id()) {
+			pending_jobs.erase(E);
+			jobs_dropped++;
+		}
+		E = next;
+	}
+
+	for (int i = 0; i < missing.size(); i++) {
+		RasterJob job;
+		job.path = p_path->get_instance_id();
+		job.serial = p_state.job_serial;
+		job.graphics = p_state.tile_graphics;
+		job.scale_bucket = bucket;
+		job.resolution = resolution;
+		job.content_key = p_state.tile_content_key;
+		job.mask = false;
+		job.flags = get_raster_flags(false);
+		job.engine = get_raster_engine();
+		job.quality_tier = quality_tier;
+		job.thread_count = thread_count;
+		job.is_tile = true;
+		job.tile = missing[i];
+		job.tile_rect = get_tile_rect(p_state, bucket, missing[i]);
+		job.width = 0;
+		job.height = 0;
+
+		if (get_tile_key(job.path, bucket, job.tile, job.content_key) == running_tile) {
+			continue;
+		}
+
+		pending_jobs.push_back(job);
+		job_semaphore.post();
+		jobs_queued++;
+	}
+
+	return true;
+}
+
+bool VGSpriteRenderer::render_tiles(VGPath *p_path, const tove::GraphicsRef &p_graphics) {
+	VGSpriteState &state = p_path->get_sprite_state();
+
+	// tiles once the whole sprite would need more than one.
+	const Size2 s = p_path->get_global_transform().get_scale();
+	const float resolution = quality * MAX(ABS(s.width), ABS(s.height));
+	const float *bounds = p_graphics->getExactBounds();
+	const Rect2 rect = Rect2(bounds[0], bounds[1], bounds[2] - bounds[0], bounds[3] - bounds[1]);
+	const bool large = tile_size > 0 && p_path->is_inside_tree() &&
+			(rect.size.x * resolution > tile_size || rect.size.y * resolution > tile_size);
+
+	// clipped graphics cannot be keyed, so they never get tiles.
+	const uint64_t content_key = large ? get_content_key(p_graphics, false) : 0;
+	if (content_key == 0) {
+		if (state.tiled) {
+			// the scale bucket followed the camera.
+			state.reset();
+		}
+		return false;
+	}
+
+	if (!state.tiled) {
+		// nothing of the whole sprite is needed anymore.
+		state.reset();
+		state.tiled = true;
+	}
+
+	if (content_key != state.tile_content_key) {
+		state.tile_content_key = content_key;
+		state.tile_bounds = rect;
+		state.tile_graphics = copy_graphics(p_graphics);
+	}
+
+	queue_tiles(p_path, state, true);
+	return true;
+}
+
+int VGSpriteRenderer::get_atlas_size() const {
+	return atlas_size;
+}
+
+void VGSpriteRenderer::set_atlas_size(int p_atlas_size) {
+	atlas_size = p_atlas_size > 0 ? CLAMP(p_atlas_size, 64, 8192) : 0;
+	// regions of the old pages do not fit the new ones.
+	clear_atlas();
+	emit_changed();
+}
+
+int VGSpriteRenderer::get_atlas_budget_kb() const {
+	return atlas_budget_kb;
+}
+
+void VGSpriteRenderer::set_atlas_budget_kb(int p_atlas_budget_kb) {
+	atlas_budget_kb = MAX(p_atlas_budget_kb, 0);
+	// pages are never given back one by one.
+	if (get_atlas_bytes() > uint64_t(atlas_budget_kb) * 1024) {
+		clear_atlas();
+	}
+}
+
+void VGSpriteRenderer::clear_atlas() {
+	for (List<AtlasEntry>::Element *E = atlas_entries.front(); E; E = E->next()) {
+		update_path(E->get().path);
+	}
+	atlas_entries.clear();
+	atlas_index.clear();
+	atlas_pages.clear();
+}
+
+uint64_t VGSpriteRenderer::get_atlas_key(ObjectID p_path, int p_bucket) {
+	const uint64_t key = hash_djb2_one_64(uint64_t(p_path));
+	return hash_djb2_one_64(uint64_t(uint32_t(p_bucket)), key);
+}
+
+uint64_t VGSpriteRenderer::get_atlas_bytes() const {
+	uint64_t bytes = 0;
+	for (int i = 0; i < atlas_pages.size(); i++) {
+		bytes += uint64_t(atlas_size) * atlas_size * get_pixel_size(atlas_pages[i].mask);
+	}
+	return bytes;
+}
+
+// the lowest position the rect fits at, the leftmost of these.
+bool VGSpriteRenderer::pack_atlas_rect(AtlasPage &p_page, int p_size, const Size2i &p_rect_size, Point2i &r_position) {
+	const Vector<Point2i> &skyline = p_page.skyline;
+	const int n = skyline.size();
+
+	int best = -1;
+	int best_y = p_size;
+	for (int i = 0; i < n && skyline[i].x + p_rect_size.x <= p_size; i++) {
+		int y = 0;
+		for (int j = i; j < n && skyline[j].x < skyline[i].x + p_rect_size.x; j++) {
+			y = MAX(y, skyline[j].y);
+		}
+		if (y + p_rect_size.y <= p_size && y < best_y) {
+			best = i;
+			best_y = y;
+		}
+	}
+	if (best < 0) {
+		return false;
+	}
+
+	const int x0 = skyline[best].x;
+	const int x1 = x0 + p_rect_size.x;
+	int end = best;
+	while (end < n && skyline[end].x < x1) {
+		end++;
+	}
+
+	Vector<Point2i> updated;
+	for (int i = 0; i < best; i++) {
+		updated.push_back(skyline[i]);
+	}
+	if (updated.empty() || updated[updated.size() - 1].y != best_y + p_rect_size.y) {
+		updated.push_back(Point2i(x0, best_y + p_rect_size.y));
+	}
+	// the segment the rect ends in goes on at its old height.
+	if (x1 < p_size && (end == n || skyline[end].x > x1) && skyline[end - 1].y != best_y + p_rect_size.y) {
+		updated.push_back(Point2i(x1, skyline[end - 1].y));
+	}
+	for (int i = end; i < n; i++) {
+		if (skyline[i].y != updated[updated.size() - 1].y) {
+			updated.push_back(skyline[i]);
+		}
+	}
+
+	p_page.skyline = updated;
+	r_position = Point2i(x0, best_y);
+	return true;
+}
+
+void VGSpriteRenderer::compact_atlas_page(int p_page) {
+	struct Taller {
+		bool operator()(const List<AtlasEntry>::Element *p_a, const List<AtlasEntry>::Element *p_b) const {
+			return p_a->get().rect.size.y > p_b->get().rect.size.y;
+		}
+	};
+
+	// tallest first packs tightest.
+	Vector<List<AtlasEntry>::Element *> entries;
+	for (List<AtlasEntry>::Element *E = atlas_entries.front(); E; E = E->next()) {
+		if (E->get().page == p_page) {
+			entries.push_back(E);
+		}
+	}
+	entries.sort_custom<Taller>();
+
+	AtlasPage &page = atlas_pages.write[p_page];
+	const int pixel_size = get_pixel_size(page.mask);
+	PoolVector<uint8_t> pixels;
+	ERR_FAIL_COND(pixels.resize(atlas_size * atlas_size * pixel_size) != OK);
+	page.skyline.clear();
+	page.skyline.push_back(Point2i());
+
+	{
+		PoolVector<uint8_t>::Read sr = page.pixels.read();
+		PoolVector<uint8_t>::Write dw = pixels.write();
+		memset(&dw[0], 0, atlas_size * atlas_size * pixel_size);
+
+		for (int i = 0; i < entries.size(); i++) {
+			AtlasEntry &e = entries[i]->get();
+			// the regions move, paths need to draw them again.
+			update_path(e.path);
+
+			Point2i position;
+			if (!pack_atlas_rect(page, atlas_size, e.rect.size, position)) {
+				// packed worse than before, the path draws its own texture.
+				atlas_index.erase(get_atlas_key(e.path, e.scale_bucket));
+				atlas_entries.erase(entries[i]);
+				continue;
+			}
+
+			for (int y = 0; y < e.rect.size.y; y++) {
+				memcpy(&dw[((position.y + y) * atlas_size + position.x) * pixel_size],
+						&sr[((e.rect.position.y + y) * atlas_size + e.rect.position.x) * pixel_size],
+						e.rect.size.x * pixel_size);
+			}
+			e.rect.position = position;
+			e.texture->set_region(Rect2(e.rect.position + Point2i(VG_SPRITE_ATLAS_GUTTER, VG_SPRITE_ATLAS_GUTTER),
+					e.rect.size - Size2i(2 * VG_SPRITE_ATLAS_GUTTER, 2 * VG_SPRITE_ATLAS_GUTTER)));
+		}
+	}
+
+	page.pixels = pixels;
+	page.free_area = 0;
+	upload_pixels(page.pixels, atlas_size, atlas_size, page.mask, page.texture);
+}
+
+void VGSpriteRenderer::remove_atlas_entry(List<AtlasEntry>::Element *p_entry) {
+	const AtlasEntry &e = p_entry->get();
+	atlas_pages.write[e.page].free_area += e.rect.get_area();
+	// the path may still be drawing the region.
+	update_path(e.path);
+	atlas_index.erase(get_atlas_key(e.path, e.scale_bucket));
+	atlas_entries.erase(p_entry);
+}
+
+bool VGSpriteRenderer::allocate_atlas_rect(bool p_mask, const Size2i &p_size, int &r_page, Point2i &r_position) {
+	const uint64_t page_bytes = uint64_t(atlas_size) * atlas_size * get_pixel_size(p_mask);
+
+	while (true) {
+		for (int i = 0; i < atlas_pages.size(); i++) {
+			if (atlas_pages[i].mask == p_mask && pack_atlas_rect(atlas_pages.write[i], atlas_size, p_size, r_position)) {
+				r_page = i;
+				return true;
+			}
+		}
+
+		// the room that removed entries left behind.
+		for (int i = 0; i < atlas_pages.size(); i++) {
+			if (atlas_pages[i].mask == p_mask && atlas_pages[i].free_area >= p_size.x * p_size.y) {
+				compact_atlas_page(i);
+				if (pack_atlas_rect(atlas_pages.write[i], atlas_size, p_size, r_position)) {
+					r_page = i;
+					return true;
+				}
+			}
+		}
+
+		if (get_atlas_bytes() + page_bytes <= uint64_t(atlas_budget_kb) * 1024) {
+			AtlasPage page;
+			page.mask = p_mask;
+			page.free_area = 0;
+			page.skyline.push_back(Point2i());
+			ERR_FAIL_COND_V(page.pixels.resize(page_bytes) != OK, false);
+			{
+				PoolVector<uint8_t>::Write dw = page.pixels.write();
+				memset(&dw[0], 0, page_bytes);
+			}
+			upload_pixels(page.pixels, atlas_size, atlas_size, p_mask, page.texture);
+			atlas_pages.push_back(page);
+
+			r_page = atlas_pages.size() - 1;
+			return pack_atlas_rect(atlas_pages.write[r_page], atlas_size, p_size, r_position);
+		}
+
+		// the entry drawn longest ago makes room.
+		List<AtlasEntry>::Element *E = atlas_entries.back();
+		while (E && atlas_pages[E->get().page].mask != p_mask) {
+			E = E->prev();
+		}
+		if (!E) {
+			return false;
+		}
+		remove_atlas_entry(E);
+	}
+}
+
+void VGSpriteRenderer::write_atlas_rect(AtlasPage &p_page, const Rect2i &p_rect, const PoolVector<uint8_t> &p_pixels, int p_width, int p_height) {
+	const int pixel_size = get_pixel_size(p_page.mask);
+	const int row_bytes = p_rect.size.x * pixel_size;
+	PoolVector<uint8_t> update;
+	ERR_FAIL_COND(update.resize(p_rect.size.y * row_bytes) != OK);
+
+	{
+		PoolVector<uint8_t>::Read sr = p_pixels.read();
+		PoolVector<uint8_t>::Write uw = update.write();
+		PoolVector<uint8_t>::Write pw = p_page.pixels.write();
+		for (int y = 0; y < p_rect.size.y; y++) {
+			const uint8_t *src = &sr[CLAMP(y - VG_SPRITE_ATLAS_GUTTER, 0, p_height - 1) * p_width * pixel_size];
+			uint8_t *dst = &uw[y * row_bytes];
+			for (int x = 0; x < VG_SPRITE_ATLAS_GUTTER; x++) {
+				memcpy(&dst[x * pixel_size], src, pixel_size);
+				memcpy(&dst[(VG_SPRITE_ATLAS_GUTTER + p_width + x) * pixel_size], &src[(p_width - 1) * pixel_size], pixel_size);
+			}
+			memcpy(&dst[VG_SPRITE_ATLAS_GUTTER * pixel_size], src, p_width * pixel_size);
+			memcpy(&pw[((p_rect.position.y + y) * atlas_size + p_rect.position.x) * pixel_size], dst, row_bytes);
+		}
+	}
+
+	Ref<Image> image;
+	image.instance();
+	image->create(p_rect.size.x, p_rect.size.y, false, p_page.texture->get_format(), update);
+	p_page.texture->set_data_partial(image, p_rect.position.x, p_rect.position.y);
+}
+
+void VGSpriteRenderer::add_to_atlas(ObjectID p_path, int p_bucket, uint64_t p_content_key, bool p_mask, const Rect2 &p_bounds, const PoolVector<uint8_t> &p_pixels, int p_width, int p_height) {
+	if (atlas_size == 0) {
+		return;
+	}
+
+	// clipped graphics have no key to tell their pixels by, and large
+	// sprites would leave little room for the rest.
+	const Size2i size(p_width + 2 * VG_SPRITE_ATLAS_GUTTER, p_height + 2 * VG_SPRITE_ATLAS_GUTTER);
+	const bool fits = p_content_key != 0 && p_width > 0 && p_height > 0 &&
+			size.x <= atlas_size / 2 && size.y <= atlas_size / 2;
+
+	const uint64_t key = get_atlas_key(p_path, p_bucket);
+	List<AtlasEntry>::Element **E = atlas_index.getptr(key);
+	if (E) {
+		AtlasEntry &e = (*E)->get();
+		if (fits && e.rect.size == size && atlas_pages[e.page].mask == p_mask) {
+			// re-rasterized at the same size, it keeps its region.
+			e.content_key = p_content_key;
+			e.bounds = p_bounds;
+			write_atlas_rect(atlas_pages.write[e.page], e.rect, p_pixels, p_width, p_height);
+			atlas_entries.move_to_front(*E);
+			return;
+		}
+		remove_atlas_entry(*E);
+	}
+	if (!fits) {
+		return;
+	}
+
+	AtlasEntry entry;
+	entry.path = p_path;
+	entry.scale_bucket = p_bucket;
+	entry.content_key = p_content_key;
+	entry.bounds = p_bounds;
+	Point2i position;
+	if (!allocate_atlas_rect(p_mask, size, entry.page, position)) {
+		return;
+	}
+	entry.rect = Rect2i(position, size);
+	entry.texture.instance();
+	entry.texture->set_atlas(atlas_pages[entry.page].texture);
+	entry.texture->set_region(Rect2(position.x + VG_SPRITE_ATLAS_GUTTER, position.y + VG_SPRITE_ATLAS_GUTTER, p_width, p_height));
+
+	write_atlas_rect(atlas_pages.write[entry.page], entry.rect, p_pixels, p_width, p_height);
+	atlas_index.set(key, atlas_entries.push_front(entry));
+}
+
+bool VGSpriteRenderer::draw_atlas_entry(VGPath *p_path) {
+	const VGSpriteState &state = p_path->get_sprite_state();
+	if (atlas_size == 0 || state.texture_key == 0 || !state.has_scale_bucket) {
+		return false;
+	}
+
+	List<AtlasEntry>::Element **E = atlas_index.getptr(get_atlas_key(p_path->get_instance_id(), state.scale_bucket));
+	if (!E || (*E)->get().content_key != state.texture_key) {
+		return false;
+	}
+
+	atlas_entries.move_to_front(*E);
+	const AtlasEntry &entry = (*E)->get();
+	// masks get their tint from the vertex colors otherwise.
+	p_path->draw_texture_rect(entry.texture, entry.bounds, false, state.mask ? state.tint : Color(1, 1, 1));
+	return true;
+}
+
+uint64_t VGSpriteRenderer::get_cache_key(ObjectID p_path, int p_bucket) {
+	const uint64_t key = hash_djb2_one_64(uint64_t(p_path));
+	return hash_djb2_one_64(uint64_t(uint32_t(p_bucket)), key);
+}
+
+void VGSpriteRenderer::erase_cache_entry(List<CacheEntry>::Element *p_entry) {
+	const uint64_t key = get_cache_key(p_entry->get().path, p_entry->get().scale_bucket);
+	List<CacheEntry>::Element **E = cache_index.getptr(key);
+	// another entry may have taken the key.
+	if (E && *E == p_entry) {
+		cache_index.erase(key);
+	}
+	cache.erase(p_entry);
+}
+
+List<VGSpriteRenderer::CacheEntry>::Element *VGSpriteRenderer::find_cache_entry(ObjectID p_path, int p_bucket) {
+	List<CacheEntry>::Element **E = cache_index.getptr(get_cache_key(p_path, p_bucket));
+	if (!E || (*E)->get().path != p_path || (*E)->get().scale_bucket != p_bucket) {
+		return nullptr;
+	}
+	return *E;
+}
+
+List<VGSpriteRenderer::CacheEntry>::Element *VGSpriteRenderer::touch_cache_entry(ObjectID p_path, int p_bucket) {
+	List<CacheEntry>::Element *entry = find_cache_entry(p_path, p_bucket);
+	if (entry) {
+		cache.move_to_front(entry);
+		return entry;
+	}
+
+	CacheEntry new_entry;
+	new_entry.path = p_path;
+	new_entry.scale_bucket = p_bucket;
+	new_entry.content_key = 0;
+	new_entry.bytes = 0;
+	entry = cache.push_front(new_entry);
+	cache_index.set(get_cache_key(p_path, p_bucket), entry);
+	return entry;
+}
+
+bool VGSpriteRenderer::commit_cache_entry(List<CacheEntry>::Element *p_entry, uint64_t p_content_key) {
+	CacheEntry &e = p_entry->get();
+	cache_bytes -= e.bytes;
+
+	if (e.texture.is_null()) {
+		erase_cache_entry(p_entry);
+		return false;
+	}
+
+	e.content_key = p_content_key;
+	e.bytes = e.texture->get_width() * e.texture->get_height() * get_pixel_size(e.texture->get_format() == Image::FORMAT_L8);
+	cache_bytes += e.bytes;
+
+	trim_cache();
+	return true;
+}
+
+void VGSpriteRenderer::trim_cache() {
+	const uint64_t budget = uint64_t(cache_budget_kb) * 1024;
+	// the front entry is on screen, evicting it would not free anything.
+	while (cache.size() > 1 && cache_bytes > budget) {
+		cache_bytes -= cache.back()->get().bytes;
+		erase_cache_entry(cache.back());
+	}
+	if (budget == 0) {
+		clear_cache();
+	}
+}
+
+int VGSpriteRenderer::select_scale_bucket(const VGSpriteState &p_state, float p_scale) const {
+	const float bucket = p_scale > CMP_EPSILON ? scale_steps * Math::log(p_scale) / Math_LN2 : -16 * scale_steps;
+
+	if (p_state.has_scale_bucket) {
+		const int current = p_state.scale_bucket;
+		if (bucket > current - 1 - scale_hysteresis && bucket <= current + scale_hysteresis) {
+			return current;
+		}
+	}
+
+	// rounding up, so that textures get scaled down, not up.
+	return Math::ceil(bucket);
+}
+
+float VGSpriteRenderer::get_scale_bucket_resolution(int p_bucket) const {
+	return quality * Math::pow(2.0, p_bucket / double(scale_steps));
+}
+
+uint64_t VGSpriteRenderer::get_content_key(const tove::GraphicsRef &p_graphics, bool p_mask) const {
+	uint32_t quality_bits;
+	memcpy(&quality_bits, &quality, sizeof(quality_bits));
+	uint64_t key = hash_djb2_one_64(premultiplied_alpha ? 1 : 0);
+	key = hash_djb2_one_64(quality_bits, key);
+	key = hash_djb2_one_64(uint64_t(quality_tier), key);
+	key = hash_djb2_one_64(p_mask ? 1 : 0, key);
+
+	const int n = p_graphics->getNumPaths();
+	for (int i = 0; i < n; i++) {
+		const tove::PathRef &path = p_graphics->getPath(i);
+		// clip paths are not part of the fingerprints.
+		if (!path->getClipIndices().empty()) {
+			return 0;
+		}
+		key = tove_path_fingerprint(path, key);
+		// one mask serves all colors.
+		key = p_mask ? tove_paint_alpha_fingerprint(path, key) : tove_paint_fingerprint(path, key);
+	}
+
+	// 0 marks graphics that cannot be cached.
+	return key != 0 ? key : 1;
+}
+
 void VGSpriteRenderer::_bind_methods() {
 	ClassDB::bind_method(D_METHOD("set_quality", "quality"), &VGSpriteRenderer::set_quality);
 	ClassDB::bind_method(D_METHOD("get_quality"), &VGSpriteRenderer::get_quality);
+	ClassDB::bind_method(D_METHOD("set_quality_tier", "tier"), &VGSpriteRenderer::set_quality_tier);
+	ClassDB::bind_method(D_METHOD("get_quality_tier"), &VGSpriteRenderer::get_quality_tier);
+
+	ClassDB::bind_method(D_METHOD("set_thread_count", "thread_count"), &VGSpriteRenderer::set_thread_count);
+	ClassDB::bind_method(D_METHOD("get_thread_count"), &VGSpriteRenderer::get_thread_count);
+
+	ClassDB::bind_method(D_METHOD("set_premultiplied_alpha", "enabled"), &VGSpriteRenderer::set_premultiplied_alpha);
+	ClassDB::bind_method(D_METHOD("get_premultiplied_alpha"), &VGSpriteRenderer::get_premultiplied_alpha);
+	ClassDB::bind_method(D_METHOD("set_analytic_coverage", "enabled"), &VGSpriteRenderer::set_analytic_coverage);
+	ClassDB::bind_method(D_METHOD("get_analytic_coverage"), &VGSpriteRenderer::get_analytic_coverage);
+	ClassDB::bind_method(D_METHOD("set_alpha_masks", "enabled"), &VGSpriteRenderer::set_alpha_masks);
+	ClassDB::bind_method(D_METHOD("get_alpha_masks"), &VGSpriteRenderer::get_alpha_masks);
+
+	ClassDB::bind_method(D_METHOD("set_scale_steps", "steps"), &VGSpriteRenderer::set_scale_steps);
+	ClassDB::bind_method(D_METHOD("get_scale_steps"), &VGSpriteRenderer::get_scale_steps);
+	ClassDB::bind_method(D_METHOD("set_scale_hysteresis", "hysteresis"), &VGSpriteRenderer::set_scale_hysteresis);
+	ClassDB::bind_method(D_METHOD("get_scale_hysteresis"), &VGSpriteRenderer::get_scale_hysteresis);
+	ClassDB::bind_method(D_METHOD("set_cache_budget_kb", "kb"), &VGSpriteRenderer::set_cache_budget_kb);
+	ClassDB::bind_method(D_METHOD("get_cache_budget_kb"), &VGSpriteRenderer::get_cache_budget_kb);
+	ClassDB::bind_method(D_METHOD("get_cache_hits"), &VGSpriteRenderer::get_cache_hits);
+	ClassDB::bind_method(D_METHOD("get_cache_misses"), &VGSpriteRenderer::get_cache_misses);
+	ClassDB::bind_method(D_METHOD("get_cache_size_kb"), &VGSpriteRenderer::get_cache_size_kb);
+	ClassDB::bind_method(D_METHOD("reset_cache_counters"), &VGSpriteRenderer::reset_cache_counters);
+	ClassDB::bind_method(D_METHOD("clear_cache"), &VGSpriteRenderer::clear_cache);
+
+	ClassDB::bind_method(D_METHOD("set_asynchronous", "enabled"), &VGSpriteRenderer::set_asynchronous);
+	ClassDB::bind_method(D_METHOD("get_asynchronous"), &VGSpriteRenderer::get_asynchronous);
+	ClassDB::bind_method(D_METHOD("get_jobs_queued"), &VGSpriteRenderer::get_jobs_queued);
+	ClassDB::bind_method(D_METHOD("get_jobs_completed"), &VGSpriteRenderer::get_jobs_completed);
+	ClassDB::bind_method(D_METHOD("get_jobs_dropped"), &VGSpriteRenderer::get_jobs_dropped);
+	ClassDB::bind_method(D_METHOD("reset_job_counters"), &VGSpriteRenderer::reset_job_counters);
+	ClassDB::bind_method(D_METHOD("_finish_jobs"), &VGSpriteRenderer::_finish_jobs);
+
+	ClassDB::bind_method(D_METHOD("get_full_updates"), &VGSpriteRenderer::get_full_updates);
+	ClassDB::bind_method(D_METHOD("get_partial_updates"), &VGSpriteRenderer::get_partial_updates);
+	ClassDB::bind_method(D_METHOD("reset_update_counters"), &VGSpriteRenderer::reset_update_counters);
+
+	ClassDB::bind_method(D_METHOD("set_tile_size", "size"), &VGSpriteRenderer::set_tile_size);
+	ClassDB::bind_method(D_METHOD("get_tile_size"), &VGSpriteRenderer::get_tile_size);
+	ClassDB::bind_method(D_METHOD("set_tile_budget_kb", "kb"), &VGSpriteRenderer::set_tile_budget_kb);
+	ClassDB::bind_method(D_METHOD("get_tile_budget_kb"), &VGSpriteRenderer::get_tile_budget_kb);
+	ClassDB::bind_method(D_METHOD("get_tile_count"), &VGSpriteRenderer::get_tile_count);
+	ClassDB::bind_method(D_METHOD("get_tile_cache_size_kb"), &VGSpriteRenderer::get_tile_cache_size_kb);
+	ClassDB::bind_method(D_METHOD("clear_tiles"), &VGSpriteRenderer::clear_tiles);
+
+	ClassDB::bind_method(D_METHOD("set_atlas_size", "size"), &VGSpriteRenderer::set_atlas_size);
+	ClassDB::bind_method(D_METHOD("get_atlas_size"), &VGSpriteRenderer::get_atlas_size);
+	ClassDB::bind_method(D_METHOD("set_atlas_budget_kb", "kb"), &VGSpriteRenderer::set_atlas_budget_kb);
+	ClassDB::bind_method(D_METHOD("get_atlas_budget_kb"), &VGSpriteRenderer::get_atlas_budget_kb);
+	ClassDB::bind_method(D_METHOD("get_atlas_page_count"), &VGSpriteRenderer::get_atlas_page_count);
+	ClassDB::bind_method(D_METHOD("get_atlas_entry_count"), &VGSpriteRenderer::get_atlas_entry_count);
+	ClassDB::bind_method(D_METHOD("clear_atlas"), &VGSpriteRenderer::clear_atlas);
 
 	ADD_PROPERTY(PropertyInfo(Variant::REAL, "quality", PROPERTY_HINT_RANGE, "0,1,0.01"), "set_quality", "get_quality");
+	ADD_PROPERTY(PropertyInfo(Variant::INT, "quality_tier", PROPERTY_HINT_ENUM, "Preview,Normal,Final"), "set_quality_tier", "get_quality_tier");
+
+	ADD_PROPERTY(PropertyInfo(Variant::INT, "thread_count", PROPERTY_HINT_RANGE, "0,64,1"), "set_thread_count", "get_thread_count");
+
+	ADD_PROPERTY(PropertyInfo(Variant::BOOL, "premultiplied_alpha"), "set_premultiplied_alpha", "get_premultiplied_alpha");
+	ADD_PROPERTY(PropertyInfo(Variant::BOOL, "analytic_coverage"), "set_analytic_coverage", "get_analytic_coverage");
+	ADD_PROPERTY(PropertyInfo(Variant::BOOL, "alpha_masks"), "set_alpha_masks", "get_alpha_masks");
+
+	ADD_PROPERTY(PropertyInfo(Variant::INT, "scale_steps", PROPERTY_HINT_RANGE, "1,16,1"), "set_scale_steps", "get_scale_steps");
+	ADD_PROPERTY(PropertyInfo(Variant::REAL, "scale_hysteresis", PROPERTY_HINT_RANGE, "0,1,0.01"), "set_scale_hysteresis", "get_scale_hysteresis");
+	ADD_PROPERTY(PropertyInfo(Variant::INT, "cache_budget_kb", PROPERTY_HINT_RANGE, "0,1048576,1,or_greater"), "set_cache_budget_kb", "get_cache_budget_kb");
+
+	ADD_PROPERTY(PropertyInfo(Variant::BOOL, "asynchronous"), "set_asynchronous", "get_asynchronous");
+
+	ADD_PROPERTY(PropertyInfo(Variant::INT, "tile_size", PROPERTY_HINT_RANGE, "0,4096,1"), "set_tile_size", "get_tile_size");
+	ADD_PROPERTY(PropertyInfo(Variant::INT, "tile_budget_kb", PROPERTY_HINT_RANGE, "0,1048576,1,or_greater"), "set_tile_budget_kb", "get_tile_budget_kb");
+
+	ADD_PROPERTY(PropertyInfo(Variant::INT, "atlas_size", PROPERTY_HINT_RANGE, "0,8192,1"), "set_atlas_size", "get_atlas_size");
+	ADD_PROPERTY(PropertyInfo(Variant::INT, "atlas_budget_kb", PROPERTY_HINT_RANGE, "0,1048576,1,or_greater"), "set_atlas_budget_kb", "get_atlas_budget_kb");
+
+	ADD_SIGNAL(MethodInfo("texture_ready", PropertyInfo(Variant::OBJECT, "path")));
+
+	BIND_ENUM_CONSTANT(QUALITY_TIER_PREVIEW);
+	BIND_ENUM_CONSTANT(QUALITY_TIER_NORMAL);
+	BIND_ENUM_CONSTANT(QUALITY_TIER_FINAL);
 }
 
 Rect2 VGSpriteRenderer::render_mesh(Ref<ArrayMesh> &p_mesh, Ref<Material> &r_material, Ref<Texture> &r_texture, VGPath *p_path, bool p_hq, bool p_spatial) {
@@ -65,15 +1293,23 @@ Rect2 VGSpriteRenderer::render_mesh(Ref<ArrayMesh> &p_mesh, Ref<Material> &r_mat
 	const float w = bounds[2] - bounds[0];
 	const float h = bounds[3] - bounds[1];
 
+	// the texture render_texture() gives the path next.
+	Color tint;
+	const bool mask = !p_hq && get_mask_tint(p_path, graphics, tint);
+
 	PoolVector<Vector3> faces;
 	PoolVector<Vector3> normals;
 	PoolVector<float> tangents;
 	PoolVector<Vector2> uvs;
+	PoolVector<Color> colors;
 
 	ERR_FAIL_COND_V(faces.resize(6) != OK, Rect2());
 	ERR_FAIL_COND_V(normals.resize(6) != OK, Rect2());
 	ERR_FAIL_COND_V(tangents.resize(6 * 4), Rect2());
 	ERR_FAIL_COND_V(uvs.resize(6), Rect2());
+	if (mask) {
+		ERR_FAIL_COND_V(colors.resize(6), Rect2());
+	}
 
 	Vector2 position = Vector2(bounds[0], bounds[1]);
 	Vector2 size = Size2(w, h);
@@ -107,6 +1343,9 @@ Rect2 VGSpriteRenderer::render_mesh(Ref<ArrayMesh> &p_mesh, Ref<Material> &r_mat
 		};
 
 		uvs.set(i, quad_uv[j]);
+		if (mask) {
+			colors.set(i, tint);
+		}
 	}
 
 	Array arr;
@@ -116,6 +1355,9 @@ Rect2 VGSpriteRenderer::render_mesh(Ref<ArrayMesh> &p_mesh, Ref<Material> &r_mat
 	arr[VS::ARRAY_NORMAL] = normals;
 	arr[VS::ARRAY_TANGENT] = tangents;
 	arr[VS::ARRAY_TEX_UV] = uvs;
+	if (mask) {
+		arr[VS::ARRAY_COLOR] = colors;
+	}
 
 	clear_mesh(p_mesh);
 	p_mesh->add_surface_from_arrays(Mesh::PRIMITIVE_TRIANGLES, arr);
@@ -123,24 +1365,538 @@ Rect2 VGSpriteRenderer::render_mesh(Ref<ArrayMesh> &p_mesh, Ref<Material> &r_mat
 	return tove_bounds_to_rect2(p_path->get_tove_path()->getBounds());
 }
 
+uint64_t VGSpriteRenderer::get_frame_key(float p_resolution, float p_tx, float p_ty, int p_width, int p_height, bool p_mask) const {
+	const float values[3] = { p_resolution, p_tx, p_ty };
+	uint64_t key = hash_djb2_one_64(uint64_t(p_width));
+	key = hash_djb2_one_64(uint64_t(p_height), key);
+	for (int i = 0; i < 3; i++) {
+		uint32_t bits;
+		memcpy(&bits, &values[i], sizeof(bits));
+		key = hash_djb2_one_64(bits, key);
+	}
+	key = hash_djb2_one_64(premultiplied_alpha ? 1 : 0, key);
+	key = hash_djb2_one_64(p_mask ? 1 : 0, key);
+	key = hash_djb2_one_64(uint64_t(quality_tier), key);
+	return hash_djb2_one_64(uint64_t(get_raster_engine()), key);
+}
+
+void VGSpriteRenderer::rasterize_into(const tove::GraphicsRef &p_graphics, uint8_t *p_pixels, int p_width, int p_height, float p_tx, float p_ty, float p_scale, QualityTier p_quality_tier, ToveRasterizeEngine p_engine, int p_thread_count, int p_flags) {
+	const int threads = p_thread_count > 0 ? p_thread_count : OS::get_singleton()->get_processor_count();
+	// the background worker holds the pool for a whole sprite. rather than
+	// wait for it, a raster that finds the pool busy runs on its own thread.
+	if (threads <= 1 || p_height < VG_BANDED_RASTER_MIN_ROWS || raster_pool_mutex.try_lock() != OK) {
+		tove_graphics_rasterize_into(p_graphics, p_pixels, p_width, p_height, p_tx, p_ty, p_scale,
+				p_quality_tier, p_engine, nullptr, 1, p_flags);
+		return;
+	}
+
+	if (raster_pool_threads != threads) {
+		if (raster_pool_threads > 0) {
+			raster_pool.finish();
+		}
+		raster_pool.init(threads);
+		raster_pool_threads = threads;
+	}
+	tove_graphics_rasterize_into(p_graphics, p_pixels, p_width, p_height, p_tx, p_ty, p_scale,
+			p_quality_tier, p_engine, &raster_pool, threads, p_flags);
+	raster_pool_mutex.unlock();
+}
+
+// redraws only the pixels that paths changed since the last rasterization,
+// clearing them first, and uploads only these. false if that is not possible
+// or not worth it.
+bool VGSpriteRenderer::rasterize_dirty_rect(VGSpriteState &p_state, const tove::GraphicsRef &p_graphics, float p_resolution, float p_tx, float p_ty, const Vector<uint64_t> &p_path_keys, const Vector<Rect2> &p_path_bounds, Ref<ImageTexture> &r_texture) {
+	if (p_path_keys.empty() || p_path_keys.size() != p_state.path_keys.size()) {
+		return false;
+	}
+	if (r_texture.is_null() || r_texture->get_instance_id() != p_state.uploaded) {
+		return false;
+	}
+
+	const int w = p_state.width;
+	const int h = p_state.height;
+	const int pixel_size = get_pixel_size(p_state.mask);
+	const Rect2i image = Rect2i(0, 0, w, h);
+
+	Rect2i dirty;
+	bool changed = false;
+	for (int i = 0; i < p_path_keys.size(); i++) {
+		if (p_path_keys[i] == p_state.path_keys[i]) {
+			continue;
+		}
+		// where the path was, and where it is now.
+		const Rect2i rect = get_path_rect(p_state.path_bounds[i], p_resolution, p_tx, p_ty).merge(
+				get_path_rect(p_path_bounds[i], p_resolution, p_tx, p_ty));
+		dirty = changed ? dirty.merge(rect) : rect;
+		changed = true;
+	}
+
+	if (!changed) {
+		// the texture already shows all of it.
+		return true;
+	}
+
+	dirty = dirty.clip(image);
+	if (dirty.has_no_area()) {
+		return true;
+	}
+	if (dirty.get_area() > w * h * VG_SPRITE_MAX_DIRTY_AREA) {
+		return false;
+	}
+
+	// one more pixel around the rect, so that defringing sees the same
+	// neighbours as when rasterizing the whole sprite.
+	const Rect2i area = dirty.grow(1).clip(image);
+	PoolVector<uint8_t> scratch;
+	ERR_FAIL_COND_V(scratch.resize(area.size.x * area.size.y * pixel_size) != OK, false);
+	PoolVector<uint8_t> update;
+	ERR_FAIL_COND_V(update.resize(dirty.size.x * dirty.size.y * pixel_size) != OK, false);
+
+	{
+		PoolVector<uint8_t>::Write sw = scratch.write();
+		// shapes get clipped to the area by the rasterizer.
+		rasterize_into(p_graphics, &sw[0], area.size.x, area.size.y,
+				p_tx - area.position.x, p_ty - area.position.y, p_resolution, quality_tier,
+				get_raster_engine(), thread_count, get_raster_flags(p_state.mask));
+
+		PoolVector<uint8_t>::Write dw = p_state.pixels.write();
+		PoolVector<uint8_t>::Write uw = update.write();
+		const int row_bytes = dirty.size.x * pixel_size;
+		for (int y = 0; y < dirty.size.y; y++) {
+			const uint8_t *src = &sw[((dirty.position.y - area.position.y + y) * area.size.x + dirty.position.x - area.position.x) * pixel_size];
+			memcpy(&dw[((dirty.position.y + y) * w + dirty.position.x) * pixel_size], src, row_bytes);
+			memcpy(&uw[y * row_bytes], src, row_bytes);
+		}
+	}
+
+	Ref<Image> image_update;
+	image_update.instance();
+	image_update->create(dirty.size.x, dirty.size.y, false, r_texture->get_format(), update);
+	r_texture->set_data_partial(image_update, dirty.position.x, dirty.position.y);
+
+	partial_updates++;
+	return true;
+}
+
+void VGSpriteRenderer::rasterize_state(VGSpriteState &p_state, const tove::GraphicsRef &p_graphics, float p_resolution, Ref<ImageTexture> &r_texture) {
+	const float *bounds = p_graphics->getExactBounds();
+	const int w = Math::ceil((bounds[2] - bounds[0]) * p_resolution);
+	const int h = Math::ceil((bounds[3] - bounds[1]) * p_resolution);
+	ERR_FAIL_COND(w <= 0 || h <= 0);
+
+	const float tx = -bounds[0] * p_resolution;
+	const float ty = -bounds[1] * p_resolution;
+	const int pixel_size = get_pixel_size(p_state.mask);
+
+	if (w != p_state.width || h != p_state.height) {
+		ERR_FAIL_COND(p_state.pixels.resize(w * h * pixel_size) != OK);
+		PoolVector<uint8_t>::Write dw = p_state.pixels.write();
+		memset(&dw[0], 0, w * h * pixel_size);
+		p_state.width = w;
+		p_state.height = h;
+		p_state.used.clear();
+		p_state.path_keys.clear();
+	}
+
+	Vector<uint64_t> path_keys;
+	Vector<Rect2> path_bounds;
+	get_path_keys(p_graphics, p_state.mask, path_keys, path_bounds);
+
+	Vector<Rect2i> used;
+	get_used_rects(p_graphics, p_resolution, tx, ty, w, h, used);
+
+	const uint64_t frame_key = get_frame_key(p_resolution, tx, ty, w, h, p_state.mask);
+	if (frame_key != p_state.frame_key) {
+		p_state.path_keys.clear();
+	}
+
+	if (!rasterize_dirty_rect(p_state, p_graphics, p_resolution, tx, ty, path_keys, path_bounds, r_texture)) {
+		{
+			PoolVector<uint8_t>::Write dw = p_state.pixels.write();
+
+			// everything outside of the rects used last time is still zero.
+			clear_rects(&dw[0], w, pixel_size, p_state.used);
+			clear_rects(&dw[0], w, pixel_size, used);
+
+			rasterize_into(p_graphics, &dw[0], w, h, tx, ty, p_resolution, quality_tier, get_raster_engine(), thread_count,
+					tove::NSVG_RASTER_NO_CLEAR | get_raster_flags(p_state.mask));
+		}
+
+		upload_pixels(p_state.pixels, w, h, p_state.mask, r_texture);
+		full_updates++;
+	}
+
+	p_state.used = used;
+	p_state.frame_key = frame_key;
+	p_state.path_keys = path_keys;
+	p_state.path_bounds = path_bounds;
+	p_state.uploaded = r_texture.is_valid() ? r_texture->get_instance_id() : ObjectID(0);
+}
+
+void VGSpriteRenderer::queue_job(VGSpriteState &p_state, ObjectID p_path, const tove::GraphicsRef &p_graphics, int p_bucket, float p_resolution, uint64_t p_content_key) {
+	RasterJob job;
+	job.path = p_path;
+	job.serial = ++p_state.job_serial;
+	job.graphics = copy_graphics(p_graphics);
+	job.bounds = tove_bounds_to_rect2(p_graphics->getExactBounds());
+	job.scale_bucket = p_bucket;
+	job.resolution = p_resolution;
+	job.content_key = p_content_key;
+	job.mask = p_state.mask;
+	job.flags = get_raster_flags(job.mask);
+	job.engine = get_raster_engine();
+	job.quality_tier = quality_tier;
+	job.thread_count = thread_count;
+	job.is_tile = false;
+	job.width = 0;
+	job.height = 0;
+
+	p_state.job_pending = true;
+	jobs_queued++;
+
+	MutexLock lock(job_mutex);
+	if (!worker.is_started()) {
+		worker_exit = false;
+		worker.start(&VGSpriteRenderer::_worker_func, this);
+	}
+
+	for (List<RasterJob>::Element *E = pending_jobs.front(); E; E = E->next()) {
+		if (E->get().path == p_path && !E->get().is_tile) {
+			// the older job has not started yet, the new one takes its place.
+			E->get() = job;
+			jobs_dropped++;
+			return;
+		}
+	}
+
+	pending_jobs.push_back(job);
+	job_semaphore.post();
+}
+
+void VGSpriteRenderer::_worker_func(void *p_userdata) {
+	VGSpriteRenderer *self = (VGSpriteRenderer *)p_userdata;
+
+	while (true) {
+		self->job_semaphore.wait();
+
+		RasterJob job;
+		{
+			MutexLock lock(self->job_mutex);
+			if (self->worker_exit) {
+				return;
+			}
+			// tile jobs that went out of view leave their posts behind.
+			if (self->pending_jobs.empty()) {
+				continue;
+			}
+			job = self->pending_jobs.front()->get();
+			self->pending_jobs.pop_front();
+			self->running_tile = job.is_tile ? get_tile_key(job.path, job.scale_bucket, job.tile, job.content_key) : 0;
+		}
+
+		const float *bounds = job.graphics->getExactBounds();
+		int w = Math::ceil((bounds[2] - bounds[0]) * job.resolution);
+		int h = Math::ceil((bounds[3] - bounds[1]) * job.resolution);
+		float tx = -bounds[0] * job.resolution;
+		float ty = -bounds[1] * job.resolution;
+		if (job.is_tile) {
+			w = job.tile_rect.size.x + 2 * VG_SPRITE_TILE_GUTTER;
+			h = job.tile_rect.size.y + 2 * VG_SPRITE_TILE_GUTTER;
+			tx += VG_SPRITE_TILE_GUTTER - job.tile_rect.position.x;
+			ty += VG_SPRITE_TILE_GUTTER - job.tile_rect.position.y;
+		}
+
+		if (w > 0 && h > 0 && job.pixels.resize(w * h * get_pixel_size(job.mask)) == OK) {
+			PoolVector<uint8_t>::Write dw = job.pixels.write();
+			self->rasterize_into(job.graphics, &dw[0], w, h, tx, ty,
+					job.resolution, job.quality_tier, job.engine, job.thread_count, job.flags);
+			job.width = w;
+			job.height = h;
+		}
+		job.graphics = tove::GraphicsRef();
+
+		{
+			MutexLock lock(self->job_mutex);
+			if (self->worker_exit) {
+				return;
+			}
+			self->running_tile = 0;
+			self->finished_jobs.push_back(job);
+		}
+
+		// textures can only be uploaded on the main thread.
+		self->call_deferred("_finish_jobs");
+	}
+}
+
+void VGSpriteRenderer::_finish_jobs() {
+	List<RasterJob> jobs;
+	{
+		MutexLock lock(job_mutex);
+		jobs = finished_jobs;
+		finished_jobs.clear();
+	}
+
+	for (List<RasterJob>::Element *E = jobs.front(); E; E = E->next()) {
+		const RasterJob &job = E->get();
+
+		if (job.is_tile) {
+			// tiles stay useful when they went out of view, but not once
+			// the graphics changed.
+			VGPath *path = Object::cast_to<VGPath>(ObjectDB::get_instance(job.path));
+			if (!path || path->get_inherited_renderer().ptr() != this || job.width == 0 ||
+					path->get_sprite_state().tile_content_key != job.content_key) {
+				jobs_dropped++;
+				continue;
+			}
+
+			add_tile(job);
+			jobs_completed++;
+
+			const VGSpriteState &state = path->get_sprite_state();
+			if (state.tiled && state.scale_bucket == job.scale_bucket && state.visible_tiles.has_point(job.tile)) {
+				path->update();
+			}
+			continue;
+		}
+
+		// paths that were freed, changed renderers or asked for a newer job since.
+		VGPath *path = Object::cast_to<VGPath>(ObjectDB::get_instance(job.path));
+		if (!path || path->get_inherited_renderer().ptr() != this || path->get_sprite_state().job_serial != job.serial) {
+			jobs_dropped++;
+			continue;
+		}
+
+		VGSpriteState &state = path->get_sprite_state();
+		state.job_pending = false;
+		// the upload below does not go through the state's pixels.
+		state.path_keys.clear();
+
+		if (job.width == 0) {
+			jobs_dropped++;
+			continue;
+		}
+
+		if (cache_budget_kb > 0) {
+			List<CacheEntry>::Element *entry = touch_cache_entry(job.path, job.scale_bucket);
+			upload_pixels(job.pixels, job.width, job.height, job.mask, entry->get().texture);
+			const Ref<ImageTexture> texture = entry->get().texture;
+			if (!commit_cache_entry(entry, job.content_key)) {
+				jobs_dropped++;
+				continue;
+			}
+			state.texture = texture;
+		} else {
+			upload_pixels(job.pixels, job.width, job.height, job.mask, state.texture);
+		}
+		state.texture_key = job.content_key;
+		add_to_atlas(job.path, job.scale_bucket, job.content_key, job.mask, job.bounds, job.pixels, job.width, job.height);
+
+		jobs_completed++;
+		path->set_sprite_texture(state.texture);
+		emit_signal("texture_ready", path);
+	}
+}
+
+Ref<ImageTexture> VGSpriteRenderer::render_state(VGSpriteState &p_state, ObjectID p_path, const tove::GraphicsRef &p_graphics, float p_scale, bool p_mask) {
+	const int bucket = select_scale_bucket(p_state, p_scale);
+	p_state.scale_bucket = bucket;
+	p_state.has_scale_bucket = true;
+
+	// the mesh already got the vertex colors of the new kind of texture, so
+	// the old texture cannot stay on screen until a background job is done.
+	const bool switched = p_mask != p_state.mask;
+	if (switched) {
+		p_state.pixels = PoolVector<uint8_t>();
+		p_state.width = 0;
+		p_state.height = 0;
+		p_state.used.clear();
+		p_state.path_keys.clear();
+		p_state.texture = Ref<ImageTexture>();
+		p_state.texture_key = 0;
+		p_state.mask = p_mask;
+	}
+
+	const float resolution = get_scale_bucket_resolution(bucket);
+	// clipped graphics are neither cached nor copied for the worker.
+	const uint64_t content_key = cache_budget_kb > 0 || asynchronous || atlas_size > 0 ? get_content_key(p_graphics, p_mask) : 0;
+	const bool cached = cache_budget_kb > 0 && content_key != 0;
+
+	if (cached) {
+		List<CacheEntry>::Element *entry = find_cache_entry(p_path, bucket);
+		if (entry && entry->get().content_key == content_key) {
+			cache_hits++;
+			cache.move_to_front(entry);
+			// whatever is still running for this path is outdated now.
+			p_state.job_serial++;
+			p_state.job_pending = false;
+			p_state.texture = entry->get().texture;
+			p_state.texture_key = content_key;
+			return p_state.texture;
+		}
+		cache_misses++;
+	}
+
+	if (asynchronous && content_key != 0 && !switched) {
+		const uint64_t job_key = hash_djb2_one_64(uint64_t(bucket), content_key);
+		if (!p_state.job_pending || p_state.job_key != job_key) {
+			queue_job(p_state, p_path, p_graphics, bucket, resolution, content_key);
+			p_state.job_key = job_key;
+		}
+		// the last texture gets stretched over the new bounds until then.
+		return p_state.texture;
+	}
+
+	p_state.job_serial++;
+	p_state.job_pending = false;
+
+	const Rect2 bounds = tove_bounds_to_rect2(p_graphics->getExactBounds());
+
+	if (!cached) {
+		rasterize_state(p_state, p_graphics, resolution, p_state.texture);
+		p_state.texture_key = content_key;
+		add_to_atlas(p_path, bucket, content_key, p_mask, bounds, p_state.pixels, p_state.width, p_state.height);
+		return p_state.texture;
+	}
+
+	// an outdated texture for this bucket gets updated in place, textures of
+	// other buckets stay as they are.
+	List<CacheEntry>::Element *entry = touch_cache_entry(p_path, bucket);
+	rasterize_state(p_state, p_graphics, resolution, entry->get().texture);
+	const Ref<ImageTexture> texture = entry->get().texture;
+	if (!commit_cache_entry(entry, content_key)) {
+		return Ref<ImageTexture>();
+	}
+
+	p_state.texture = texture;
+	p_state.texture_key = content_key;
+	add_to_atlas(p_path, bucket, content_key, p_mask, bounds, p_state.pixels, p_state.width, p_state.height);
+	return p_state.texture;
+}
+
+bool VGSpriteRenderer::is_dirty_on_scale_change(VGPath *p_path) {
+	const VGSpriteState &state = p_path->get_sprite_state();
+	// tiled paths follow the camera in update_viewport().
+	if (!state.has_scale_bucket || state.tiled) {
+		return false;
+	}
+
+	const Size2 s = p_path->get_global_transform().get_scale();
+	return select_scale_bucket(state, MAX(ABS(s.width), ABS(s.height))) != state.scale_bucket;
+}
+
 Ref<ImageTexture> VGSpriteRenderer::render_texture(VGPath *p_path, bool p_hq) {
 	Size2 s = p_path->get_global_transform().get_scale();
 
+	tove::GraphicsRef graphics = p_path->get_subtree_graphics();
+
+	if (!p_hq) {
+		if (render_tiles(p_path, graphics)) {
+			// drawn by draw_path().
+			return Ref<ImageTexture>();
+		}
+		VGSpriteState &state = p_path->get_sprite_state();
+		const bool mask = get_mask_tint(p_path, graphics, state.tint);
+		return render_state(state, p_path->get_instance_id(), graphics, MAX(ABS(s.width), ABS(s.height)), mask);
+	}
+
 	float resolution = quality;
 	resolution *= MAX(s.width, s.height);
 
-	tove::GraphicsRef graphics = p_path->get_subtree_graphics();
+	// baked sprites get a texture of their own, and always straight alpha,
+	// since they are drawn with the default material.
 	const float *bounds = graphics->getExactBounds();
 	const float w = bounds[2] - bounds[0];
 	const float h = bounds[3] - bounds[1];
 
+	const int tw = Math::ceil(w * resolution);
+	const int th = Math::ceil(h * resolution);
+	ERR_FAIL_COND_V(tw <= 0, Ref<ImageTexture>());
+	ERR_FAIL_COND_V(th <= 0, Ref<ImageTexture>());
+
+	PoolVector<uint8_t> dst_image;
+	ERR_FAIL_COND_V(dst_image.resize(tw * th * 4) != OK, Ref<ImageTexture>());
+	{
+		PoolVector<uint8_t>::Write dw = dst_image.write();
+		rasterize_into(graphics, &dw[0], tw, th, -bounds[0] * resolution, -bounds[1] * resolution,
+				resolution, QUALITY_TIER_FINAL, get_raster_engine(), thread_count, 0);
+	}
+
+	Ref<Image> image;
+	image.instance();
+	image->create(tw, th, false, Image::FORMAT_RGBA8, dst_image);
+
 	Ref<ImageTexture> texture;
 	texture.instance();
-	texture->create_from_image(
-		tove_graphics_rasterize(
-			graphics,
-			Math::ceil(w * resolution), Math::ceil(h * resolution),
-			-bounds[0] * resolution, -bounds[1] * resolution,
-			resolution, p_hq), ImageTexture::FLAG_FILTER);
+	texture->create_from_image(image, ImageTexture::FLAG_FILTER);
 	return texture;
 }
+
+Ref<Material> VGSpriteRenderer::get_canvas_material(VGPath *p_path) {
+	if (p_path->get_sprite_state().mask) {
+		return mask_materials[premultiplied_alpha ? 1 : 0];
+	}
+	// straight alpha textures use the default material.
+	return premultiplied_alpha ? get_sprite_premultiplied_material() : Ref<Material>();
+}
+
+bool VGSpriteRenderer::draw_path(VGPath *p_path) {
+	if (!p_path->get_sprite_state().tiled) {
+		return draw_atlas_entry(p_path);
+	}
+
+	draw_tiles(p_path);
+	return true;
+}
+
+void VGSpriteRenderer::draw_tiles(VGPath *p_path) {
+	const VGSpriteState &state = p_path->get_sprite_state();
+	const ObjectID id = p_path->get_instance_id();
+	const int bucket = state.scale_bucket;
+	const Rect2i &visible = state.visible_tiles;
+
+	for (int y = visible.position.y; y < visible.position.y + visible.size.y; y++) {
+		for (int x = visible.position.x; x < visible.position.x + visible.size.x; x++) {
+			const Point2i tile(x, y);
+			const Rect2i rect = get_tile_rect(state, bucket, tile);
+
+			const TileEntry *entry = find_tile(id, bucket, tile, state.tile_content_key);
+			if (entry) {
+				p_path->draw_texture_rect_region(entry->texture, get_tile_local_rect(state, bucket, rect),
+						Rect2(VG_SPRITE_TILE_GUTTER, VG_SPRITE_TILE_GUTTER, rect.size.x, rect.size.y));
+				continue;
+			}
+
+			// a coarser tile stands in until this one is ready.
+			for (int octave = 1; octave <= VG_SPRITE_TILE_FALLBACK_OCTAVES; octave++) {
+				const int coarse_bucket = bucket - octave * scale_steps;
+				const Point2i coarse_tile(x >> octave, y >> octave);
+				const TileEntry *coarse = find_tile(id, coarse_bucket, coarse_tile, state.tile_content_key);
+				if (!coarse) {
+					continue;
+				}
+
+				// the pixels of this tile, in the raster of the coarse tile.
+				const Rect2i coarse_rect = get_tile_rect(state, coarse_bucket, coarse_tile);
+				const float f = 1.0f / (1 << octave);
+				Rect2 src = Rect2(Point2(rect.position) * f - Point2(coarse_rect.position), Size2(rect.size) * f);
+				src = src.clip(Rect2(Point2(), Size2(coarse_rect.size)));
+				if (!src.has_no_area()) {
+					const Rect2 dst = get_tile_local_rect(state, coarse_bucket, Rect2(src.position + Point2(coarse_rect.position), src.size));
+					src.position += Point2(VG_SPRITE_TILE_GUTTER, VG_SPRITE_TILE_GUTTER);
+					p_path->draw_texture_rect_region(coarse->texture, dst, src);
+				}
+				break;
+			}
+		}
+	}
+}
+
+bool VGSpriteRenderer::is_viewport_dependent(VGPath *p_path) {
+	return p_path->get_sprite_state().tiled;
+}
+
+bool VGSpriteRenderer::update_viewport(VGPath *p_path) {
+	VGSpriteState &state = p_path->get_sprite_state();
+	return state.tiled && queue_tiles(p_path, state, false);
+}
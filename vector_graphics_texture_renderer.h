@@ -7,27 +7,370 @@
 
 #include "vector_graphics_renderer.h"
 #include "utils.h"
+#include "core/hash_map.h"
+#include "core/os/mutex.h"
+#include "core/os/semaphore.h"
+#include "core/os/thread.h"
+#include "core/os/thread_work_pool.h"
+
+// what VGSpriteRenderer keeps on a path between rasterizations. pixels and
+// texture are reused for as long as the size stays the same.
+struct VGSpriteState {
+	PoolVector<uint8_t> pixels;
+	int width;
+	int height;
+	// pixels outside of these rects are zero.
+	Vector<Rect2i> used;
+	Ref<ImageTexture> texture;
+	// the content key texture was rasterized for, 0 if it has none.
+	uint64_t texture_key;
+	// pixels and texture are alpha masks, one byte per pixel.
+	bool mask;
+	// what alpha masks get tinted with.
+	Color tint;
+
+	// the scale bucket the texture was rasterized for.
+	int scale_bucket;
+	bool has_scale_bucket;
+
+	// the last background job asked for. results of older jobs are dropped.
+	uint64_t job_serial;
+	uint64_t job_key;
+	bool job_pending;
+
+	// what the pixels were rasterized from, so that the next rasterization
+	// only needs to redo the rects of paths that changed. path_keys is empty
+	// when the pixels and the uploaded texture cannot be trusted to match.
+	uint64_t frame_key;
+	Vector<uint64_t> path_keys;
+	Vector<Rect2> path_bounds;
+	ObjectID uploaded;
+
+	// sprites too large for one texture are drawn from tiles of the view.
+	// scale_bucket then follows the camera, and tile_graphics is the copy
+	// the worker rasterizes tiles from.
+	bool tiled;
+	Rect2 tile_bounds;
+	uint64_t tile_content_key;
+	tove::GraphicsRef tile_graphics;
+	// tile indices in view, and the center of the view in path coordinates
+	// to tell the pan direction from.
+	Rect2i visible_tiles;
+	Point2 view_center;
+
+	void reset();
+
+	VGSpriteState();
+};
 
 class VGSpriteRenderer : public VGRenderer {
 	GDCLASS(VGSpriteRenderer, VGRenderer);
 
+public:
+	// rasterizer settings. sprites baked with render_texture(p_hq) always
+	// get the final tier.
+	enum QualityTier {
+		// fewer vertical subsamples and coarser curves.
+		QUALITY_TIER_PREVIEW,
+		QUALITY_TIER_NORMAL,
+		// more subsamples, finer curves and gradients dithered with blue
+		// noise.
+		QUALITY_TIER_FINAL,
+	};
+
+private:
 	float quality;
+	QualityTier quality_tier;
+	// 0 picks one thread per core, 1 rasterizes on the calling thread only.
+	int thread_count;
+	// the threads rasterizing in bands, started on first use and kept until
+	// the thread count changes. one raster at a time gets them, the others
+	// run on their calling thread.
+	ThreadWorkPool raster_pool;
+	int raster_pool_threads;
+	Mutex raster_pool_mutex;
+	// skips unpremultiplying. paths then get a CanvasItemMaterial with
+	// BLEND_MODE_PREMULT_ALPHA, or the premultiplying mask material.
+	bool premultiplied_alpha;
+	// exact pixel coverage instead of vertical subsamples, see
+	// ToveRasterizeEngine.
+	bool analytic_coverage;
+	// paths whose paints all share one solid color get an alpha mask,
+	// tinted by vertex colors. not with a material on the path.
+	bool alpha_masks;
+	// for straight and premultiplied alpha.
+	Ref<ShaderMaterial> mask_materials[2];
+
+	// raster resolutions snap to this many scale buckets per octave. a path
+	// keeps its bucket while the scale stays within it, widened by
+	// scale_hysteresis buckets.
+	int scale_steps;
+	float scale_hysteresis;
+
+	// rasterized textures of all paths, most recently used first, one per
+	// path and scale bucket. 0 KiB disables the cache.
+	struct CacheEntry {
+		ObjectID path;
+		int scale_bucket;
+		uint64_t content_key;
+		Ref<ImageTexture> texture;
+		int bytes;
+	};
+	List<CacheEntry> cache;
+	HashMap<uint64_t, List<CacheEntry>::Element *> cache_index;
+	int cache_budget_kb;
+	uint64_t cache_bytes;
+
+	uint64_t cache_hits;
+	uint64_t cache_misses;
+
+	// rasterizes on a worker thread, paths keep drawing their last texture
+	// until the new one is ready.
+	bool asynchronous;
+
+	// tiles of the path at a scale bucket, for content_key. textures have a
+	// gutter of VG_SPRITE_TILE_GUTTER pixels, so that filtering at seams
+	// sees the neighbouring tile.
+	struct TileEntry {
+		ObjectID path;
+		int scale_bucket;
+		Point2i tile;
+		uint64_t content_key;
+		Ref<ImageTexture> texture;
+		int bytes;
+	};
+	// most recently drawn first.
+	List<TileEntry> tiles;
+	HashMap<uint64_t, List<TileEntry>::Element *> tile_index;
+	// sprites that would be larger than tile_size pixels on a side get
+	// rasterized in tiles of that size, in the background and only where
+	// they are in view. 0 never tiles.
+	int tile_size;
+	int tile_budget_kb;
+	uint64_t tile_bytes;
+
+	// sprites up to half the size of a page share atlas pages of
+	// atlas_size pixels, so that they draw from few textures and get
+	// batched. 0 gives every path a texture of its own.
+	struct AtlasEntry {
+		ObjectID path;
+		int scale_bucket;
+		uint64_t content_key;
+		// where the path draws the region.
+		Rect2 bounds;
+		int page;
+		// the region, with a gutter of VG_SPRITE_ATLAS_GUTTER pixels.
+		Rect2i rect;
+		Ref<AtlasTexture> texture;
+	};
+	struct AtlasPage {
+		bool mask;
+		PoolVector<uint8_t> pixels;
+		Ref<ImageTexture> texture;
+		// bottom-left skyline, the heights of the segments starting at x.
+		Vector<Point2i> skyline;
+		// pixels of entries that were removed, until the page is compacted.
+		int free_area;
+	};
+	int atlas_size;
+	int atlas_budget_kb;
+	Vector<AtlasPage> atlas_pages;
+	// most recently drawn first.
+	List<AtlasEntry> atlas_entries;
+	HashMap<uint64_t, List<AtlasEntry>::Element *> atlas_index;
+
+	struct RasterJob {
+		ObjectID path;
+		uint64_t serial;
+		// a private copy, the worker never sees the paths of the scene.
+		tove::GraphicsRef graphics;
+		// where the texture goes on the path.
+		Rect2 bounds;
+		int scale_bucket;
+		float resolution;
+		uint64_t content_key;
+		bool mask;
+		int flags;
+		ToveRasterizeEngine engine;
+		QualityTier quality_tier;
+		int thread_count;
+		// tile jobs rasterize only this tile, with its gutter.
+		bool is_tile;
+		Point2i tile;
+		Rect2i tile_rect;
+		PoolVector<uint8_t> pixels;
+		int width;
+		int height;
+	};
+	// queued jobs, at most one per path plus its tiles, and jobs waiting for
+	// their upload.
+	List<RasterJob> pending_jobs;
+	List<RasterJob> finished_jobs;
+	// the tile the worker is on, so that it does not get queued twice.
+	uint64_t running_tile;
+	Thread worker;
+	Mutex job_mutex;
+	Semaphore job_semaphore;
+	bool worker_exit;
+
+	uint64_t jobs_queued;
+	uint64_t jobs_completed;
+	uint64_t jobs_dropped;
+
+	uint64_t full_updates;
+	uint64_t partial_updates;
+
+	static void _worker_func(void *p_userdata);
+	void queue_job(VGSpriteState &p_state, ObjectID p_path, const tove::GraphicsRef &p_graphics, int p_bucket, float p_resolution, uint64_t p_content_key);
+
+	// whether the path gets an alpha mask, and the color to tint it with.
+	bool get_mask_tint(VGPath *p_path, const tove::GraphicsRef &p_graphics, Color &r_tint) const;
+	int get_raster_flags(bool p_mask) const;
+
+	int select_scale_bucket(const VGSpriteState &p_state, float p_scale) const;
+	float get_scale_bucket_resolution(int p_bucket) const;
+	uint64_t get_content_key(const tove::GraphicsRef &p_graphics, bool p_mask) const;
+	ToveRasterizeEngine get_raster_engine() const;
+	static uint64_t get_cache_key(ObjectID p_path, int p_bucket);
+	void erase_cache_entry(List<CacheEntry>::Element *p_entry);
+	void trim_cache();
+	List<CacheEntry>::Element *find_cache_entry(ObjectID p_path, int p_bucket);
+	// moves the entry for path and bucket to the front, creating it if needed.
+	List<CacheEntry>::Element *touch_cache_entry(ObjectID p_path, int p_bucket);
+	// accounts for a texture that was just written into the entry.
+	bool commit_cache_entry(List<CacheEntry>::Element *p_entry, uint64_t p_content_key);
+
+	static uint64_t get_tile_key(ObjectID p_path, int p_bucket, const Point2i &p_tile, uint64_t p_content_key);
+	// pixels of the tile in the raster of the whole sprite, and where
+	// pixels of that raster end up on the path.
+	Rect2i get_tile_rect(const VGSpriteState &p_state, int p_bucket, const Point2i &p_tile) const;
+	Rect2 get_tile_local_rect(const VGSpriteState &p_state, int p_bucket, const Rect2 &p_rect) const;
+	TileEntry *find_tile(ObjectID p_path, int p_bucket, const Point2i &p_tile, uint64_t p_content_key);
+	void add_tile(const RasterJob &p_job);
+	void trim_tiles();
+	// queues the tiles in view that are missing, and the ones next to them
+	// in the pan direction. false if the same tiles were in view already.
+	bool queue_tiles(VGPath *p_path, VGSpriteState &p_state, bool p_force);
+	bool render_tiles(VGPath *p_path, const tove::GraphicsRef &p_graphics);
+	void draw_tiles(VGPath *p_path);
+
+	static uint64_t get_atlas_key(ObjectID p_path, int p_bucket);
+	uint64_t get_atlas_bytes() const;
+	static bool pack_atlas_rect(AtlasPage &p_page, int p_size, const Size2i &p_rect_size, Point2i &r_position);
+	// repacks the entries that are left, in one upload.
+	void compact_atlas_page(int p_page);
+	void remove_atlas_entry(List<AtlasEntry>::Element *p_entry);
+	// evicts the entries drawn longest ago if nothing else helps.
+	bool allocate_atlas_rect(bool p_mask, const Size2i &p_size, int &r_page, Point2i &r_position);
+	void write_atlas_rect(AtlasPage &p_page, const Rect2i &p_rect, const PoolVector<uint8_t> &p_pixels, int p_width, int p_height);
+	void add_to_atlas(ObjectID p_path, int p_bucket, uint64_t p_content_key, bool p_mask, const Rect2 &p_bounds, const PoolVector<uint8_t> &p_pixels, int p_width, int p_height);
+	bool draw_atlas_entry(VGPath *p_path);
+
+	// rasterizes in bands on raster_pool, or on the calling thread if the
+	// raster is small, there is one thread, or the pool is busy.
+	void rasterize_into(const tove::GraphicsRef &p_graphics, uint8_t *p_pixels, int p_width, int p_height, float p_tx, float p_ty, float p_scale, QualityTier p_quality_tier, ToveRasterizeEngine p_engine, int p_thread_count, int p_flags);
+
+	uint64_t get_frame_key(float p_resolution, float p_tx, float p_ty, int p_width, int p_height, bool p_mask) const;
+	bool rasterize_dirty_rect(VGSpriteState &p_state, const tove::GraphicsRef &p_graphics, float p_resolution, float p_tx, float p_ty, const Vector<uint64_t> &p_path_keys, const Vector<Rect2> &p_path_bounds, Ref<ImageTexture> &r_texture);
+	void rasterize_state(VGSpriteState &p_state, const tove::GraphicsRef &p_graphics, float p_resolution, Ref<ImageTexture> &r_texture);
+	Ref<ImageTexture> render_state(VGSpriteState &p_state, ObjectID p_path, const tove::GraphicsRef &p_graphics, float p_scale, bool p_mask);
 
 protected:
+	void _finish_jobs();
+
 	static void _bind_methods();
 
 public:
 	VGSpriteRenderer();
+	~VGSpriteRenderer();
 
 	virtual bool prefer_sprite() const { return true; }
 
 	float get_quality();
 	void set_quality(float p_quality);
 
+	QualityTier get_quality_tier() const;
+	void set_quality_tier(QualityTier p_quality_tier);
+
+	int get_thread_count() const;
+	void set_thread_count(int p_thread_count);
+
+	bool get_premultiplied_alpha() const;
+	void set_premultiplied_alpha(bool p_premultiplied_alpha);
+
+	bool get_analytic_coverage() const;
+	void set_analytic_coverage(bool p_analytic_coverage);
+
+	bool get_alpha_masks() const;
+	void set_alpha_masks(bool p_alpha_masks);
+
+	int get_scale_steps() const;
+	void set_scale_steps(int p_scale_steps);
+
+	float get_scale_hysteresis() const;
+	void set_scale_hysteresis(float p_scale_hysteresis);
+
+	int get_cache_budget_kb() const;
+	void set_cache_budget_kb(int p_cache_budget_kb);
+
+	int get_cache_hits() const { return cache_hits; }
+	int get_cache_misses() const { return cache_misses; }
+	int get_cache_size_kb() const { return cache_bytes / 1024; }
+	void reset_cache_counters();
+	void clear_cache();
+
+	bool get_asynchronous() const;
+	void set_asynchronous(bool p_asynchronous);
+
+	int get_jobs_queued() const { return jobs_queued; }
+	int get_jobs_completed() const { return jobs_completed; }
+	// jobs coalesced into a newer one before they ran, or finished too late.
+	int get_jobs_dropped() const { return jobs_dropped; }
+	void reset_job_counters();
+
+	// rasterizations of the whole sprite, and of only the rect around the
+	// paths that changed.
+	int get_full_updates() const { return full_updates; }
+	int get_partial_updates() const { return partial_updates; }
+	void reset_update_counters();
+
+	int get_tile_size() const;
+	void set_tile_size(int p_tile_size);
+
+	int get_tile_budget_kb() const;
+	void set_tile_budget_kb(int p_tile_budget_kb);
+
+	int get_tile_count() const { return tiles.size(); }
+	int get_tile_cache_size_kb() const { return tile_bytes / 1024; }
+	void clear_tiles();
+
+	int get_atlas_size() const;
+	void set_atlas_size(int p_atlas_size);
+
+	int get_atlas_budget_kb() const;
+	void set_atlas_budget_kb(int p_atlas_budget_kb);
+
+	int get_atlas_page_count() const { return atlas_pages.size(); }
+	int get_atlas_entry_count() const { return atlas_entries.size(); }
+	void clear_atlas();
+
 	virtual Rect2 render_mesh(Ref<ArrayMesh> &p_mesh, Ref<Material> &r_material, Ref<Texture> &r_texture, VGPath *p_path, bool p_hq, bool p_spatial);
 	virtual Ref<ImageTexture> render_texture(VGPath *p_path, bool p_hq);
+	virtual Ref<Material> get_canvas_material(VGPath *p_path);
+	virtual bool draw_path(VGPath *p_path);
 
-	virtual bool is_dirty_on_transform_change() const { return true; }
+	virtual bool is_viewport_dependent(VGPath *p_path);
+	virtual bool update_viewport(VGPath *p_path);
+
+	// only scale changes that cross into another bucket need a new raster.
+	virtual bool is_dirty_on_transform_change() const { return false; }
+	virtual bool is_dirty_on_scale_change(VGPath *p_path);
 };
 
+VARIANT_ENUM_CAST(VGSpriteRenderer::QualityTier);
+
+Ref<Shader> get_sprite_mask_shader(bool p_premultiplied);
+Ref<CanvasItemMaterial> get_sprite_premultiplied_material();
+void free_sprite_materials();
+
 #endif // VG_TEXTURE_RENDERER_H